@@ -12,6 +12,26 @@
 
 #define INIT_EXT
 #include "include/GLPointer.h"
+#include <string.h>
+
+EXTERN_C int GLSupports(int major, int minor, const char* extension)
+{
+	GLint contextMajor = 0;
+	GLint contextMinor = 0;
+	GLint extensionsNumber = 0;
+	GLint i;
+
+	glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+	glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+	if ( contextMajor > major || (contextMajor == major && contextMinor >= minor) )
+		return 1;
+
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionsNumber);
+	for ( i = 0; i < extensionsNumber; ++i )
+		if ( strcmp((const char*)pGLGet_Stringi(GL_EXTENSIONS, i), extension) == 0 )
+			return 1;
+	return 0;
+}
 
 EXTERN_C void Initializer()
 {
@@ -98,6 +118,10 @@ EXTERN_C void Initializer()
 
 	pGLFramebuffer_Texture = (void (*)(GLenum target, GLenum attachment, GLuint texture, GLint level))GET_PROC_ADDRESS((const GLubyte *)"glFramebufferTexture");
 
+	pGLFramebuffer_Texture_Layer = (void (*)(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer))GET_PROC_ADDRESS((const GLubyte *)"glFramebufferTextureLayer");
+
+	pGLTex_Image_3D = (void (*)(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels))GET_PROC_ADDRESS((const GLubyte *)"glTexImage3D");
+
 	pGLUniform1fv = (void (*)(GLint location, GLsizei count, const GLfloat* value))GET_PROC_ADDRESS((const GLubyte *)"glUniform1fv");
 	
 	pGLUniform3fv = (void (*)(GLint location, GLsizei count, const GLfloat* value))GET_PROC_ADDRESS((const GLubyte *)"glUniform3fv");
@@ -106,6 +130,44 @@ EXTERN_C void Initializer()
 
 	pGLUniform1iv = (void (*)(GLint location, GLsizei count, const GLint* value))GET_PROC_ADDRESS((const GLubyte *)"glUniform1iv");
 
+	pGLGet_Active_Uniform = (void (*)(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name))GET_PROC_ADDRESS((const GLubyte *)"glGetActiveUniform");
+
+	pGLGet_Active_Uniformsiv = (void (*)(GLuint program, GLsizei uniformCount, const GLuint* uniformIndices, GLenum pname, GLint* params))GET_PROC_ADDRESS((const GLubyte *)"glGetActiveUniformsiv");
+
+	pGLBuffer_Sub_Data = (void (*)(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data))GET_PROC_ADDRESS((const GLubyte *)"glBufferSubData");
+
+	pGLBind_Buffer_Base = (void (*)(GLenum target, GLuint index, GLuint buffer))GET_PROC_ADDRESS((const GLubyte *)"glBindBufferBase");
+
+	pGLBind_Buffer_Range = (void (*)(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size))GET_PROC_ADDRESS((const GLubyte *)"glBindBufferRange");
+
+	pGLGet_Uniform_Block_Index = (GLuint (*)(GLuint program, const GLchar* uniformBlockName))GET_PROC_ADDRESS((const GLubyte *)"glGetUniformBlockIndex");
+
+	pGLUniform_Block_Binding = (void (*)(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding))GET_PROC_ADDRESS((const GLubyte *)"glUniformBlockBinding");
+
+	pGLVertex_Attrib_Divisor = (void (*)(GLuint index, GLuint divisor))GET_PROC_ADDRESS((const GLubyte *)"glVertexAttribDivisor");
+
+	pGLBuffer_Storage = (void (*)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags))GET_PROC_ADDRESS((const GLubyte *)"glBufferStorage");
+
+	pGLMap_Buffer_Range = (void* (*)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access))GET_PROC_ADDRESS((const GLubyte *)"glMapBufferRange");
+
+	pGLUnmap_Buffer = (GLboolean (*)(GLenum target))GET_PROC_ADDRESS((const GLubyte *)"glUnmapBuffer");
+
+	pGLFence_Sync = (GLsync (*)(GLenum condition, GLbitfield flags))GET_PROC_ADDRESS((const GLubyte *)"glFenceSync");
+
+	pGLClient_Wait_Sync = (GLenum (*)(GLsync sync, GLbitfield flags, GLuint64 timeout))GET_PROC_ADDRESS((const GLubyte *)"glClientWaitSync");
+
+	pGLDelete_Sync = (void (*)(GLsync sync))GET_PROC_ADDRESS((const GLubyte *)"glDeleteSync");
+
+	pGLGet_Stringi = (const GLubyte* (*)(GLenum name, GLuint index))GET_PROC_ADDRESS((const GLubyte *)"glGetStringi");
+
+	pGLCopy_Buffer_Sub_Data = (void (*)(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size))GET_PROC_ADDRESS((const GLubyte *)"glCopyBufferSubData");
+
+	pGLDraw_Elements_Instanced_Base_Vertex = (void (*)(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex))GET_PROC_ADDRESS((const GLubyte *)"glDrawElementsInstancedBaseVertex");
+
+	pGLMulti_Draw_Elements_Indirect = (void (*)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride))GET_PROC_ADDRESS((const GLubyte *)"glMultiDrawElementsIndirect");
+
+	pGLDraw_Elements_Instanced = (void (*)(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount))GET_PROC_ADDRESS((const GLubyte *)"glDrawElementsInstanced");
+
 #ifdef __linux__
 pGLXSwap_Interval_EXT = (void (*)(Display*, GLXDrawable, int))GET_PROC_ADDRESS((const GLubyte *)"glXSwapIntervalEXT");
 #endif
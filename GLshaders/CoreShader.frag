@@ -7,18 +7,118 @@ in VS_OUT {
 	vec2 textureCoords;
 	vec4 fragmentPositionDirectionalLightSpace[2];
 	vec4 fragmentPositionSpotLightSpace[2];
+	flat vec4 ambientShininess;      // Per instance material, ambient in xyz, shininess in w
 } fs_in;
 
 struct Material {
-    vec3      ambient;
 	sampler2D diffuse;
 	sampler2D specular;
-    float     shininess;
 }; 
 
 uniform Material material;
 uniform float time; // Time uniform for animation
 uniform float numberToShow; // Number to display (0-999)
+uniform vec3 viewPosition;
+
+// The renderer defines the array lengths from GL_MAX_UNIFORM_BLOCK_SIZE
+#ifndef MAX_DIRECTIONAL_LIGHTS
+#define MAX_DIRECTIONAL_LIGHTS 1
+#endif
+#ifndef MAX_POINT_LIGHTS
+#define MAX_POINT_LIGHTS 1
+#endif
+#ifndef MAX_SPOT_LIGHTS
+#define MAX_SPOT_LIGHTS 1
+#endif
+
+// std140, a scalar rides in the w of the vec4 before it
+struct DirectionalLight {
+	vec4 position;
+	vec4 direction;
+	vec4 ambient;
+	vec4 diffuse;
+	vec4 specular;
+};
+
+struct PointLight {
+	vec4 positionConstant;
+	vec4 ambientLinear;
+	vec4 diffuseQuadratic;
+	vec4 specular;
+};
+
+struct SpotLight {
+	vec4 positionCutOff;         // w: cos of the inner cone angle
+	vec4 directionOuterCutOff;   // w: cos of the outer cone angle
+	vec4 ambientConstant;
+	vec4 diffuseLinear;
+	vec4 specularQuadratic;
+};
+
+layout (std140) uniform DirectionalLights {
+	DirectionalLight directionalLights[MAX_DIRECTIONAL_LIGHTS];
+};
+
+layout (std140) uniform PointLights {
+	PointLight pointLights[MAX_POINT_LIGHTS];
+};
+
+layout (std140) uniform SpotLights {
+	SpotLight spotLights[MAX_SPOT_LIGHTS];
+};
+
+uniform int directionalLightsArraySize;
+uniform int pointLightsArraySize;
+uniform int spotLightsArraySize;
+
+// Blinn-Phong sum of every light, black when the scene has none. The core shader
+// has never lit the scene, so this only runs when the renderer defines BLINN_PHONG_LIGHTING.
+#ifdef BLINN_PHONG_LIGHTING
+vec3 computeLights(vec3 normal, vec3 fragmentPosition, vec3 diffuseColor, vec3 specularColor) {
+	vec3 viewDirection = normalize(viewPosition - fragmentPosition);
+	vec3 result = vec3(0.0);
+
+	for (int i = 0; i < directionalLightsArraySize; i++) {
+		vec3 lightDirection = normalize(-directionalLights[i].direction.xyz);
+		float diffuse = max(dot(normal, lightDirection), 0.0);
+		float specular = pow(max(dot(normal, normalize(lightDirection + viewDirection)), 0.0), fs_in.ambientShininess.w);
+		result += directionalLights[i].ambient.rgb * diffuseColor +
+			directionalLights[i].diffuse.rgb * diffuse * diffuseColor +
+			directionalLights[i].specular.rgb * specular * specularColor;
+	}
+
+	for (int i = 0; i < pointLightsArraySize; i++) {
+		vec3 toLight = pointLights[i].positionConstant.xyz - fragmentPosition;
+		float distance = length(toLight);
+		vec3 lightDirection = toLight / max(distance, 0.0001);
+		float attenuation = 1.0 / max(pointLights[i].positionConstant.w + pointLights[i].ambientLinear.w * distance +
+									  pointLights[i].diffuseQuadratic.w * distance * distance, 0.0001);
+		float diffuse = max(dot(normal, lightDirection), 0.0);
+		float specular = pow(max(dot(normal, normalize(lightDirection + viewDirection)), 0.0), fs_in.ambientShininess.w);
+		result += attenuation * (pointLights[i].ambientLinear.rgb * diffuseColor +
+								 pointLights[i].diffuseQuadratic.rgb * diffuse * diffuseColor +
+								 pointLights[i].specular.rgb * specular * specularColor);
+	}
+
+	for (int i = 0; i < spotLightsArraySize; i++) {
+		vec3 toLight = spotLights[i].positionCutOff.xyz - fragmentPosition;
+		float distance = length(toLight);
+		vec3 lightDirection = toLight / max(distance, 0.0001);
+		float attenuation = 1.0 / max(spotLights[i].ambientConstant.w + spotLights[i].diffuseLinear.w * distance +
+									  spotLights[i].specularQuadratic.w * distance * distance, 0.0001);
+		float theta = dot(lightDirection, normalize(-spotLights[i].directionOuterCutOff.xyz));
+		float epsilon = max(spotLights[i].positionCutOff.w - spotLights[i].directionOuterCutOff.w, 0.0001);
+		float intensity = clamp((theta - spotLights[i].directionOuterCutOff.w) / epsilon, 0.0, 1.0);
+		float diffuse = max(dot(normal, lightDirection), 0.0);
+		float specular = pow(max(dot(normal, normalize(lightDirection + viewDirection)), 0.0), fs_in.ambientShininess.w);
+		result += attenuation * (spotLights[i].ambientConstant.rgb * diffuseColor +
+								 intensity * (spotLights[i].diffuseLinear.rgb * diffuse * diffuseColor +
+											  spotLights[i].specularQuadratic.rgb * specular * specularColor));
+	}
+
+	return result;
+}
+#endif
 
 // Function to get bit from digit bitmap (5x7 pixels)
 float getBit(int bitmap[7], int x, int y) {
@@ -354,7 +454,7 @@ void main()
 	vec4 textureColor = texture(material.diffuse, fs_in.textureCoords);
 	
 	// Apply material ambient color for tinting
-	vec3 baseColor = textureColor.rgb * material.ambient;
+	vec3 baseColor = textureColor.rgb * fs_in.ambientShininess.rgb;
 	
 	// Add animated glow effect based on texture coordinates
 	vec2 center = vec2(0.5, 0.5);
@@ -375,7 +475,7 @@ void main()
 	// Add fresnel-like rim lighting
 	vec3 viewDir = normalize(-fs_in.fragmentPosition);
 	float fresnel = 1.0 - abs(dot(normalize(fs_in.normal), viewDir));
-	fresnel = pow(fresnel, 2.0);	vec3 rimLight = material.ambient * fresnel * 0.4;
+	fresnel = pow(fresnel, 2.0);	vec3 rimLight = fs_in.ambientShininess.rgb * fresnel * 0.4;
 		// Render number on texture with enhanced visuals
 	float numberMask = renderNumber(fs_in.textureCoords, vec2(0.35, 0.4), 0.06, numberToShow);
 		// Create animated color for the number
@@ -398,6 +498,10 @@ void main()
 	
 	// Combine effects
 	vec3 finalColor = baseColor + (baseColor * glow) + colorShift + rimLight;
+#ifdef BLINN_PHONG_LIGHTING
+	finalColor += computeLights(normalize(fs_in.normal), fs_in.fragmentPosition, baseColor,
+								texture(material.specular, fs_in.textureCoords).rgb);
+#endif
 	
 	// Add number with glow and outline
 	finalColor = mix(finalColor, numberColor, numberMask);
@@ -428,7 +532,7 @@ void main()
 	
 	// Add extra glow around particles
 	float totalParticleIntensity = sparkleEffect + energyEffect + waveEffect + dustEffect;
-	vec3 particleGlow = material.ambient * totalParticleIntensity * 0.3;
+	vec3 particleGlow = fs_in.ambientShininess.rgb * totalParticleIntensity * 0.3;
 	finalColor += particleGlow;
 	
 	// Create interactive particle effects based on fragment position
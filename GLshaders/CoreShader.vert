@@ -2,8 +2,12 @@
 layout (location = 0) in vec3 vertexPosition;
 layout (location = 1) in vec3 normal;
 layout (location = 2) in vec2 textureCoordinates;
+#ifdef SKINNED
 layout (location = 3) in vec4 jointIndices;
 layout (location = 4) in vec4 weights;
+#endif
+layout (location = 5) in mat4 modelMatrix;       // Per instance, takes locations 5 to 8
+layout (location = 9) in vec4 instanceMaterial;  // Per instance, ambient in xyz, shininess in w
 
 out VS_OUT {
 	vec3 fragmentPosition;
@@ -11,16 +15,22 @@ out VS_OUT {
 	vec2 textureCoords;
 	vec4 fragmentPositionDirectionalLightSpace[2];
 	vec4 fragmentPositionSpotLightSpace[2];
+	flat vec4 ambientShininess;
 } vs_out;
 
-uniform mat4 modelMatrix;
 uniform mat4 viewMatrix;
 uniform mat4 projectionMatrix;
 uniform bool reverseNormals;
-uniform mat4 jointMatrices[18];
+#ifdef SKINNED
+layout (std140) uniform SkinPalette            // Range of the palette buffer bound per skinned batch
+{
+	mat4 jointMatrices[18];
+};
+#endif
 
 void main()
 {
+#ifdef SKINNED
 	mat4 skinMatrix;
 	if (int(jointIndices.x) != -1) {
 		skinMatrix =
@@ -36,15 +46,20 @@ void main()
 			0.0, 0.0, 0.0, 1.0
 			);
 	}
+	mat4 vertexModelMatrix = modelMatrix * skinMatrix;
+#else
+	mat4 vertexModelMatrix = modelMatrix;
+#endif
 
-	vec4 worldPosition = modelMatrix * skinMatrix * vec4(vertexPosition, 1.0);
+	vec4 worldPosition = vertexModelMatrix * vec4(vertexPosition, 1.0);
 
 	vs_out.fragmentPosition = worldPosition.xyz;
 	if(reverseNormals)
-        vs_out.normal = transpose(inverse(mat3(modelMatrix * skinMatrix))) * (-1.0 * normal);
+        vs_out.normal = transpose(inverse(mat3(vertexModelMatrix))) * (-1.0 * normal);
     else
-        vs_out.normal = transpose(inverse(mat3(modelMatrix * skinMatrix))) * normal;
+        vs_out.normal = transpose(inverse(mat3(vertexModelMatrix))) * normal;
 	vs_out.textureCoords = textureCoordinates;
+	vs_out.ambientShininess = instanceMaterial;
 	
 	// Set dummy values for shadow matrices to maintain compatibility
 	vs_out.fragmentPositionDirectionalLightSpace[0] = vec4(0.0);
@@ -2,15 +2,23 @@
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec3 normal;
 layout (location = 2) in vec2 textureCoordinates;
+#ifdef SKINNED
 layout (location = 3) in vec4 jointIndices;
 layout (location = 4) in vec4 weights;
+#endif
+layout (location = 5) in mat4 modelMatrix;       // Per instance, takes locations 5 to 8
 
-uniform mat4 jointMatrices[18];
+#ifdef SKINNED
+layout (std140) uniform SkinPalette            // Range of the palette buffer bound per skinned batch
+{
+	mat4 jointMatrices[18];
+};
+#endif
 
-uniform mat4 modelMatrix;
 
 void main()
 {
+#ifdef SKINNED
 	mat4 skinMatrix;
 	if (int(jointIndices.x) != -1) {
 		skinMatrix =
@@ -26,8 +34,12 @@ void main()
 			0.0, 0.0, 0.0, 1.0
 			);
 	}
+	mat4 vertexModelMatrix = modelMatrix * skinMatrix;
+#else
+	mat4 vertexModelMatrix = modelMatrix;
+#endif
 
-	vec4 worldPosition = modelMatrix * skinMatrix * vec4(aPosition, 1.0);
+	vec4 worldPosition = vertexModelMatrix * vec4(aPosition, 1.0);
 	
 	gl_Position = worldPosition;
 //	gl_Position = modelMatrix * vec4(aPosition, 1.0);
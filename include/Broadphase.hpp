@@ -0,0 +1,113 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef BROADPHASE
+#define BROADPHASE
+
+#include "SimdBounds.hpp"
+#include "Vector.hpp"
+#include "VertexMath.hpp"
+#include <cstdint>
+
+namespace GLVM::core
+{
+	/// Indices of two boxes whose AABBs overlap, first < second.
+	struct BroadphasePair
+	{
+		unsigned int first;
+		unsigned int second;
+	};
+
+	/*! Uniform grid hashed by integer cell coordinates. The cell size follows
+	 *  the mean box size; boxes covering more than kMaxCellsPerBox cells (the
+	 *  ground planes) are kept aside and tested against the x range they span
+	 *  instead of being smeared over hundreds of cells. Rebuilt from scratch
+	 *  each frame, the buffers are kept between builds. */
+	class CSpatialHash
+	{
+		struct CellEntry
+		{
+			uint64_t key;
+			unsigned int index;
+		};
+
+		struct AxisEntry
+		{
+			float min;
+			unsigned int index;
+		};
+
+		static constexpr unsigned int kMaxCellsPerBox = 64;
+
+		core::vector<CellEntry> entries_;
+		core::vector<unsigned int> oversized_;
+		core::vector<unsigned char> oversizedFlags_;
+		core::vector<AxisEntry> regularByMinX_;    ///< Regular boxes sorted on min x, scanned by the oversized ones.
+		float regularMaxWidthX_ = 0.0f;
+		const AABB* boxes_ = nullptr;
+		float cellSize_ = 1.0f;
+		float inverseCellSize_ = 1.0f;
+
+		int CellCoordinate(float value) const;
+		uint64_t CellKey(int x, int y, int z) const;
+
+	public:
+		/// The boxes are referenced, not copied; keep them alive until CollectPairs.
+		void Build(const AABB* boxes, unsigned int count);
+		/// Appends every overlapping pair exactly once.
+		void CollectPairs(core::vector<BroadphasePair>& pairs);
+		float GetCellSize() const { return cellSize_; }
+	};
+
+	/*! Sort and sweep that keeps its order between frames. Boxes are identified
+	 *  by a stable id (the entity), so a frame where little moved costs one
+	 *  nearly linear insertion sort pass instead of a full sort or a grid
+	 *  rebuild. The sweep axis follows the largest spread of the box centers,
+	 *  switching only when another axis is clearly better since a switch costs
+	 *  a full reorder. Pairs are reported as indices into the boxes passed to
+	 *  the last Update. */
+	class CSweepAndPrune
+	{
+		struct Endpoint
+		{
+			float min;
+			float max;
+			unsigned int id;
+			unsigned int index;    ///< Position of the box in the current frame arrays.
+		};
+
+		static constexpr unsigned int kInvalidIndex = 0xFFFFFFFFu;
+
+		core::vector<Endpoint> endpoints_;
+		core::vector<unsigned int> indexOfId_;    ///< Frame index by id, kInvalidIndex when absent.
+		CBoundsSoA sortedBounds_;                 ///< Boxes in endpoint order, swept eight at a time.
+		const AABB* boxes_ = nullptr;
+		int axis_ = 0;
+		unsigned int insertionShifts_ = 0;
+
+		/// Returns whether the axis changed, which leaves the kept order meaningless.
+		bool ChooseAxis(const AABB* boxes, unsigned int count);
+
+	public:
+		/// Drops ids that disappeared, appends new ones and restores the order.
+		void Update(const unsigned int* ids, const AABB* boxes, unsigned int count);
+		/// Appends every overlapping pair exactly once.
+		void CollectPairs(core::vector<BroadphasePair>& pairs);
+		/// Element moves done by the last insertion sort, near zero for a resting scene.
+		unsigned int GetInsertionShifts() const { return insertionShifts_; }
+		int GetAxis() const { return axis_; }
+	};
+
+	/// Push with doubling growth, the +10 step of core::vector is too slow for pair lists.
+	template <typename T>
+	inline void PushGrowing(core::vector<T>& container, const T& item) {
+		unsigned int capacity = static_cast<unsigned int>(container.GetCapacity());
+		if ( container.GetSize() == capacity )
+			container.Reserve(capacity < 16 ? 16 : capacity * 2);
+		container.Push(item);
+	}
+}
+
+#endif
@@ -15,6 +15,7 @@
 #include "Components/MoveComponent.hpp"
 #include "Components/PointLightComponent.hpp"
 #include "Components/ProjectileComponent.hpp"
+#include "Components/RigidBodyComponent.hpp"
 #include "Components/SpotLightComponent.hpp"
 #include "Components/TransformComponent.hpp"
 #include "Components/VertexComponent.hpp"
@@ -30,8 +31,10 @@
 #include <assert.h>
 #include "Components/ControllerComponent.hpp"
 #include <cstdlib>
+#include <cstdint>
 
 typedef unsigned int Entity;
+typedef uint64_t ComponentMask;    ///< One bit per component container ID.
 
 namespace GLVM::ecs
 {
@@ -68,8 +71,25 @@ namespace GLVM::ecs
 				componentsTypes.Push(typeid(componentType).name());
 //				std::cout << typeid(Component_Type).name() << std::endl;			
 				++componentsContainerID;
+				assert( componentsContainerID <= sizeof(ComponentMask) * 8 );
 				return localContainerID;
 			}
+
+		/// Mask the queries see, or the parked one while the entity is disabled.
+		ComponentMask& MaskOf(Entity entity) {
+			return IsEntityEnabled(entity) ? entityComponentMasks[entity] : disabledComponentMasks[entity];
+		}
+
+		void SetMaskBit(Entity entity, unsigned int containerID) {
+			if ( entity >= entityComponentMasks.GetSize() )
+				entityComponentMasks.Resize(entity + 1);
+			MaskOf(entity) |= ComponentMask(1) << containerID;
+		}
+
+		void ClearMaskBit(Entity entity, unsigned int containerID) {
+			if ( entity < entityComponentMasks.GetSize() )
+				MaskOf(entity) &= ~(ComponentMask(1) << containerID);
+		}
         
 	public:
 		inline static unsigned int componentsContainerID = 0;
@@ -78,6 +98,8 @@ namespace GLVM::ecs
 		core::vector<core::vector<Entity>*> worldDenseComponentsMapToEntities;
 
 		core::vector<const char*> componentsTypes;
+		core::vector<ComponentMask> entityComponentMasks;    ///< Which containers hold a component of the entity, indexed by entity.
+		core::vector<ComponentMask> disabledComponentMasks;  ///< Real masks of disabled entities, whose visible mask is 0.
 		
         ComponentManager(ComponentManager& componentManager) = delete;         ///< Dont need to make cope because of singleton property.
         void operator=(const ComponentManager& componentManager) = delete;      ///< Dont need assignment operator because of singleton property.
@@ -110,6 +132,54 @@ namespace GLVM::ecs
 			sparse[entity] = dense.GetSize();
 			dense.Push(entity);
 			components.Push(Component);
+			SetMaskBit(entity, localContainerID);
+		}
+
+		/// Attach one component value to a batch of entities. Containers are resolved and
+		/// grown once for the whole batch; entities that already own the component get
+		/// the value written over it.
+		template <typename componentType>
+		void CreateComponents(const Entity* entities, unsigned int count, const componentType& value)
+		{
+			unsigned int localContainerID = CreateComponentContainer<componentType>();
+
+			core::vector<Entity>& sparse = *static_cast<core::vector<Entity>*>
+				(worldSparseEntitiesMapToComponents[localContainerID]);
+			core::vector<Entity>& dense = *static_cast<core::vector<Entity>*>
+				(worldDenseComponentsMapToEntities[localContainerID]);
+			core::vector<componentType>& components = *static_cast<core::vector<componentType>*>
+				(worldComponentsContainer[localContainerID]);
+
+			Entity maxEntity = 0;
+			for ( unsigned int i = 0; i < count; ++i ) {
+				if ( entities[i] > maxEntity )
+					maxEntity = entities[i];
+			}
+
+			if ( count > 0 && maxEntity >= sparse.GetSize() ) {
+				sparse.Resize(maxEntity + 1);
+			}
+
+			if ( count > 0 && maxEntity >= entityComponentMasks.GetSize() ) {
+				entityComponentMasks.Resize(maxEntity + 1);
+			}
+
+			dense.Reserve(dense.GetSize() + count);
+			components.Reserve(components.GetSize() + count);
+			assert( dense.GetSize() == components.GetSize() );
+
+			for ( unsigned int i = 0; i < count; ++i ) {
+				Entity entity = entities[i];
+				if ( checkAvailability( sparse, dense, entity ) ) {
+					components[sparse[entity]] = value;
+					continue;
+				}
+
+				sparse[entity] = dense.GetSize();
+				dense.Push(entity);
+				components.Push(value);
+				SetMaskBit(entity, localContainerID);
+			}
 		}
 
 		bool checkAvailability( core::vector<Entity>& sparse,
@@ -138,7 +208,7 @@ namespace GLVM::ecs
 
 			core::vector<Entity> returnVector;
 			for ( unsigned int i = 0; i < dense.GetSize(); ++i ) {
-				if ( multiCheckAvailability<Args...>(dense[i]) )
+				if ( IsEntityEnabled(dense[i]) && multiCheckAvailability<Args...>(dense[i]) )
 					returnVector.Push(dense[i]);
 			}
 
@@ -173,7 +243,7 @@ namespace GLVM::ecs
 		}
 		
 		template <typename... Args>
-		bool multiCheckAvailability(Entity entity) {
+		bool multiCheckAvailability([[maybe_unused]] Entity entity) {
 			return (multiCheckAvailabilityBase<Args>(entity) && ...);
 		}
 
@@ -237,6 +307,7 @@ namespace GLVM::ecs
 				components[indexInDenseOfRemovableEntity] = componentFromLastIndex;
 				components.Pop();
 				sparse[indexInSparseOfSwapableEntity] = indexInDenseOfRemovableEntity;
+				ClearMaskBit(entity, localContainerID);
 			}
 		}
 		
@@ -311,6 +382,8 @@ namespace GLVM::ecs
 				} else if ( componentsTypes[i] == typeid(components::projectile).name() ) {
 					RemoveComponent<components::projectile>(entity);
 //				 	std::cout << "Delete projectile" << std::endl;
+				} else if ( componentsTypes[i] == typeid(components::rigidBody).name() ) {
+					RemoveComponent<components::rigidBody>(entity);
 				} else {
 					continue;
 				}
@@ -319,6 +392,45 @@ namespace GLVM::ecs
 		
 		unsigned int GetContainerID();
 
+		template <typename componentType>
+		unsigned int GetComponentTypeID() { return CreateComponentContainer<componentType>(); }
+
+		template <typename... Args>
+		ComponentMask GetComponentMask() { return ((ComponentMask(1) << CreateComponentContainer<Args>()) | ... | ComponentMask(0)); }
+
+		ComponentMask GetEntityMask(Entity entity) const {
+			return entity < entityComponentMasks.GetSize() ? entityComponentMasks[entity] : 0;
+		}
+
+		/*! A disabled entity keeps every component where it is but drops out of
+		 *  queries and linked entity lists, so it costs nothing to the systems
+		 *  and can be enabled again without a single allocation. */
+		void DisableEntity(Entity entity) {
+			if ( entity >= entityComponentMasks.GetSize() || entityComponentMasks[entity] == 0 )
+				return;
+			if ( entity >= disabledComponentMasks.GetSize() )
+				disabledComponentMasks.Resize(entityComponentMasks.GetSize());
+			disabledComponentMasks[entity] = entityComponentMasks[entity];
+			entityComponentMasks[entity] = 0;
+		}
+
+		void EnableEntity(Entity entity) {
+			if ( IsEntityEnabled(entity) )
+				return;
+			entityComponentMasks[entity] = disabledComponentMasks[entity];
+			disabledComponentMasks[entity] = 0;
+		}
+
+		bool IsEntityEnabled(Entity entity) const {
+			return entity >= disabledComponentMasks.GetSize() || disabledComponentMasks[entity] == 0;
+		}
+
+		template <typename componentType>
+		core::vector<Entity>* GetSparseContainer()
+			{
+				return static_cast<core::vector<Entity>*>(worldSparseEntitiesMapToComponents[CreateComponentContainer<componentType>()]);
+			}
+
 		template <typename componentType>
 		core::VectorIterator<componentType> GetComponentContainerTest() {
 			core::vector<componentType>* componentVector = static_cast<core::vector<componentType>*>(worldComponentsContainer[CreateComponentContainer<componentType>()]);
@@ -7,6 +7,7 @@
 #define COLLIDER_COMPONENT
 
 #include "Vector.hpp"
+#include "VertexMath.hpp"
 
 namespace GLVM::ecs::components
 {
@@ -16,6 +17,9 @@ namespace GLVM::ecs::components
         bool bGround_Collision_ = false;
 		bool roofCollision = false;
         bool bWall_Collision_ = false;
+		bool bBullet_ = false;                   ///< Tested along its whole step instead of at the end of it.
+		vec3 tSweep_{ 0.0f, 0.0f, 0.0f };        ///< Bullet displacement already applied this step by its owner system.
+		float fTimeOfImpact_ = 1.0f;             ///< Fraction of the sweep at the first hit, 1 when nothing was hit.
 	};
 }
 
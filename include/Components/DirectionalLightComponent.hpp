@@ -18,6 +18,8 @@ namespace GLVM::ecs::components
 		vec3 ambient;
 		vec3 diffuse;
 		vec3 specular;
+
+		unsigned int shadowMapSize = 1024;   ///< Shadow atlas tile side, a power of two; halved while the atlas is full.
 	};
 }
 
@@ -6,6 +6,8 @@
 #ifndef PROJECTILE_COMPONENT
 #define PROJECTILE_COMPONENT
 
+#include "VertexMath.hpp"
+
 namespace GLVM::ecs::components
 {
     class projectile
@@ -16,6 +18,7 @@ namespace GLVM::ecs::components
         float fDamage_;
         float fSpeed_;
         float fFlying_Range_;
+        vec3 tDirection_{ 0.0f, 0.0f, -1.0f };    ///< Flight direction, unit length; the model keeps its own rotation.
     };
 }
 
@@ -18,6 +18,9 @@ namespace GLVM::ecs::components
         bool bGravity_;
 		vec3 jump{ 0.0f, 0.0f, 0.0f };
 		float jumpAccumulator = 0.0f;
+		float sleepTimer_ = 0.0f;          ///< Time spent supported and nearly still, see CPhysicsSystem.
+		bool bAwake_ = true;               ///< Asleep bodies get no gravity or move until their island wakes.
+		unsigned int island_ = 0;          ///< Entity the island fell asleep under, valid while asleep.
 	};
 }
 
@@ -24,6 +24,8 @@ namespace GLVM::ecs::components
 		float constant;
 		float linear;
 		float quadratic; 
+
+		unsigned int shadowMapSize = 1024;   ///< Shadow atlas tile side, a power of two; halved while the atlas is full.
 	};
 }
 
@@ -16,15 +16,57 @@ namespace GLVM::ecs::components
         vec3 tForward{ 0.0f, 0.0f, 0.0f };
         vec3 tRight{ 0.0f, 0.0f, 0.0f };
         vec3 tUp{ 0.0f, 0.0f, 0.0 };
-        float yaw = 0.0f;
-		float pitch = 0.0f;
+		Quaternion rotation{ .w = 1.0f, .x = 0.0f, .y = 0.0f, .z = 0.0f }; ///< Unit length, fed straight into the model matrix.
         float fScale = 1.0f;
         bool hud = false;
 		float GravityAccumulator = 0.0f;
 		unsigned int currentAnimationFrame = 0;
 		float frameAccumulator = 0.0f;
 		bool gltf = true;
+		vec3 tPreviousPosition{ 0.0f, 0.0f, 0.0f };              ///< State before the last fixed step, see StorePreviousState().
+		Quaternion previousRotation{ .w = 1.0f, .x = 0.0f, .y = 0.0f, .z = 0.0f };
+		bool bPreviousValid_ = false;                            ///< False until the first step, renderers then draw the current state.
 	};
+
+	///< Model rotation from the yaw/pitch angles (degrees) the transform used to store.
+	inline Quaternion YawPitchRotation(float _yaw, float _pitch)
+	{
+		Quaternion pitchQuat = axisAngleQuaternion(vec3(0.0f, 0.0f, 1.0f), Radians(-_pitch));
+		Quaternion yawQuat = axisAngleQuaternion(vec3(0.0f, 1.0f, 0.0f), Radians(-_yaw));
+
+		return multiplyQuaternion(pitchQuat, yawQuat);
+	}
+
+	inline void SetRotation(transform& _transform, Quaternion _rotation)
+	{
+		_transform.rotation = normalizeQuaternion(_rotation);
+	}
+
+	inline void StorePreviousState(transform& _transform)
+	{
+		_transform.tPreviousPosition = _transform.tPosition;
+		_transform.previousRotation = _transform.rotation;
+		_transform.bPreviousValid_ = true;
+	}
+
+	///< Position drawn _alpha of the way from the previous fixed step to the current one.
+	inline vec3 InterpolatedPosition(const transform& _transform, float _alpha)
+	{
+		if (!_transform.bPreviousValid_)
+			return _transform.tPosition;
+
+		const vec3& a = _transform.tPreviousPosition;
+		const vec3& b = _transform.tPosition;
+		return vec3(a[0] + (b[0] - a[0]) * _alpha, a[1] + (b[1] - a[1]) * _alpha, a[2] + (b[2] - a[2]) * _alpha);
+	}
+
+	inline Quaternion InterpolatedRotation(const transform& _transform, float _alpha)
+	{
+		if (!_transform.bPreviousValid_)
+			return _transform.rotation;
+
+		return nlerp(_transform.previousRotation, _transform.rotation, _alpha);
+	}
 }
 
 #endif
@@ -0,0 +1,68 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef CONTACT_CACHE
+#define CONTACT_CACHE
+
+#include "ComponentManager.hpp"
+#include "Vector.hpp"
+#include "VertexMath.hpp"
+#include <cstdint>
+
+namespace GLVM::ecs
+{
+	/// Touching pair, first < second.
+	struct ContactManifold
+	{
+		Entity first;
+		Entity second;
+		vec3 normal;               ///< Unit axis pushing second away from first.
+		float depth;               ///< Overlap along the normal, 0 for a swept hit.
+		unsigned int age;          ///< Steps the pair has been touching, 0 on the first one.
+	};
+
+	enum EContactEvent
+	{
+		eCONTACT_BEGIN,
+		eCONTACT_PERSIST,
+		eCONTACT_END
+	};
+
+	struct ContactEvent
+	{
+		EContactEvent type;
+		Entity first;
+		Entity second;
+	};
+
+	/*! Contacts of the last step sorted by entity pair. Each step the new
+	 *  contacts are added, then End() merges them with the stored ones and
+	 *  reports which pairs began, persisted or ended. A stored pair that was
+	 *  not tested again keeps its manifold when both bodies rested, since
+	 *  nothing could have changed it. */
+	class CContactCache
+	{
+		core::vector<ContactManifold> manifolds_;
+		core::vector<ContactManifold> incoming_;
+		core::vector<ContactManifold> merged_;
+		core::vector<ContactEvent> events_;
+
+		static uint64_t Key(Entity first, Entity second) { return uint64_t(first) << 32 | second; }
+		static uint64_t Key(const ContactManifold& manifold) { return Key(manifold.first, manifold.second); }
+
+	public:
+		void Begin();
+		/// Order of a and b does not matter, the normal is flipped to match first < second.
+		void Add(Entity a, Entity b, const vec3& normal, float depth);
+		/// resting[entity] != 0 marks a body that did not move this step; other or unknown entities end their untested pairs.
+		void End(const core::vector<unsigned char>& resting);
+
+		const ContactManifold* Find(Entity a, Entity b) const;
+		const core::vector<ContactManifold>& GetManifolds() const { return manifolds_; }
+		const core::vector<ContactEvent>& GetEvents() const { return events_; }
+	};
+}
+
+#endif
@@ -0,0 +1,56 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef DISJOINT_SET
+#define DISJOINT_SET
+
+#include "Vector.hpp"
+
+namespace GLVM::core
+{
+	/*! Union-find over the indices [0, count), used to group touching bodies
+	 *  into islands. Union by size with path halving, both near constant. */
+	class CDisjointSet
+	{
+		core::vector<unsigned int> parent_;
+		core::vector<unsigned int> size_;
+
+	public:
+		/// Every index becomes its own set, the buffers are kept between resets.
+		void Reset(unsigned int count) {
+			parent_.Resize(count);
+			size_.Resize(count);
+			for ( unsigned int i = 0; i < count; ++i ) {
+				parent_[i] = i;
+				size_[i] = 1;
+			}
+		}
+
+		unsigned int Find(unsigned int index) {
+			while ( parent_[index] != index ) {
+				parent_[index] = parent_[parent_[index]];
+				index = parent_[index];
+			}
+			return index;
+		}
+
+		void Union(unsigned int a, unsigned int b) {
+			a = Find(a);
+			b = Find(b);
+			if ( a == b )
+				return;
+
+			if ( size_[a] < size_[b] ) {
+				unsigned int swap = a;
+				a = b;
+				b = swap;
+			}
+			parent_[b] = a;
+			size_[a] += size_[b];
+		}
+	};
+}
+
+#endif
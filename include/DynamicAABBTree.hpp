@@ -0,0 +1,87 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef DYNAMIC_AABB_TREE
+#define DYNAMIC_AABB_TREE
+
+#include "Vector.hpp"
+#include "VertexMath.hpp"
+
+namespace GLVM::core
+{
+	/// Segment origin + t * delta, t in [0, 1].
+	struct Ray
+	{
+		vec3 origin;
+		vec3 delta;
+	};
+
+	struct RaycastHit
+	{
+		int proxy = -1;                 ///< -1 when the ray hit nothing.
+		float t = 1.0f;
+		unsigned int userData = 0;
+	};
+
+	/*! Bounding volume hierarchy over moving boxes. Every leaf keeps the exact
+	 *  box for the final test and a box grown by a margin for the hierarchy,
+	 *  so a leaf that moves inside its fat box only stores the new exact box.
+	 *  Leaving it removes the leaf and inserts it again at the cheapest
+	 *  sibling by surface area; the ancestors are refit and rotated on the
+	 *  way up to keep the height logarithmic. */
+	class CDynamicAABBTree
+	{
+		struct Node
+		{
+			AABB fat;
+			AABB bounds;
+			int parent;            ///< Next free node while the node is in the free list.
+			int left;
+			int right;
+			int height;            ///< 0 for leaves, -1 for free nodes.
+			unsigned int userData;
+		};
+
+		static constexpr int kStackSize = 256;
+
+		core::vector<Node> nodes_;
+		int root_ = kNullNode;
+		int freeList_ = kNullNode;
+		int proxiesNumber_ = 0;
+		float margin_;
+
+		bool IsLeaf(int node) const { return nodes_[node].left == kNullNode; }
+		int AllocateNode();
+		void FreeNode(int node);
+		void InsertLeaf(int leaf);
+		void RemoveLeaf(int leaf);
+		void RefitAncestors(int node);
+		int Balance(int node);
+
+	public:
+		static constexpr int kNullNode = -1;
+
+		CDynamicAABBTree(float margin = 0.1f) : margin_(margin) {}
+
+		int CreateProxy(const AABB& bounds, unsigned int userData);
+		void DestroyProxy(int proxy);
+		/// Returns true when the leaf left its fat box and was reinserted.
+		bool MoveProxy(int proxy, const AABB& bounds);
+
+		const AABB& GetFatAABB(int proxy) const { return nodes_[proxy].fat; }
+		unsigned int GetUserData(int proxy) const { return nodes_[proxy].userData; }
+		int GetProxiesNumber() const { return proxiesNumber_; }
+		int GetHeight() const { return root_ == kNullNode ? 0 : nodes_[root_].height; }
+
+		/// Appends the proxies whose exact box overlaps the query box.
+		void QueryAABB(const AABB& box, core::vector<int>& proxies) const;
+		/// Closest exact box hit of each segment, written to hits[i].
+		void RaycastBatch(const Ray* rays, unsigned int count, RaycastHit* hits) const;
+		/// Checks links, heights and that every parent box holds its children.
+		bool Validate() const;
+	};
+}
+
+#endif
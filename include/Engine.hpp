@@ -16,6 +16,7 @@
 #include "ISoundEngine.hpp"
 #include "ShaderProgram.hpp"
 #include "EventsStack.hpp"
+#include "FixedTimestep.hpp"
 #include "Event.hpp"
 #include "Texture.hpp"
 #include "TimerCreator.hpp"
@@ -49,6 +50,7 @@ namespace GLVM::core
 
 		float                deltaFrameTime;
 		float                gravity;
+		CFixedTimestep       fixedTimestep_;
 		CStack               Input_Stack_;
 		std::vector<ecs::Texture> textureVector;
 		core::vector<ecs::TextureHandle> textureHandlers;
@@ -63,12 +65,18 @@ namespace GLVM::core
 		ecs::CMovementSystem   * movementSystem;
         ecs::CPhysicsSystem    * physicsSystem;
         ecs::CProjectileSystem * projectileSystem;
+		ecs::CWorldBoundsSystem* worldBoundsSystem;
+
+		IRenderer*           activeRenderer_ = nullptr;   ///< The renderer GameLoop() runs.
 
 		/// For FPS counting
 		unsigned int fpsCounter = 0;
 		double fpsAccumulator   = 0;
+		bool bStatsReport_      = false;
 		
         Engine();
+		void StorePreviousTransforms();
+		void SimulateFixedStep(float step);
         
 	public:
 
@@ -89,10 +97,16 @@ namespace GLVM::core
 		ecs::components::MeshHandle LoadMeshFromFile_OBJ(const char* _pathToMesh);
 		ecs::components::MeshHandle LoadMeshFromFile_GLTF(const char* pathToMesh);
 		void FPScounter();
+		/// Once a second prints the FPS, the sleeping bodies and the renderer counters. Off by default, set before GameLoop().
+		void SetStatsReport(bool enabled) { bStatsReport_ = enabled; }
 		void GameKill();
 		
 		// Get sound engine for procedural music
 		Sound::ISoundEngine* GetSoundEngine() const { return soundEngine; }
+		/// Step length and substep limit of the simulation, set before GameLoop().
+		CFixedTimestep& GetFixedTimestep() { return fixedTimestep_; }
+		/// Pools whose entities are recycled once they leave the world, and the height they leave it at.
+		ecs::CWorldBoundsSystem* GetWorldBoundsSystem() { return worldBoundsSystem; }
 	};
 }
 
@@ -0,0 +1,54 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef FIXED_TIMESTEP
+#define FIXED_TIMESTEP
+
+namespace GLVM::core
+{
+	/*! Turns variable frame times into a whole number of simulation steps of
+	 *  constant length. The remainder is carried to the next frame and its
+	 *  fraction of a step is the blend factor between the previous and the
+	 *  current simulated state. A frame longer than maxSubsteps steps (a
+	 *  breakpoint, a window drag) drops the excess time instead of trying to
+	 *  catch up and falling further behind. */
+	class CFixedTimestep
+	{
+		double step_;
+		double accumulator_ = 0.0;
+		unsigned int maxSubsteps_;
+
+	public:
+		CFixedTimestep(double step = 1.0 / 60.0, unsigned int maxSubsteps = 5)
+			: step_(step), maxSubsteps_(maxSubsteps) {}
+
+		/// Adds the frame time and returns how many steps to simulate now.
+		unsigned int Advance(double frameTime) {
+			accumulator_ += frameTime;
+
+			unsigned int steps = 0;
+			while ( accumulator_ >= step_ && steps < maxSubsteps_ ) {
+				accumulator_ -= step_;
+				++steps;
+			}
+
+			if ( accumulator_ >= step_ )
+				accumulator_ = 0.0;
+
+			return steps;
+		}
+
+		/// How far the render time is between the last two steps, in [0, 1).
+		float GetAlpha() const { return static_cast<float>(accumulator_ / step_); }
+		float GetStep() const { return static_cast<float>(step_); }
+		unsigned int GetMaxSubsteps() const { return maxSubsteps_; }
+
+		void SetStep(double step) { step_ = step; }
+		void SetMaxSubsteps(unsigned int maxSubsteps) { maxSubsteps_ = maxSubsteps; }
+		void Reset() { accumulator_ = 0.0; }
+	};
+}
+
+#endif
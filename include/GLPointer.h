@@ -31,6 +31,9 @@
 
 EXTERN_C void Initializer();
 
+/* Non-zero when the context is at least major.minor or exposes the extension, which brings the same entry points. */
+EXTERN_C int GLSupports(int major, int minor, const char* extension);
+
 EXTERN void (*pGLVertex_Arrays)(GLsizei, GLuint);
 
 EXTERN void (*pGLGen_Vertex_Arrays)(GLsizei, GLuint *);
@@ -116,6 +119,11 @@ EXTERN void (*pGLFramebuffer_Texture2D)(GLenum target, GLenum atachment, GLenum
 
 EXTERN void (*pGLFramebuffer_Texture)(GLenum target, GLenum attachment, GLuint texture, GLint level);
 
+EXTERN void (*pGLFramebuffer_Texture_Layer)(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer);
+
+EXTERN void (*pGLTex_Image_3D)(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+							   GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels);
+
 EXTERN void (*pGLUniform1fv)(GLint location, GLsizei count, const GLfloat* value);
 
 EXTERN void (*pGLUniform3fv)(GLint location, GLsizei count, const GLfloat* value);
@@ -124,6 +132,50 @@ EXTERN void (*pGLUniformMatrix4fv)(GLint location, GLsizei count, GLboolean tran
 
 EXTERN void (*pGLUniform1iv)(GLint location, GLsizei count, const GLint* value);
 
+EXTERN void (*pGLGet_Active_Uniform)(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length,
+									 GLint* size, GLenum* type, GLchar* name);
+
+EXTERN void (*pGLGet_Active_Uniformsiv)(GLuint program, GLsizei uniformCount, const GLuint* uniformIndices,
+										GLenum pname, GLint* params);
+
+EXTERN void (*pGLBuffer_Sub_Data)(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+
+EXTERN void (*pGLBind_Buffer_Base)(GLenum target, GLuint index, GLuint buffer);
+
+EXTERN void (*pGLBind_Buffer_Range)(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+EXTERN GLuint (*pGLGet_Uniform_Block_Index)(GLuint program, const GLchar* uniformBlockName);
+
+EXTERN void (*pGLUniform_Block_Binding)(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+
+EXTERN void (*pGLVertex_Attrib_Divisor)(GLuint index, GLuint divisor);
+
+EXTERN void (*pGLBuffer_Storage)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+EXTERN void* (*pGLMap_Buffer_Range)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+
+EXTERN GLboolean (*pGLUnmap_Buffer)(GLenum target);
+
+EXTERN GLsync (*pGLFence_Sync)(GLenum condition, GLbitfield flags);
+
+EXTERN GLenum (*pGLClient_Wait_Sync)(GLsync sync, GLbitfield flags, GLuint64 timeout);
+
+EXTERN void (*pGLDelete_Sync)(GLsync sync);
+
+EXTERN const GLubyte* (*pGLGet_Stringi)(GLenum name, GLuint index);
+
+EXTERN void (*pGLCopy_Buffer_Sub_Data)(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset,
+									   GLsizeiptr size);
+
+EXTERN void (*pGLDraw_Elements_Instanced_Base_Vertex)(GLenum mode, GLsizei count, GLenum type, const void* indices,
+													  GLsizei instancecount, GLint basevertex);
+
+EXTERN void (*pGLMulti_Draw_Elements_Indirect)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount,
+											   GLsizei stride);
+
+EXTERN void (*pGLDraw_Elements_Instanced)(GLenum mode, GLsizei count, GLenum type, const void* indices,
+										  GLsizei instancecount);
+
 #ifdef __linux__
 EXTERN void (*pGLXSwap_Interval_EXT)(Display *, GLXDrawable, int);
 #endif
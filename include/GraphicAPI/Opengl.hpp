@@ -30,7 +30,14 @@
 #include <GL/glext.h>
 #include "ShaderProgram.hpp"
 #include "ToString.hpp"
+#include "StreamingBuffer.hpp"
+#include "MeshBuffer.hpp"
+#include "RenderQueue.hpp"
+#include "InstanceBatch.hpp"
+#include "ShadowAtlas.hpp"
 #include <fstream>
+#include <memory>
+#include <unordered_map>
 
 #ifdef __linux__
 //#include "UnixApi/WindowXOpengl.hpp"
@@ -50,6 +57,92 @@
 */
 
 namespace GLVM::core {
+	/// std140 images of the light structs in CoreShader.frag, a scalar rides in the w of the vec4 before it.
+	struct DirectionalLightBlock
+	{
+		vec4 position;
+		vec4 direction;
+		vec4 ambient;
+		vec4 diffuse;
+		vec4 specular;
+	};
+
+	struct PointLightBlock
+	{
+		vec4 positionConstant;
+		vec4 ambientLinear;
+		vec4 diffuseQuadratic;
+		vec4 specular;
+	};
+
+	struct SpotLightBlock
+	{
+		vec4 positionCutOff;
+		vec4 directionOuterCutOff;
+		vec4 ambientConstant;
+		vec4 diffuseLinear;
+		vec4 specularQuadratic;
+	};
+
+	/// Per instance vertex attributes 5 to 9, the model matrix rows become the shader mat4 columns.
+	struct InstanceData
+	{
+		mat4 modelMatrix;
+		vec4 ambientShininess;     ///< Material ambient in xyz, shininess in w.
+	};
+	static_assert(sizeof(InstanceData) == 20 * sizeof(float), "InstanceData must match the instance attribute layout");
+
+	/// Layout glMultiDrawElementsIndirect reads, one per batch; baseInstance reaches the batch in the instance data.
+	struct DrawElementsIndirectCommand
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	enum ERenderPass
+	{
+		eCAMERA_PASS,
+		eDIRECTIONAL_SHADOW_PASS,
+		eSPOT_SHADOW_PASS,
+		ePOINT_SHADOW_PASS,           ///< All six cube faces, drawn at once by the geometry shader.
+		eRENDER_PASSES_NUMBER
+	};
+
+	/// GL binds and draws the frame passes made, summed over every pass until reset.
+	struct RenderStateStats
+	{
+		unsigned long textureBinds = 0;
+		unsigned long vertexArrayBinds = 0;
+		unsigned long paletteUploads = 0;           ///< Palette writes, one per frame with skinned meshes.
+		unsigned long paletteUploadBytes = 0;
+		unsigned long paletteBinds = 0;             ///< Palette ranges bound, one per skinned draw.
+		unsigned long draws = 0;                    ///< Batches drawn.
+		unsigned long drawCalls = 0;                ///< GL draw calls, a multi draw submits several batches in one.
+		unsigned long drawnInstances[eRENDER_PASSES_NUMBER] = {};
+		unsigned long culledInstances[eRENDER_PASSES_NUMBER] = {};
+		unsigned long reusedShadowMaps = 0;
+		unsigned long framebufferBinds = 0;
+		unsigned long shadowSamplerBinds = 0;
+	};
+
+	/// What a shadow map was last rendered from, it stays valid while neither signature changes.
+	struct ShadowMapState
+	{
+		uint64_t light;            ///< Light space matrix and tile side, or the position and range of a point light.
+		uint64_t casters;          ///< Sum of the content hashes of the casters inside the light volume.
+	};
+
+	enum EUniformBufferBinding
+	{
+		eDIRECTIONAL_LIGHTS_BINDING,
+		ePOINT_LIGHTS_BINDING,
+		eSPOT_LIGHTS_BINDING,
+		eSKIN_PALETTE_BINDING
+	};
+
 	class COpenglRenderer : public IRenderer {
 	public:
 #ifdef __linux__
@@ -69,16 +162,20 @@ namespace GLVM::core {
 //		unsigned int appropriateLightComponentIndex = 0;
 		const unsigned int SCREEN_WIDTH  = 1920;
 		const unsigned int SCREEN_HEIGHT = 1080;
-		const unsigned int SHADOW_WIDTH  = 1024;
+		const unsigned int SHADOW_WIDTH  = 1024;            ///< Side of every point light cube face.
 		const unsigned int SHADOW_HEIGHT = 1024;
-		Shader* coreShaderProgram;
-		Shader* flatShadowMapShaderProgram;
-		Shader* cubeShadowMapShaderProgram;
+		const unsigned int SHADOW_ATLAS_SIZE = 2048;        ///< Side of the atlas holding every directional and spot light map.
+		const unsigned int POINT_SHADOW_MAPS_NUMBER = 2;    ///< Cubes in the point light shadow map array.
+		/// Indexed by EBatchShader, the skinned variant is compiled with SKINNED defined.
+		Shader* coreShaderPrograms[eBATCH_SHADERS_NUMBER];
+		Shader* flatShadowMapShaderPrograms[eBATCH_SHADERS_NUMBER];
+		Shader* cubeShadowMapShaderPrograms[eBATCH_SHADERS_NUMBER];
 		Shader* debugQuadDepth_;
 		Shader* debugLines;                            ///< For debug only
 		GLuint quadVAO_;
 		GLuint quadVBO_;
 		float delta;
+		float interpolationAlpha_ = 1.0f;              ///< Set by the engine each frame, see SetInterpolationAlpha().
 		std::vector<ecs::Texture> textureVector;
 		std::vector<const char*> pathsArray_;
 		core::vector<const char*> pathsGLTF_;
@@ -107,18 +204,12 @@ namespace GLVM::core {
 
 		
 		/// Directional light
-		std::vector<unsigned int> directionalLightFlatShadowMapFBOcontainer;
-		std::vector<unsigned int> directionalLightFlatShadowMapTextureContainer;
 		std::vector<unsigned int> sampledDirectionalLightEntityIDcontainer; ///< Sampled depend on distance from light source to object entity IDs for poit light shadow map.
 
 		/// Point light
-		std::vector<unsigned int> pointLightCubeShadowMapFBOcontainer;
-		std::vector<unsigned int> pointLightCubeShadowMapTextureContainer;
 		std::vector<unsigned int> sampledPointLightEntityIDcontainer; ///< Sampled depend on distance from light source to object entity IDs for poit light shadow map.
 
 		/// Spot light
-		std::vector<unsigned int> spotLightFlatShadowMapTextureContainer;
-		std::vector<unsigned int> spotLightFlatShadowMapFBOContainer;
 		std::vector<unsigned int> sampledSpotLightEntityIDcontainer;
 		float borderColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f }; ///< Border color for fix shadow issue in flat shadow map in long range.
 		float fYaw   = -90.0f;
@@ -129,6 +220,8 @@ namespace GLVM::core {
 		float farPlaneFlatShadowMap = 25.0f;
 		float nearPlaneCubeShadowMap = 1.0f;
 		float farPlaneCubeShadowMap  = 25.0f;
+		float nearPlaneView = 0.1f;
+		float farPlaneView  = 1000.0f;                 ///< Also the range of the render queue depth.
 		bool shadows = true;
 		std::vector<ecs::Texture> texture_load_data;
         std::vector<ecs::Texture> hudTexture_load_data_;
@@ -144,44 +237,125 @@ namespace GLVM::core {
 		
 //		core::vector<core::vector<Vector<short, 4>>> jointIndicesPerVertex;
 //		core::vector<core::vector<vec4>> weightsPerVertex;
-		std::vector<GLuint> VBOcontainer_;
-		std::vector<GLuint> VAOcontainer_;
-		std::vector<GLuint> EBOcontainer_;
-		unsigned int directionalLightUniformLocations[5];
-		unsigned int pointLightUniformLocations[7];
-		unsigned int spotLightUniformLocations[10];
+		/// Every mesh in the shared buffers, indexed by mesh handle.
+		std::unique_ptr<CMeshBuffer> meshBuffer_;
+		std::vector<MeshRange> meshRanges_;
+		/// GL 4.3 or ARB_multi_draw_indirect with ARB_base_instance: each pass goes out as a few multi draws, one per
+		/// change of shader variant, textures or palette. Without it every batch is a base vertex draw of its own.
+		bool multiDrawIndirect_ = false;
+		std::vector<DrawElementsIndirectCommand> drawCommands_;
+		/// Core shader array uniforms per variant, field f of element n at [n * fieldsNumber + f], grown by ResolveArrayUniforms().
+		std::vector<UniformHandle> sampledDirectionalShadowUniforms_[eBATCH_SHADERS_NUMBER];
+		std::vector<UniformHandle> sampledSpotShadowUniforms_[eBATCH_SHADERS_NUMBER];
+		std::vector<UniformHandle> sampledPointShadowUniforms_[eBATCH_SHADERS_NUMBER];
+		/// The six face matrices of the cube shadow shader per variant, resolved with the programs.
+		std::vector<UniformHandle> shadowMatrixUniforms_[eBATCH_SHADERS_NUMBER];
+
+		/// Lights of every kind go to the core shader as one block each, packed and streamed once per frame.
+		/// A block holds as many lights as GL_MAX_UNIFORM_BLOCK_SIZE allows, lights past that are not lit.
+		std::vector<DirectionalLightBlock> directionalLightBlocks_;
+		std::vector<PointLightBlock> pointLightBlocks_;
+		std::vector<SpotLightBlock> spotLightBlocks_;
+		unsigned int maxDirectionalLights_ = 0;
+		unsigned int maxPointLights_ = 0;
+		unsigned int maxSpotLights_ = 0;
+
+		/// Entities sharing a mesh and textures are drawn as one batch, built once per frame and reused by every pass.
+		/// Skinned entities get a batch of their own, they differ by their joint matrices.
+		std::vector<InstanceData> instances_;
+		std::vector<InstanceBatch> batches_;
+		/// paletteStride_ matrices per skinned batch, the first MAX_JOINTS_NUMBER used. Streamed once per frame, each
+		/// skinned draw binds the range of its batch.
+		std::vector<mat4> skinPalettes_;
+		GLintptr skinPalettesOffset_ = 0;              ///< Where the palettes of the frame start in uniformStream_.
+		unsigned int paletteStride_ = MAX_JOINTS_NUMBER;  ///< A palette rounded up to the uniform buffer offset alignment.
+		/// Variants the frame draws with. The skinned ones are kept up to date only while skinned meshes are drawn.
+		unsigned int shaderVariantsNumber_ = 1;
+		CRenderQueue renderQueue_;                     ///< Draw order of the frame, entities keyed by shader, textures, mesh and depth.
+		/// Local bounds of every mesh, indexed like meshRanges_.
+		std::vector<AABB> meshBounds_;
+		/// World bounds of instances_, centers and half extents, tested against every pass.
+		std::vector<float> instanceCenterX_, instanceCenterY_, instanceCenterZ_;
+		std::vector<float> instanceExtentX_, instanceExtentY_, instanceExtentZ_;
+		std::vector<unsigned char> visibleInstances_;
+		/// Hash of entity, mesh, model matrix and joint palette per instance, all a depth pass depends on.
+		std::vector<uint64_t> instanceHashes_;
+		/// Keyed by atlas tile corner, x | y << 16, or by kPointShadowSlot | cube index for the point light cubes.
+		std::unordered_map<uint32_t, ShadowMapState> shadowMapStates_;
+		/// Every shadow map is rendered through one FBO into one of two textures, and the core shader samples
+		/// both with two binds whatever the number of lights.
+		GLuint shadowFBO_ = 0;
+		GLuint shadowAtlasTexture_ = 0;                ///< Directional and spot light maps, a tile each.
+		GLuint pointShadowMapArray_ = 0;               ///< Cube map array, one cube per shadowed point light.
+		GLuint shadowAttachedTexture_ = 0;
+		GLint shadowAttachedLayer_ = -1;
+		bool shadowFramebufferBound_ = false;
+		CShadowAtlas shadowAtlas_{ SHADOW_ATLAS_SIZE, 256 };
+		ShadowTile directionalShadowTiles_[4];         ///< Indexed like directionalLightSpaceMatrixContainer.
+		ShadowTile spotShadowTiles_[8];                ///< Indexed like spotLightSpaceMatrixContainer.
+		uint64_t shadowTilesLayout_ = 0;               ///< Tiles of the last frame, a change invalidates every atlas tile.
+		/// Instances a pass did not cull, packed in batch order; unused when nothing was culled.
+		std::vector<InstanceData> passInstances_;
+		std::vector<InstanceBatch> passBatches_;
+		/// Every pass writes its instances into instanceStream_, the frame's lights and palettes go to uniformStream_.
+		/// Both are fenced per frame, so no write waits on draws of the frames still in flight.
+		std::unique_ptr<CStreamingBuffer> instanceStream_;
+		std::unique_ptr<CStreamingBuffer> uniformStream_;
+		std::unique_ptr<CStreamingBuffer> indirectStream_;   ///< Draw commands of every pass, with multiDrawIndirect_ only.
+		/// Offset of all of instances_ in instanceStream_, written by the first pass that culls nothing; -1 until then.
+		GLintptr frameInstancesOffset_ = -1;
+		unsigned int frameInstancesAllocation_ = 0;    ///< instanceStream_ allocation frameInstancesOffset_ points into.
+		mat4 cameraViewMatrix_{ 1.0f };
+		mat4 cameraProjectionMatrix_{ 1.0f };
+		inline static RenderStateStats stateStats;
 
 		COpenglRenderer();
 		~COpenglRenderer();
 
 		void draw() override;
-		void AllocateTextureMemory(std::vector<unsigned int>& shadowMapFBOcontainer,
-								   std::vector<unsigned int>& shadowMapTextureContainer,
-								   GLenum textureTarget, GLint clampType,
-								   unsigned int lightSourceNumber,
-			                       std::string shadowMapArrayType,
-								   unsigned int textureUnitBaseIndex);
-		void InitializeShadowMapData(unsigned int& fbo_, unsigned int& texture_, GLenum textureTarget_,
-									 GLint clampType_);
-		void AllocateTexture(GLenum textureTarget_, GLint clampType_ );
+		void AllocateShadowMaps();
+		/// Hands out atlas tiles to the shadowed directional and spot lights, biggest requests first.
+		void AllocateShadowTiles(unsigned int directionalLightsNumber, unsigned int spotLightsNumber);
+		/// Binds shadowFBO_ once per frame and changes its depth attachment only when it differs, layer -1 attaches all.
+		void AttachShadowTarget(GLuint texture, GLint layer);
+		/// Builds "arrayName[n]field" names only for elements not resolved yet, so steady frames build no strings.
+		void ResolveArrayUniforms(Shader* shaderProgram, std::vector<UniformHandle>& handles, const char* arrayName,
+								  const char* const* fields, unsigned int fieldsNumber, unsigned int elementsNumber);
 		void ComputeDirectionalLight();
 		void ComputePointLight();
 		void ComputeSpotLight();
-		mat4 EvaluateFlatShadowMap(unsigned int& shadowMapFBO, ecs::components::directionalLight& directionalLightComponent,
+		/// Writes the light blocks and skin palettes of the frame into uniformStream_ and binds the light blocks.
+		void StreamFrameUniforms();
+		/// Both return the light space matrix mapped into the tile, the one the core shader samples the atlas with.
+		mat4 EvaluateFlatShadowMap(const ShadowTile& tile, ecs::components::directionalLight& directionalLightComponent,
 			                       mat4 projectionMatrixLight);
-		mat4 EvaluateFlatShadowMap(unsigned int& shadowMapFBO, ecs::components::spotLight& directionalLightComponent,
+		mat4 EvaluateFlatShadowMap(const ShadowTile& tile, ecs::components::spotLight& directionalLightComponent,
 			                       mat4 projectionMatrixLight);
-		void EvaluateCubeShadowMap(unsigned int& shadowMapFBO, ecs::components::pointLight& pointLightComponent);
+		/// Renders the depth of the tile from lightSpaceMatrix unless the tile still holds it.
+		void RenderFlatShadowMap(const ShadowTile& tile, mat4 lightSpaceMatrix, ERenderPass pass);
+		void EvaluateCubeShadowMap(unsigned int cubeIndex, ecs::components::pointLight& pointLightComponent);
 		void EvaluateCoreShader();
 		void EvaluateFlatDebugShader();
-		void RenderScene(Shader* shaderProgram_);
-		void Raycasting();
+		void BuildInstanceBatches();
+		/// Marks the instances inside the volume for the next RenderScene(), skinned ones move past their bind pose
+		/// bounds and always pass. Returns the caster signature of the marked set.
+		uint64_t CullInstances(const Frustum& frustum);
+		uint64_t CullInstances(const Sphere& range);
+		/// True when the slot still holds this light and casters; otherwise records them for the render that follows.
+		bool ReuseShadowMap(uint32_t shadowMapSlot, uint64_t light, uint64_t casters);
+		/// Static batches come first, so a pass switches to the skinned variant at most once.
+		void RenderScene(Shader* const* shaderPrograms, ERenderPass pass);
+		AABBStream GetInstanceBounds() const;
+		/// Points the attributes of the mesh VAO at the mesh buffer, again after every added mesh since it may have grown.
+		void PointMeshAttributes();
 		void RaycastingDebug();                                                         ///< TODO: For debug only
 		void RenderQuad();
 		void SetVertices(std::vector<unsigned int>& _aIndices,
 						 std::vector<float>& _aVertices);
 		void loadWavefrontObj() override;
 		void EnlargeFrameAccumulator(float value) override;
+		void SetInterpolationAlpha(float alpha) override { interpolationAlpha_ = alpha; }
+		void ReportStats(unsigned int frames) override;
 		void SetTextureData(std::vector<ecs::Texture>& _texture_data) override;
 		void SetMeshData(std::vector<const char*> _pathsArray, core::vector<const char*> pathsGLTF_) override;
 		void LoadTextureData(GLVM::ecs::Texture& texture);
@@ -189,8 +363,8 @@ namespace GLVM::core {
 		mat4 SetModelMatrix(ecs::components::transform& transformComponent_);
 		void SetViewMatrix(mat4 _viewMatrix) override;
 		void SetProjectionMatrix(mat4 _projectionMatrix) override;
-		void ComputeViewMatrix(Shader* shaderProgram, ecs::components::transform& player, ecs::components::beholder& beholder);
-		void ComputeProjectionMatrix(Shader* shaderProgram);
+		void ComputeViewMatrix(ecs::components::transform& player, ecs::components::beholder& beholder);
+		void ComputeProjectionMatrix();
 		void renderScene(const Shader& shader);
 		void renderCube();
 	};
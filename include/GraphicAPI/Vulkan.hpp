@@ -444,6 +444,8 @@ namespace GLVM::core
         void draw() override;
         void loadWavefrontObj() override;
 		void EnlargeFrameAccumulator(float value) override;
+		void SetInterpolationAlpha(float alpha) override { interpolationAlpha_ = alpha; }
+		void ReportStats(unsigned int) override {}            ///< Nothing is counted yet.
         void SetTextureData(std::vector<ecs::Texture>& _texture_data) override;
         void SetMeshData(std::vector<const char*> _pathsArray, core::vector<const char*> pathsGLTF) override;
         void SetViewMatrix(mat4 _viewMatrix) override;
@@ -453,6 +455,7 @@ namespace GLVM::core
         void run() override;
     
     private:
+		float interpolationAlpha_ = 1.0f;
         VkInstance instance;
         VkDebugUtilsMessengerEXT debugMessenger;
 		mat4 viewMatrix;
@@ -22,6 +22,8 @@ namespace GLVM::core
         virtual void draw() = 0;
         virtual void loadWavefrontObj() = 0;
 		virtual void EnlargeFrameAccumulator(float value) = 0;
+		virtual void SetInterpolationAlpha(float alpha) = 0;   ///< Blend between the last two fixed steps for the next draw().
+		virtual void ReportStats(unsigned int frames) = 0;     ///< Prints the counters of the last frames per frame and resets them.
         virtual void SetTextureData(std::vector<ecs::Texture>& _texture_data) = 0;
         virtual void SetMeshData(std::vector<const char*> _pathsArray, core::vector<const char*> pathsGLTF_) = 0;
         virtual void SetViewMatrix(mat4 _viewMatrix) = 0;
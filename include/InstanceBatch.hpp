@@ -0,0 +1,103 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef INSTANCE_BATCH
+#define INSTANCE_BATCH
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace GLVM::core
+{
+	/// Consecutive instances drawn with one call, all sharing the mesh and textures.
+	struct InstanceBatch
+	{
+		unsigned int meshID;
+		unsigned int diffuseTextureID;
+		unsigned int specularTextureID;
+		unsigned int firstInstance;
+		unsigned int instancesNumber;
+		int skinPalette;           ///< Index into the skin palettes, -1 for unskinned meshes.
+	};
+
+	/// Render queue shader field, also the index of the shader variant drawing the batch.
+	enum EBatchShader
+	{
+		eSTATIC_MESH_SHADER,
+		eSKINNED_MESH_SHADER,      ///< Each entity is a batch of its own, with its joint palette.
+		eBATCH_SHADERS_NUMBER
+	};
+
+	/*! Adds the next instance, in render queue order, to the last batch when
+	 *  it draws the same mesh with the same textures, to a new batch otherwise.
+	 *  The ids themselves decide: ids too wide for the key fields share a key
+	 *  with others. A skinned instance always gets a batch of its own, and no
+	 *  instance joins one. Returns true when it opened a batch, whose palette
+	 *  is then left to the caller. */
+	inline bool AddToBatches(std::vector<InstanceBatch>& batches, unsigned int instance, unsigned int meshID,
+							 unsigned int diffuseTextureID, unsigned int specularTextureID, bool skinned) {
+		if ( !batches.empty() && !skinned && batches.back().skinPalette < 0 && batches.back().meshID == meshID &&
+			 batches.back().diffuseTextureID == diffuseTextureID && batches.back().specularTextureID == specularTextureID ) {
+			++batches.back().instancesNumber;
+			return false;
+		}
+
+		batches.push_back({ meshID, diffuseTextureID, specularTextureID, instance, 1, -1 });
+		return true;
+	}
+
+	/*! True when drawing batch after previous changes GL state: a texture,
+	 *  or the palette range every skinned batch binds. A skinned batch on
+	 *  either side is also the only way the shader variant changes. A multi
+	 *  draw submits only batches that need no change in between. */
+	inline bool BreaksDrawRun(const InstanceBatch& batch, const InstanceBatch& previous) {
+		return batch.skinPalette >= 0 || previous.skinPalette >= 0 ||
+			batch.diffuseTextureID != previous.diffuseTextureID || batch.specularTextureID != previous.specularTextureID;
+	}
+
+	/// Matrices from one skin palette to the next: jointsNumber rounded up until the palette size in bytes is a
+	/// multiple of alignment, so every palette of a buffer starting aligned can be bound as a range of its own.
+	inline unsigned int PaletteStride(unsigned int jointsNumber, size_t matrixBytes, size_t alignment) {
+		unsigned int stride = jointsNumber;
+		while ( stride * matrixBytes % alignment != 0 )
+			++stride;
+		return stride;
+	}
+
+	/// Byte offset of a palette in the buffer whose palettes start at palettesOffset.
+	inline size_t PaletteOffset(size_t palettesOffset, int palette, unsigned int stride, size_t matrixBytes) {
+		return palettesOffset + palette * stride * matrixBytes;
+	}
+
+	/// FNV-1a over 32 bit words with a final avalanche, so sums of hashes stay well spread.
+	inline uint64_t HashWords(const void* data, size_t size, uint64_t hash) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for ( size_t offset = 0; offset + sizeof(uint32_t) <= size; offset += sizeof(uint32_t) ) {
+			uint32_t word;
+			std::memcpy(&word, bytes + offset, sizeof(word));
+			hash = (hash ^ word) * 1099511628211ull;
+		}
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	/// Caster signature of a pass: the sum of the hashes of the instances it keeps, skinned ones always kept.
+	/// A sum does not depend on the draw order, which follows the camera.
+	inline uint64_t SumVisibleHashes(const std::vector<InstanceBatch>& batches, const unsigned char* visible,
+									 const uint64_t* hashes) {
+		uint64_t casters = 0;
+		for ( const InstanceBatch& batch : batches )
+			for ( unsigned int i = batch.firstInstance; i < batch.firstInstance + batch.instancesNumber; ++i )
+				if ( visible[i] != 0 || batch.skinPalette >= 0 )
+					casters += hashes[i];
+		return casters;
+	}
+}
+
+#endif
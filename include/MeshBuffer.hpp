@@ -0,0 +1,56 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef MESH_BUFFER
+#define MESH_BUFFER
+
+#include "GLPointer.h"
+
+namespace GLVM::core
+{
+	/// Where a mesh lives in the shared buffers, all a base vertex draw of it needs.
+	struct MeshRange
+	{
+		GLuint firstIndex;
+		GLuint indicesNumber;
+		GLint baseVertex;
+	};
+
+	/*! Vertices and indices of every mesh in one vertex and one index buffer
+	 *  behind one VAO, so drawing another mesh binds nothing: the draw picks
+	 *  its range by first index and base vertex. Meshes are appended as they
+	 *  load, a full buffer is replaced by one twice the size with the old
+	 *  content copied over on the GPU. */
+	class CMeshBuffer
+	{
+		GLuint vertexArray_ = 0;
+		GLuint vertexBuffer_ = 0;
+		GLuint indexBuffer_ = 0;
+		GLsizei vertexStride_;
+		GLsizeiptr vertexCapacity_;
+		GLsizeiptr indexCapacity_;
+		GLsizeiptr vertexBytes_ = 0;
+		GLsizeiptr indexBytes_ = 0;
+
+		/// Grows buffer to hold needed more bytes after the used ones, keeping those.
+		static void Reserve(GLuint& buffer, GLsizeiptr& capacity, GLsizeiptr used, GLsizeiptr needed);
+		static void Allocate(GLuint& buffer, GLsizeiptr capacity);
+
+	public:
+		CMeshBuffer(GLsizei vertexStride, GLsizeiptr vertexCapacity, GLsizeiptr indexCapacity);
+		~CMeshBuffer();
+		CMeshBuffer(const CMeshBuffer&) = delete;
+		CMeshBuffer& operator=(const CMeshBuffer&) = delete;
+
+		/// Appends a mesh whose indices count from its own first vertex. The vertex buffer may change, vertex
+		/// attributes have to be pointed at GetVertexBuffer() again; the index buffer is kept bound to the VAO.
+		MeshRange Add(const float* vertices, GLsizeiptr verticesBytes, const unsigned int* indices, GLuint indicesNumber);
+
+		GLuint GetVertexArray() const { return vertexArray_; }
+		GLuint GetVertexBuffer() const { return vertexBuffer_; }
+	};
+}
+
+#endif
@@ -0,0 +1,156 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef PREFAB
+#define PREFAB
+
+#include "ComponentManager.hpp"
+#include "EntityManager.hpp"
+#include "Vector.hpp"
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+
+namespace GLVM::ecs
+{
+	/// Type erased initial value of one component of a prefab.
+	class IPrefabComponent
+	{
+	public:
+		virtual ~IPrefabComponent() {}
+
+		virtual std::type_index GetType() const = 0;
+		virtual IPrefabComponent* Clone() const = 0;
+		virtual void Instantiate(ComponentManager* componentManager, const Entity* entities, unsigned int count) const = 0;
+	};
+
+	template <typename componentType>
+	class CPrefabComponent : public IPrefabComponent
+	{
+	public:
+		componentType value_;
+
+		CPrefabComponent(const componentType& value) : value_(value) {}
+
+		std::type_index GetType() const override { return typeid(componentType); }
+		IPrefabComponent* Clone() const override { return new CPrefabComponent<componentType>(value_); }
+		void Instantiate(ComponentManager* componentManager, const Entity* entities, unsigned int count) const override {
+			componentManager->CreateComponents<componentType>(entities, count, value_);
+		}
+	};
+
+	/*! Entity template: a component set with initial values. Instantiating
+	 *  writes each component type for the whole batch in one pass instead of a
+	 *  CreateComponent and a few GetComponent calls per entity. */
+	class CPrefab
+	{
+		std::string name_;
+		core::vector<IPrefabComponent*> components_;
+
+	public:
+		CPrefab(const char* name) : name_(name) {}
+		CPrefab(const CPrefab& prefab);
+		~CPrefab();
+		void operator=(const CPrefab& prefab) = delete;
+
+		const std::string& GetName() const { return name_; }
+		unsigned int GetComponentsNumber() const { return components_.GetSize(); }
+		const IPrefabComponent* GetComponentRecord(unsigned int index) const { return components_[index]; }
+
+		/// Adds the component or overwrites its initial value, returns the stored value.
+		template <typename componentType>
+		componentType* Add(const componentType& value = componentType{}) {
+			componentType* existing = Get<componentType>();
+			if ( existing != nullptr ) {
+				*existing = value;
+				return existing;
+			}
+
+			CPrefabComponent<componentType>* record = new CPrefabComponent<componentType>(value);
+			components_.Push(record);
+			return &record->value_;
+		}
+
+		template <typename componentType>
+		componentType* Get() {
+			const std::type_index type = typeid(componentType);
+			for ( unsigned int i = 0; i < components_.GetSize(); ++i ) {
+				if ( components_[i]->GetType() == type )
+					return &static_cast<CPrefabComponent<componentType>*>(components_[i])->value_;
+			}
+
+			return nullptr;
+		}
+	};
+
+	class CPrefabRegistry
+	{
+        static CPrefabRegistry* pInstance_;
+        static std::mutex  Mutex_;
+
+		core::vector<CPrefab*> prefabs_;
+
+		CPrefabRegistry() {}
+		~CPrefabRegistry();
+
+	public:
+        CPrefabRegistry(CPrefabRegistry& prefabRegistry) = delete;              ///< Dont need to make cope because of singleton property.
+        void operator=(const CPrefabRegistry& prefabRegistry) = delete;         ///< Dont need assignment operator because of singleton property.
+        static CPrefabRegistry* GetInstance();
+
+		/// Creates an empty prefab or returns the one already registered under this name.
+		CPrefab* Register(const char* name);
+		CPrefab* Get(const char* name);
+
+		/*! Loads every entry of the "prefabs" array of a JSON file:
+		 *  { "prefabs": [ { "name": "...", "components": { "transform": { ... }, ... } } ] }
+		 *  Known components are transform, rigidBody, collider, mesh, material,
+		 *  projectile and pointLight; fields missing in the file keep their defaults. */
+		bool LoadFromFile(const char* path);
+
+		/// Creates count entities and writes every prefab component for all of them.
+		core::vector<Entity> Instantiate(const CPrefab& prefab, unsigned int count = 1);
+		/// Writes the prefab values over the components the entities already own.
+		void Reset(const CPrefab& prefab, const Entity* entities, unsigned int count);
+	};
+
+	/*! Entities of one prefab that are recycled instead of destroyed. A released
+	 *  entity is disabled with its components left allocated; Acquire() enables
+	 *  it again with the prefab values and only instantiates when none is free.
+	 *  The lock covers the pool's own lists, so several threads may acquire and
+	 *  release. It does not cover the component writes: like any entity creation
+	 *  they race with systems reading the ComponentManager, and the spawner
+	 *  thread of EngineMain.cpp shares that race with the engine loop. */
+	class CPrefabPool
+	{
+		static constexpr unsigned int kNotActive = 0xFFFFFFFFu;
+
+		const CPrefab& prefab_;
+		core::vector<Entity> active_;
+		core::vector<Entity> free_;
+		core::vector<unsigned int> activeIndex_;    ///< Position in active_ by entity, kNotActive otherwise.
+		unsigned int created_ = 0;
+		mutable std::mutex mutex_;
+
+	public:
+		CPrefabPool(const CPrefab& prefab) : prefab_(prefab) {}
+		CPrefabPool(const CPrefabPool& pool) = delete;
+		void operator=(const CPrefabPool& pool) = delete;
+
+		Entity Acquire();
+		/// Ignored for an entity the pool did not hand out or already took back.
+		void Release(Entity entity);
+
+		/// Copy of the entities in use, safe to walk while other threads acquire or release.
+		core::vector<Entity> GetActive() const;
+		unsigned int GetActiveNumber() const;
+		unsigned int GetFreeNumber() const;
+		/// Entities ever instantiated by the pool, flat once releases keep up with acquires.
+		unsigned int GetCreatedNumber() const;
+	};
+}
+
+#endif
@@ -0,0 +1,118 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef QUERY
+#define QUERY
+
+#include "ComponentManager.hpp"
+#include "Vector.hpp"
+#include <tuple>
+
+namespace GLVM::ecs
+{
+	template <typename... Args> struct Include {};     ///< Entity must own every listed component.
+	template <typename... Args> struct Exclude {};     ///< Entity must own none of the listed components.
+	template <typename... Args> struct Optional {};    ///< Fetched when present, nullptr otherwise.
+
+	/// Sparse and component containers of one type, resolved once per query.
+	template <typename componentType>
+	struct QueryColumn
+	{
+		core::vector<Entity>* sparse;
+		core::vector<componentType>* components;
+		ComponentMask bit;
+
+		QueryColumn(ComponentManager* componentManager)
+			: sparse(componentManager->GetSparseContainer<componentType>()),
+			  components(componentManager->GetComponentContainer<componentType>()),
+			  bit(componentManager->GetComponentMask<componentType>()) {}
+
+		componentType* Get(Entity entity) const { return &(*components)[(*sparse)[entity]]; }
+		componentType* Find(Entity entity, ComponentMask entityMask) const {
+			return (entityMask & bit) ? Get(entity) : nullptr;
+		}
+	};
+
+	template <typename includeList, typename excludeList = Exclude<>, typename optionalList = Optional<>>
+	class Query;
+
+	/*! Query<Include<collider, transform>, Exclude<projectile>, Optional<move>>
+	 *  Walks the smallest included container and keeps an entity after a single
+	 *  check of its component mask against the include and exclude masks.
+	 *  Included components come back as valid pointers, optional ones as
+	 *  nullptr when missing, so no second entity list has to be searched. */
+	template <typename... includeTypes, typename... excludeTypes, typename... optionalTypes>
+	class Query<Include<includeTypes...>, Exclude<excludeTypes...>, Optional<optionalTypes...>>
+	{
+		static_assert(sizeof...(includeTypes) > 0, "Query needs at least one included component");
+
+		ComponentManager* componentManager_;
+		ComponentMask includeMask_;
+		ComponentMask excludeMask_;
+		std::tuple<QueryColumn<includeTypes>...> includeColumns_;
+		std::tuple<QueryColumn<optionalTypes>...> optionalColumns_;
+
+		core::vector<Entity>* SmallestIncludedContainer() const {
+			core::vector<Entity>* containers[] = { componentManager_->GetEntityContainer<includeTypes>()... };
+			core::vector<Entity>* smallest = containers[0];
+			for ( core::vector<Entity>* container : containers ) {
+				if ( container->GetSize() < smallest->GetSize() )
+					smallest = container;
+			}
+			return smallest;
+		}
+
+	public:
+		/// Components of one matched entity, included first, then optional.
+		struct Row
+		{
+			Entity entity;
+			std::tuple<includeTypes*..., optionalTypes*...> components;
+
+			template <typename componentType>
+			componentType* Get() const { return std::get<componentType*>(components); }
+		};
+
+		Query(ComponentManager* componentManager = ComponentManager::GetInstance())
+			: componentManager_(componentManager),
+			  includeMask_(componentManager->GetComponentMask<includeTypes...>()),
+			  excludeMask_(componentManager->GetComponentMask<excludeTypes...>()),
+			  includeColumns_(QueryColumn<includeTypes>(componentManager)...),
+			  optionalColumns_(QueryColumn<optionalTypes>(componentManager)...) {}
+
+		bool Matches(Entity entity) const {
+			ComponentMask entityMask = componentManager_->GetEntityMask(entity);
+			return (entityMask & includeMask_) == includeMask_ && (entityMask & excludeMask_) == 0;
+		}
+
+		/// Calls function(entity, includeTypes*..., optionalTypes*...) for each match.
+		template <typename functionType>
+		void ForEach(functionType&& function) const {
+			core::vector<Entity>& dense = *SmallestIncludedContainer();
+			for ( unsigned int i = 0; i < dense.GetSize(); ++i ) {
+				Entity entity = dense[i];
+				ComponentMask entityMask = componentManager_->GetEntityMask(entity);
+				if ( (entityMask & includeMask_) != includeMask_ || (entityMask & excludeMask_) != 0 )
+					continue;
+
+				function(entity,
+						 std::get<QueryColumn<includeTypes>>(includeColumns_).Get(entity)...,
+						 std::get<QueryColumn<optionalTypes>>(optionalColumns_).Find(entity, entityMask)...);
+			}
+		}
+
+		/// Matched rows in one array; pointers stay valid until components are added or removed.
+		core::vector<Row> Collect() const {
+			core::vector<Row> rows;
+			rows.Reserve(SmallestIncludedContainer()->GetSize());
+			ForEach([&rows](Entity entity, includeTypes*... included, optionalTypes*... optional) {
+				rows.Push(Row{ entity, { included..., optional... } });
+			});
+			return rows;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,52 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef RENDER_QUEUE
+#define RENDER_QUEUE
+
+#include "Vector.hpp"
+#include <cstdint>
+
+namespace GLVM::core
+{
+	struct RenderItem
+	{
+		uint64_t key;
+		unsigned int value;        ///< Left to the caller, the renderer stores the entity.
+	};
+
+	/*! Draws of one frame ordered by a 64 bit key, most significant field first:
+	 *  shader 4 bits, diffuse texture 12, specular texture 12, mesh 20, depth 16.
+	 *  Draws that need the same state end up next to each other, front to back
+	 *  inside it. Wider ids alias: the order then interleaves their draws, so
+	 *  callers batching on equal keys must compare the ids themselves. */
+	class CRenderQueue
+	{
+		core::vector<RenderItem> items_;
+		core::vector<RenderItem> scratch_;
+
+	public:
+		static constexpr unsigned int kDepthBits = 16;
+		static constexpr uint64_t kMaxDepth = (1u << kDepthBits) - 1;
+
+		static uint64_t MakeKey(unsigned int shader, unsigned int diffuseTextureID, unsigned int specularTextureID,
+								unsigned int meshID, unsigned int depth) {
+			return uint64_t(shader & 0xF) << 60 | uint64_t(diffuseTextureID & 0xFFF) << 48 |
+				uint64_t(specularTextureID & 0xFFF) << 36 | uint64_t(meshID & 0xFFFFF) << kDepthBits | (depth & kMaxDepth);
+		}
+		static unsigned int ShaderOf(uint64_t key) { return unsigned(key >> 60); }
+
+		/// Keeps the storage for the next frame.
+		void Clear() { items_.Resize(0); }
+		void Push(uint64_t key, unsigned int value);
+		/// LSD radix sort on bytes, stable, bytes every key shares are skipped.
+		void Sort();
+
+		unsigned int GetSize() const { return items_.GetSize(); }
+		const RenderItem& operator[](unsigned int index) const { return items_[index]; }
+	};
+}
+
+#endif
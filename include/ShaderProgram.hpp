@@ -10,13 +10,30 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <cstdint>
+#include <unordered_map>
 #include "GLPointer.h"
 #include "VertexMath.hpp"
 
+/// Uniform location resolved once after link, -1 when the program does not use the uniform.
+struct UniformHandle
+{
+	GLint location = -1;
+};
+
+/// Driver uniform entry points called since the last reset, for per frame reports.
+struct UniformCallStats
+{
+	unsigned int locationQueries = 0;    ///< glGetUniformLocation.
+	unsigned int uploads = 0;            ///< glUniform*.
+	unsigned int uploadBytes = 0;        ///< Data the glUniform* calls passed.
+};
+
 /*! \class Shader
     \brief Class for creating shader program
 
-    Contains vertex and fragment shaders
+    Contains vertex and fragment shaders. Optional defines are inserted after the
+    #version line of every stage, for limits only known once the context exists.
 */
 
 class Shader
@@ -24,7 +41,8 @@ class Shader
 public:
     unsigned int iID;
 
-    Shader(const char* vertexShaderPath_, const char* fragmentShaderPath_, const char* geometryShaderPath_ = nullptr)
+    Shader(const char* vertexShaderPath_, const char* fragmentShaderPath_, const char* geometryShaderPath_ = nullptr,
+		   const char* defines_ = nullptr)
     {
         std::string vertexShaderCode;
         std::string fragmentShaderCode;
@@ -68,6 +86,9 @@ public:
         {
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
         }
+		InsertDefines(vertexShaderCode, defines_);
+		InsertDefines(fragmentShaderCode, defines_);
+		InsertDefines(geometryShaderCode, defines_);
         const char* pVertexShaderCode   = vertexShaderCode.c_str();
         const char* pFragmentShaderCode = fragmentShaderCode.c_str();
 
@@ -109,8 +130,18 @@ public:
         pGLDelete_Shader(uiFragment);
 		if (geometryShaderPath_ != nullptr)
 			pGLDelete_Shader(uiGeometryShaderID);
+
+		ResolveUniforms();
     }
 
+	inline static UniformCallStats callStats;
+
+	/// Table lookup, no driver call; names follow glGetUniformLocation ("lights[2].position", "bones[0]", "bones").
+	UniformHandle GetUniform(const char* name) const;
+	UniformHandle GetUniform(const std::string& name) const { return GetUniform(name.c_str()); }
+	/// Points the named uniform block at a buffer binding, a block the program does not use is ignored.
+	void BindUniformBlock(const char* blockName, GLuint binding) const;
+
     void Use();
     void SetBool(const std::string& name, bool value) const;
     void SetInt(const std::string& name, int value) const;
@@ -124,8 +155,25 @@ public:
 	void SetMat4(const std::string &name, mat4 &mat) const;
 	void SetMat4(const std::string &name, unsigned int matrixNumber, mat4 &mat) const;
 //	void SetMat4(const std::string &name, glm::mat4 &mat) const;
+
+	/// Pre-resolved variants for per draw and per light uniforms, an unused uniform costs nothing.
+	void SetBool(UniformHandle uniform, bool value) const;
+	void SetInt(UniformHandle uniform, int value) const;
+	void SetInt(UniformHandle uniform, GLsizei count, const GLint* value) const;
+	void SetFloat(UniformHandle uniform, float value) const;
+	void SetVec3(UniformHandle uniform, float x, float y, float z) const;
+	void SetVec3(UniformHandle uniform, const vec3& vector) const;
+	void SetVec4(UniformHandle uniform, float x, float y, float z, float w) const;
+	void SetVec4(UniformHandle uniform, int x, int y, int z, int w) const;
+	void SetMat4(UniformHandle uniform, const mat4& mat) const;
+	void SetMat4(UniformHandle uniform, unsigned int matrixNumber, const mat4& mat) const;
 	
 private:
+	std::unordered_map<uint64_t, GLint> uniformLocations_;    ///< Name hash to location of every active uniform.
+
+	static uint64_t HashName(const char* name);
+	static void InsertDefines(std::string& code, const char* defines);
+	void ResolveUniforms();
     void CheckCompileErrors(unsigned int shader, std::string type);
 };
 
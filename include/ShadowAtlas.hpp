@@ -0,0 +1,75 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef SHADOW_ATLAS
+#define SHADOW_ATLAS
+
+namespace GLVM::core
+{
+	/// Square region of the atlas in texels, size 0 when the light got none.
+	struct ShadowTile
+	{
+		unsigned int x = 0;
+		unsigned int y = 0;
+		unsigned int size = 0;
+	};
+
+	/*! Power of two square tiles packed into a square atlas. With requests in
+	 *  non increasing size every tile starts where the previous ones end in Z
+	 *  order, aligned to its own size, so the atlas fills without gaps. A
+	 *  request larger than the last one is lowered to keep that order. */
+	class CShadowAtlas
+	{
+		unsigned int size_;
+		unsigned int minTile_;
+		unsigned int used_ = 0;                ///< Tiles of minTile_ side taken so far.
+		unsigned int lastSize_;
+
+		/// Every other bit of a Z order index, one coordinate.
+		static unsigned int Compact(unsigned int bits) {
+			bits &= 0x55555555;
+			bits = (bits | (bits >> 1)) & 0x33333333;
+			bits = (bits | (bits >> 2)) & 0x0f0f0f0f;
+			bits = (bits | (bits >> 4)) & 0x00ff00ff;
+			bits = (bits | (bits >> 8)) & 0x0000ffff;
+			return bits;
+		}
+
+	public:
+		/// Both sides are powers of two, minTile at most size.
+		CShadowAtlas(unsigned int size, unsigned int minTile) : size_(size), minTile_(minTile), lastSize_(size) {}
+
+		void Reset() {
+			used_ = 0;
+			lastSize_ = size_;
+		}
+
+		/// Halves the side until the tile fits, false when not even a minTile one does.
+		bool Allocate(unsigned int size, ShadowTile& tile) {
+			unsigned int side = minTile_;
+			while ( side * 2 <= size && side * 2 <= lastSize_ )
+				side *= 2;
+
+			unsigned int capacity = (size_ / minTile_) * (size_ / minTile_);
+			for ( ; side >= minTile_; side /= 2 ) {
+				unsigned int cells = (side / minTile_) * (side / minTile_);
+				if ( used_ + cells > capacity )
+					continue;
+
+				tile = ShadowTile{ Compact(used_) * minTile_, Compact(used_ >> 1) * minTile_, side };
+				used_ += cells;
+				lastSize_ = side;
+				return true;
+			}
+
+			tile = ShadowTile{};
+			return false;
+		}
+
+		unsigned int GetSize() const { return size_; }
+	};
+}
+
+#endif
@@ -0,0 +1,57 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef SIMD_BOUNDS
+#define SIMD_BOUNDS
+
+#include "Vector.hpp"
+#include "VertexMath.hpp"
+
+namespace GLVM::core
+{
+	enum ESimdLevel
+	{
+		eSIMD_SCALAR,
+		eSIMD_SSE,       ///< Two 4 wide halves.
+		eSIMD_AVX2       ///< One 8 wide pass.
+	};
+
+	/*! Boxes stored as six coordinate arrays, so eight neighbouring boxes load
+	 *  into one register per coordinate. Every array holds kLanes empty boxes
+	 *  past the last one, a load starting at any valid index stays in bounds
+	 *  and its extra lanes never overlap anything. */
+	class CBoundsSoA
+	{
+		core::vector<float> minX_, minY_, minZ_;
+		core::vector<float> maxX_, maxY_, maxZ_;
+		unsigned int size_ = 0;
+
+	public:
+		static constexpr unsigned int kLanes = 8;
+
+		void Resize(unsigned int size);
+		void Set(unsigned int index, const AABB& box);
+		unsigned int GetSize() const { return size_; }
+
+		const float* GetMinX() const { return minX_.GetVectorContainer(); }
+		const float* GetMinY() const { return minY_.GetVectorContainer(); }
+		const float* GetMinZ() const { return minZ_.GetVectorContainer(); }
+		const float* GetMaxX() const { return maxX_.GetVectorContainer(); }
+		const float* GetMaxY() const { return maxY_.GetVectorContainer(); }
+		const float* GetMaxZ() const { return maxZ_.GetVectorContainer(); }
+	};
+
+	/// Kernel in use, the widest the CPU runs unless lowered by SetSimdLevel().
+	ESimdLevel GetSimdLevel();
+	/// Forces a narrower kernel, a level above the detected one is lowered to it.
+	void SetSimdLevel(ESimdLevel level);
+
+	/*! Bit i is set when box overlaps bounds[first + i], with the strict test of
+	 *  Overlaps(). first must be below bounds.GetSize(); lanes past the end
+	 *  come back clear. */
+	unsigned int OverlapMask8(const AABB& box, const CBoundsSoA& bounds, unsigned int first);
+}
+
+#endif
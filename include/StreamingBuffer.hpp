@@ -0,0 +1,73 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef STREAMING_BUFFER
+#define STREAMING_BUFFER
+
+#include "GLPointer.h"
+
+namespace GLVM::core
+{
+	/// GL 4.4 or ARB_buffer_storage, which immutable and persistently mapped buffers need.
+	bool BufferStorageSupported();
+
+	/// Summed over every streaming buffer, reset by whoever reports them.
+	struct StreamingBufferStats
+	{
+		unsigned long writtenBytes = 0;      ///< Copied into the buffers.
+		unsigned long stalls = 0;            ///< Regions the GPU still read when their turn came again.
+		unsigned long stallNanoseconds = 0;  ///< CPU time spent waiting on those regions.
+		unsigned long allocations = 0;       ///< Storage (re)allocations, a frame that outgrew its region adds one.
+	};
+
+	/*! Buffer for data rewritten every frame, split into kRegionsNumber regions
+	 *  used round robin. A frame writes only its own region and fences it in
+	 *  NextFrame(), the region is reused once that fence signalled, so writes
+	 *  never wait on draws still reading an older frame. With buffer storage
+	 *  (GL 4.4 or ARB_buffer_storage) the whole buffer stays mapped persistent
+	 *  and coherent; otherwise each write maps its range unsynchronized, which
+	 *  the fences make safe just the same. */
+	class CStreamingBuffer
+	{
+		static constexpr unsigned int kRegionsNumber = 3;
+
+		GLenum target_;
+		GLuint buffer_ = 0;
+		GLsizeiptr regionSize_;
+		GLsizeiptr alignment_;
+		GLintptr head_ = 0;                          ///< Next free byte of the current region.
+		unsigned int region_ = 0;
+		GLsync fences_[kRegionsNumber] = {};
+		unsigned char* mapping_ = nullptr;           ///< Whole buffer, only with persistent mapping.
+		unsigned int allocations_ = 0;
+
+		void Allocate();
+		void Release();
+
+	public:
+		static StreamingBufferStats stats;
+
+		/// Every offset Write() returns is a multiple of alignment, the region size is rounded up to one.
+		CStreamingBuffer(GLenum target, GLsizeiptr regionSize, GLsizeiptr alignment = 1);
+		~CStreamingBuffer();
+		CStreamingBuffer(const CStreamingBuffer&) = delete;
+		CStreamingBuffer& operator=(const CStreamingBuffer&) = delete;
+
+		/// Copies size bytes into the current region and returns their offset in the buffer. The
+		/// next span - size bytes are skipped, for ranges bound larger than the data they hold.
+		/// A full region makes new, larger storage: offsets returned before are lost with the old
+		/// one, which GetAllocations() tells.
+		GLintptr Write(const void* data, GLsizeiptr size, GLsizeiptr span = 0);
+		/// Fences the writes of this frame and moves to the next region, waiting if the GPU still reads it.
+		void NextFrame();
+
+		/// The buffer can change on Write(), bind it after writing.
+		GLuint GetBuffer() const { return buffer_; }
+		unsigned int GetAllocations() const { return allocations_; }
+		bool IsPersistent() const { return mapping_ != nullptr; }
+	};
+}
+
+#endif
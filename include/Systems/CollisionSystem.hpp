@@ -6,6 +6,11 @@
 #ifndef COLLISION_SYSTEM
 #define COLLISION_SYSTEM
 
+#include "Broadphase.hpp"
+#include "ContactCache.hpp"
+#include "DisjointSet.hpp"
+#include "Query.hpp"
+#include "SimdBounds.hpp"
 #include "Vector.hpp"
 #include "Components/EventComponent.hpp"
 #include "Components/RigidBodyComponent.hpp"
@@ -15,18 +20,70 @@
 #include "Event.hpp"
 #include "Components/MoveComponent.hpp"
 #include "Components/ColliderComponent.hpp"
+#include "Components/ControllerComponent.hpp"
+#include "Components/ProjectileComponent.hpp"
 #include "Vector.hpp"
 #include "VertexMath.hpp"
 #include "Components/ViewComponent.hpp"
 #include <mutex>
+#include <thread>
+#include <vector>
 #include "Globals.hpp"
 
 namespace GLVM::ecs
 {
 	class CCollisionSystem : public ISystem
-	{   
+	{
+		typedef Query<Include<components::collider, components::transform>, Exclude<>,
+					  Optional<components::move, components::rigidBody, components::projectile, components::controller>> CollisionQuery;
+
+		/// Flag the narrowphase wants raised on one body, applied after all pairs are tested.
+		struct Contact
+		{
+			unsigned int body;
+			unsigned int other;
+			bool ground;       ///< bGround_Collision_ when true, bWall_Collision_ otherwise.
+			float timeOfImpact;
+		};
+
+		static constexpr unsigned int kMinPairsPerWorker = 4096;    ///< Below this a thread costs more than it saves.
+
+		core::CSpatialHash spatialHash_;
+		core::CSweepAndPrune sweepAndPrune_;
+		core::vector<core::BroadphasePair> pairs_;
+		core::CBoundsSoA bounds_;                                     ///< Predicted bounds for the brute force sweep.
+		std::vector<core::vector<Contact>> contactBuffers_;          ///< One per worker, kept between frames.
+		core::vector<Contact> contacts_;
+		core::vector<unsigned char> active_;                          ///< Body moves this step: has a move, is a projectile or a bullet.
+		core::vector<unsigned char> bullets_;
+		core::vector<vec3> sweepStarts_;                              ///< Center at the start of the step.
+		core::vector<vec3> sweepDeltas_;                              ///< Center displacement over the step.
+		core::CDisjointSet islands_;
+		core::vector<float> islandSleepTimers_;                       ///< Shortest still time of each island root.
+		core::vector<unsigned int> wakingIslands_;
+		CContactCache contactCache_;
+		core::vector<unsigned char> restingByEntity_;                 ///< active_ inverted and indexed by entity, for the cache.
+		unsigned int awakeBodies_ = 0;
+		unsigned int sleepingBodies_ = 0;
+
+		void UpdateIslands(core::vector<CollisionQuery::Row>& bodies);
+		bool SweepTest(unsigned int backtracking, unsigned int compared,
+					   const core::vector<float>& halfScales, float& timeOfImpact) const;
+		void Penetration(unsigned int body, unsigned int other, const core::vector<float>& halfScales,
+						 float timeOfImpact, vec3& normal, float& depth) const;
+		void CacheContacts(core::vector<CollisionQuery::Row>& bodies, const core::vector<float>& halfScales);
+
 	public:
+		enum EBroadphase
+		{
+			eBRUTE_FORCE,      ///< Every pair, kept as reference for the other broadphases.
+			eSPATIAL_HASH,
+			eSWEEP_AND_PRUNE   ///< Keeps its order between frames, cheapest when most bodies rest.
+		};
         
+		EBroadphase broadphase = eSPATIAL_HASH;
+		unsigned int workersNumber = std::thread::hardware_concurrency();   ///< Narrowphase threads, 0 or 1 runs it inline.
+		float timeToSleep = 0.5f;          ///< Still time every body of an island needs before the island sleeps.
 		float fDelta_Time_;
 		float gravity;
         core::CStack& Input_Stack_;
@@ -45,6 +102,11 @@ namespace GLVM::ecs
 							 float backtrackingScale, float comparedScale);
 		bool RayCast(vec3 rayCasterPosition, vec3 receiverPosition,
 					 float rayCasterScale, float receiverScale);
+		/// Rigid bodies simulated and resting after the last Update().
+		unsigned int GetAwakeBodies() const { return awakeBodies_; }
+		unsigned int GetSleepingBodies() const { return sleepingBodies_; }
+		/// Touching pairs with normal, depth and age, and what began or ended in the last Update().
+		const CContactCache& GetContacts() const { return contactCache_; }
     };
 }
 	
@@ -11,18 +11,22 @@
 #include "ISystem.hpp"
 #include "ShaderProgram.hpp"
 #include "Constants.hpp"
+#include "StreamingBuffer.hpp"
 #include "VertexMath.hpp"
 #include <GL/gl.h>
+#include <memory>
 
 namespace GLVM::ecs
 {
     class CGUISystem : public ISystem
     {
-        GLuint iVbo_Crosshair_;
-		GLuint iVao_Crosshair_;
+		/// Made once, the crosshair vertices are streamed into it every frame.
+		GLuint iVao_Crosshair_ = 0;
+		std::unique_ptr<core::CStreamingBuffer> vertexStream_;
 
     public:
 		CGUISystem();
+		~CGUISystem();
         void Update() override;
 		void RaycastringDebug();
 
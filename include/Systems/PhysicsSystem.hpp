@@ -23,6 +23,7 @@ namespace GLVM::ecs
     public:
         float fAcceleration_of_Gravity_;
         float fDelta_Time_;
+		float sleepSpeed = 0.05f;          ///< Below this speed a supported body starts counting towards sleep.
 		float& gravity;
         core::CStack& Input_Stack_;
 
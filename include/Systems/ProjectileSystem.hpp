@@ -9,6 +9,7 @@
 #include "ISystem.hpp"
 #include "Vector.hpp"
 #include "ComponentManager.hpp"
+#include "DynamicAABBTree.hpp"
 #include "Globals.hpp"
 #include "TextureManager.hpp"
 #include "ComponentManager.hpp"
@@ -21,11 +22,20 @@
 #include "EntityManager.hpp"
 #include "EventsStack.hpp"
 #include "ISoundEngine.hpp"
+#include "Prefab.hpp"
 
 namespace GLVM::ecs
 {
     class CProjectileSystem : public ISystem
     {
+		core::CDynamicAABBTree     targetTree_;
+		core::vector<int>          targetProxies_;        ///< Proxy of each entity in targetTree_, indexed by entity, -1 if none.
+		core::vector<Entity>       trackedTargets_;
+		core::vector<core::Ray>    rays_;
+		core::vector<core::RaycastHit> hits_;
+
+		void UpdateTargets(ComponentManager* componentManager);
+
     public:
         float fYaw = -90.0f;
         float fPitch = 0.0f;
@@ -38,6 +48,7 @@ namespace GLVM::ecs
 		core::Sound::ISoundEngine* soundEngine;
         float                      projectileCooldown = 2.0f; 
 		float                      deltaFrameTime;
+		CPrefab*                   projectilePrefab_ = nullptr;
 
         CProjectileSystem(core::CStack& inputStack);
         void Update() override;
@@ -45,6 +56,9 @@ namespace GLVM::ecs
                                  unsigned int entityRefMove,
                                  components::beholder& beholder);
 
+        CPrefab* GetProjectilePrefab();
+		const core::CDynamicAABBTree& GetTargetTree() const { return targetTree_; }
+        Quaternion GetDirectionQuaternion();
         Vector<float, 3> GetDirectionVector(components::beholder& beholder);
     };
 }
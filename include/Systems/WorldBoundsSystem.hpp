@@ -0,0 +1,34 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef WORLD_BOUNDS_SYSTEM
+#define WORLD_BOUNDS_SYSTEM
+
+#include "ISystem.hpp"
+#include "Prefab.hpp"
+#include "Vector.hpp"
+
+namespace GLVM::ecs
+{
+	/*! Hands entities that fell out of the world back to the pool they came
+	 *  from, so they stop being simulated and drawn and the next Acquire()
+	 *  reuses them. Only pooled entities are watched, the rest of the world is
+	 *  left to its owner. */
+	class CWorldBoundsSystem : public ISystem
+	{
+		core::vector<CPrefabPool*> pools_;
+		unsigned int despawned_ = 0;
+
+	public:
+		float minHeight = -50.0f;      ///< Entities whose center goes below this are released.
+
+		void AddPool(CPrefabPool* pool) { pools_.Push(pool); }
+		void Update() override;
+		/// Entities released since the start.
+		unsigned int GetDespawned() const { return despawned_; }
+	};
+}
+
+#endif
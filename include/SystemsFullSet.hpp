@@ -12,5 +12,6 @@
 #include "Systems/GUISystem.hpp"
 #include "Systems/CollisionSystem.hpp"
 #include "Systems/MovementSystem.hpp"
+#include "Systems/WorldBoundsSystem.hpp"
 
 #endif
@@ -68,11 +68,13 @@ namespace GLVM::core
 		void Swap(T& firstElement, T& secondElement);
 		VectorIterator<T> Find(T& element);
 		void Resize(const unsigned int index);
+		void Reserve(const unsigned int newCapacity);
 		void Remove(unsigned int index);
 		void RemoveFirstItem();
 		T& GetFirstItem();
 		T& GetHead();
 		T* GetVectorContainer();
+		const T* GetVectorContainer() const;
 		[[nodiscard]] unsigned int GetSize() const;
 		int GetCapacity();
 		const T& operator[](const unsigned int _iIndex) const;
@@ -251,6 +253,27 @@ namespace GLVM::core
 		}
 	}
 	
+    /// Grow the storage once up front, so bulk pushes skip the step by step expansion.
+    
+	template<typename T>
+	void vector<T>::Reserve(const unsigned int newCapacity)
+	{
+		if ( newCapacity <= capacity )
+			return;
+
+		unsigned char* aTemp_Vector_Container_ = new unsigned char[newCapacity * sizeof(T)];
+
+		for(unsigned int j = 0; j < size; ++j) {
+			T& element = *(T*)&rowInnerData[j * sizeof(T)];
+			new (&aTemp_Vector_Container_[j * sizeof(T)]) T(element);
+			element.~T();
+		}
+
+		delete [] rowInnerData;
+		rowInnerData = aTemp_Vector_Container_;
+		capacity = newCapacity;
+	}
+	
  	template<class T>
 	void vector<T>::Remove(unsigned int index)
 	{
@@ -278,23 +301,16 @@ namespace GLVM::core
 	{
 		if(size < 1)
 			return;
-		
-		unsigned char* aTemp_Vector_Container = new unsigned char[size * sizeof(T)];
-		for(unsigned int i = 0; i < size; ++i) {
-			T& element = *(T*)&rowInnerData[i * sizeof(T)];
-			new (&aTemp_Vector_Container[i * sizeof(T)]) T(element);
-			element.~T();
-		}
-
-		delete [] this->rowInnerData;
-		this->rowInnerData = nullptr;
 
-		--size;				
-		rowInnerData = new unsigned char[size * sizeof(T)];
-        for(unsigned int i = 0; i < size; ++i) {
-			T& sourceElement = *(T*)&aTemp_Vector_Container[(i + 1) * sizeof(T)];
-			new (&rowInnerData[i * sizeof(T)]) T(sourceElement);
+		// Shift down in place, the storage keeps its capacity for the next Push.
+		for(unsigned int i = 1; i < size; ++i) {
+			T& element = *(T*)&rowInnerData[(i - 1) * sizeof(T)];
+			element = *(T*)&rowInnerData[i * sizeof(T)];
 		}
+
+		T& last = *(T*)&rowInnerData[(size - 1) * sizeof(T)];
+		last.~T();
+		--size;
 	}
 	
 	template<class T>
@@ -306,6 +322,9 @@ namespace GLVM::core
 	template<class T>
 	T* vector<T>::GetVectorContainer() { return (T*)rowInnerData; }
 
+	template<class T>
+	const T* vector<T>::GetVectorContainer() const { return (const T*)rowInnerData; }
+
 	template<typename T>
 	unsigned int vector<T>::GetSize() const { return size; }
 	
@@ -9,6 +9,7 @@
 #include <iostream>
 #include <cmath>
 #include <ostream>
+#include "FastMath.hpp"
 
 #define PI 3.14159265
 
@@ -910,4 +911,359 @@ Matrix<T, var> rotateQuaternion(Quaternion quaternion) {
 	return result;
 }
 
+///< Same layout as rotateQuaternion, for quaternions that are already unit length.
+inline mat4 unitQuaternionToMatrix(const Quaternion& quaternion) {
+	mat4 result(0.0f);
+
+	float xx = quaternion.x * quaternion.x;
+	float yy = quaternion.y * quaternion.y;
+	float zz = quaternion.z * quaternion.z;
+	float xy = quaternion.x * quaternion.y;
+	float xz = quaternion.x * quaternion.z;
+	float yz = quaternion.y * quaternion.z;
+	float wx = quaternion.w * quaternion.x;
+	float wy = quaternion.w * quaternion.y;
+	float wz = quaternion.w * quaternion.z;
+
+	result[0][0] = 1 - 2 * (yy + zz);
+	result[0][1] = 2 * (xy - wz);
+	result[0][2] = 2 * (xz + wy);
+
+	result[1][0] = 2 * (xy + wz);
+	result[1][1] = 1 - 2 * (xx + zz);
+	result[1][2] = 2 * (yz - wx);
+
+	result[2][0] = 2 * (xz - wy);
+	result[2][1] = 2 * (yz + wx);
+	result[2][2] = 1 - 2 * (xx + yy);
+
+	result[3][3] = 1.0f;
+
+	return result;
+}
+
+///< Rotation of _radians around a unit _axis.
+inline Quaternion axisAngleQuaternion(const vec3& _axis, float _radians) {
+	float fSin, fCos;
+	GLVM::core::math::sincos(_radians * 0.5f, fSin, fCos);
+
+	return Quaternion{ .w = fCos, .x = _axis[0] * fSin, .y = _axis[1] * fSin, .z = _axis[2] * fSin };
+}
+
+///< q * v * q^-1 for a unit quaternion, without building the two temporary products.
+inline vec3 rotateVector(const Quaternion& quaternion, const vec3& _vector) {
+	float tx = 2 * (quaternion.y * _vector[2] - quaternion.z * _vector[1]);
+	float ty = 2 * (quaternion.z * _vector[0] - quaternion.x * _vector[2]);
+	float tz = 2 * (quaternion.x * _vector[1] - quaternion.y * _vector[0]);
+
+	return vec3(_vector[0] + quaternion.w * tx + quaternion.y * tz - quaternion.z * ty,
+				_vector[1] + quaternion.w * ty + quaternion.z * tx - quaternion.x * tz,
+				_vector[2] + quaternion.w * tz + quaternion.x * ty - quaternion.y * tx);
+}
+
+inline float dotQuaternion(const Quaternion& a, const Quaternion& b) {
+	return a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+/*! Normalized linear interpolation along the shortest arc. Cheap and
+ *  commutative, but the angular speed is not constant over t. */
+inline Quaternion nlerp(const Quaternion& a, Quaternion b, float t) {
+	if (dotQuaternion(a, b) < 0.0f)
+		b = Quaternion{ .w = -b.w, .x = -b.x, .y = -b.y, .z = -b.z };
+
+	Quaternion result{ .w = a.w + (b.w - a.w) * t, .x = a.x + (b.x - a.x) * t,
+					   .y = a.y + (b.y - a.y) * t, .z = a.z + (b.z - a.z) * t };
+
+	return normalizeQuaternion(result);
+}
+
+/*! Spherical linear interpolation along the shortest arc with constant
+ *  angular speed. Falls back to nlerp when the inputs are nearly parallel. */
+inline Quaternion slerp(const Quaternion& a, Quaternion b, float t) {
+	float fCosTheta = dotQuaternion(a, b);
+	if (fCosTheta < 0.0f) {
+		b = Quaternion{ .w = -b.w, .x = -b.x, .y = -b.y, .z = -b.z };
+		fCosTheta = -fCosTheta;
+	}
+
+	if (fCosTheta > 0.9995f)
+		return nlerp(a, b, t);
+
+	float fTheta = std::acos(fCosTheta);
+	float fSinTheta = std::sqrt(1.0f - fCosTheta * fCosTheta);
+	float fWeightA = std::sin((1.0f - t) * fTheta) / fSinTheta;
+	float fWeightB = std::sin(t * fTheta) / fSinTheta;
+
+	return Quaternion{ .w = a.w * fWeightA + b.w * fWeightB, .x = a.x * fWeightA + b.x * fWeightB,
+					   .y = a.y * fWeightA + b.y * fWeightB, .z = a.z * fWeightA + b.z * fWeightB };
+}
+
+///< Plane as n.p + d = 0, the positive half-space is the inside.
+struct Plane
+{
+	vec3 normal{ 0.0f, 1.0f, 0.0f };
+	float d = 0.0f;
+};
+
+inline float SignedDistance(const Plane& _plane, const vec3& _point) {
+	return _plane.normal[0] * _point[0] + _plane.normal[1] * _point[1] + _plane.normal[2] * _point[2] + _plane.d;
+}
+
+struct AABB
+{
+	vec3 min{ 0.0f, 0.0f, 0.0f };
+	vec3 max{ 0.0f, 0.0f, 0.0f };
+};
+
+struct Sphere
+{
+	vec3 center{ 0.0f, 0.0f, 0.0f };
+	float radius = 0.0f;
+};
+
+inline AABB AABBFromCenter(const vec3& _center, float _halfExtent) {
+	return AABB{ .min = vec3(_center[0] - _halfExtent, _center[1] - _halfExtent, _center[2] - _halfExtent),
+				 .max = vec3(_center[0] + _halfExtent, _center[1] + _halfExtent, _center[2] + _halfExtent) };
+}
+
+inline vec3 Center(const AABB& _box) {
+	return vec3((_box.min[0] + _box.max[0]) * 0.5f, (_box.min[1] + _box.max[1]) * 0.5f, (_box.min[2] + _box.max[2]) * 0.5f);
+}
+
+inline vec3 Extents(const AABB& _box) {
+	return vec3((_box.max[0] - _box.min[0]) * 0.5f, (_box.max[1] - _box.min[1]) * 0.5f, (_box.max[2] - _box.min[2]) * 0.5f);
+}
+
+///< Strict overlap, boxes that only touch do not collide.
+inline bool Overlaps(const AABB& a, const AABB& b) {
+	return a.max[0] > b.min[0] && a.min[0] < b.max[0] &&
+		   a.max[1] > b.min[1] && a.min[1] < b.max[1] &&
+		   a.max[2] > b.min[2] && a.min[2] < b.max[2];
+}
+
+inline AABB Merge(const AABB& a, const AABB& b) {
+	return AABB{ .min = vec3(Min(a.min[0], b.min[0]), Min(a.min[1], b.min[1]), Min(a.min[2], b.min[2])),
+				 .max = vec3(Max(a.max[0], b.max[0]), Max(a.max[1], b.max[1]), Max(a.max[2], b.max[2])) };
+}
+
+inline Sphere BoundingSphere(const AABB& _box) {
+	vec3 extents = Extents(_box);
+	return Sphere{ .center = Center(_box), .radius = extents.Length() };
+}
+
+/*! World bounds of a local box under a row-vector model matrix
+ *  (translation in row 3), Arvo's method: every output axis takes the
+ *  smaller and larger product per input axis, no corners are transformed. */
+inline AABB TransformAABB(const AABB& _local, const mat4& _model) {
+	AABB result{ .min = vec3(_model[3][0], _model[3][1], _model[3][2]),
+				 .max = vec3(_model[3][0], _model[3][1], _model[3][2]) };
+
+	for (int row = 0; row < 3; ++row) {
+		for (int column = 0; column < 3; ++column) {
+			float a = _model[row][column] * _local.min[row];
+			float b = _model[row][column] * _local.max[row];
+			result.min[column] += Min(a, b);
+			result.max[column] += Max(a, b);
+		}
+	}
+
+	return result;
+}
+
+/*! Slab test for the segment _origin + t * _delta, t in [0, 1]. Returns the
+ *  entry parameter in _tEnter when the segment crosses the box. */
+inline bool IntersectSegmentAABB(const vec3& _origin, const vec3& _delta, const AABB& _box, float& _tEnter) {
+	float tMin = 0.0f;
+	float tMax = 1.0f;
+
+	for (int dimension = 0; dimension < 3; ++dimension) {
+		float inverse = 1.0f / _delta[dimension];
+		float t1 = (_box.min[dimension] - _origin[dimension]) * inverse;
+		float t2 = (_box.max[dimension] - _origin[dimension]) * inverse;
+
+		tMin = Max(tMin, Min(t1, t2));
+		tMax = Min(tMax, Max(t1, t2));
+
+		if (tMax < tMin)
+			return false;
+	}
+
+	_tEnter = tMin;
+	return tMax > tMin;
+}
+
+/*! Six planes with normals pointing inwards: left, right, bottom, top, near, far.
+ *  Built from the product the shaders see as projection * view, which in this
+ *  row-vector library is view * projection. Assumes the GL [-w, w] depth
+ *  range; with a [0, w] projection the near plane is merely conservative. */
+struct Frustum
+{
+	enum EPlane { eLEFT, eRIGHT, eBOTTOM, eTOP, eNEAR, eFAR, ePLANES_NUMBER };
+
+	Plane planes[ePLANES_NUMBER];
+
+	///< Gribb-Hartmann extraction, clip = v * M so the planes come from the columns.
+	static Frustum FromViewProjection(const mat4& _viewProjection) {
+		Frustum frustum;
+		const mat4& m = _viewProjection;
+
+		for (int axis = 0; axis < 3; ++axis) {
+			for (int side = 0; side < 2; ++side) {
+				float sign = side == 0 ? 1.0f : -1.0f;
+				Plane& plane = frustum.planes[axis * 2 + side];
+				plane.normal = vec3(m[0][3] + sign * m[0][axis], m[1][3] + sign * m[1][axis], m[2][3] + sign * m[2][axis]);
+				plane.d = m[3][3] + sign * m[3][axis];
+
+				// An infinite far plane degenerates to a zero normal, keep it as a plane that never culls.
+				float length = plane.normal.Length();
+				if (length < 1e-6f) {
+					plane = Plane{ .normal = vec3(0.0f, 0.0f, 0.0f), .d = 1.0f };
+					continue;
+				}
+
+				plane.normal = plane.normal * (1.0f / length);
+				plane.d /= length;
+			}
+		}
+
+		return frustum;
+	}
+
+	///< Conservative: boxes straddling a corner outside two planes still pass.
+	bool Intersects(const AABB& _box) const {
+		vec3 center = Center(_box);
+		vec3 extents = Extents(_box);
+
+		for (int i = 0; i < ePLANES_NUMBER; ++i) {
+			const vec3& n = planes[i].normal;
+			float radius = extents[0] * std::fabs(n[0]) + extents[1] * std::fabs(n[1]) + extents[2] * std::fabs(n[2]);
+			if (SignedDistance(planes[i], center) + radius < 0.0f)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool Intersects(const Sphere& _sphere) const {
+		for (int i = 0; i < ePLANES_NUMBER; ++i) {
+			if (SignedDistance(planes[i], _sphere.center) + _sphere.radius < 0.0f)
+				return false;
+		}
+
+		return true;
+	}
+};
+
+/*! Boxes in structure-of-arrays form (centers and half extents) for the
+ *  wide frustum tests below. */
+struct AABBStream
+{
+	const float* centerX;
+	const float* centerY;
+	const float* centerZ;
+	const float* extentX;
+	const float* extentY;
+	const float* extentZ;
+};
+
+///< Bit i of the result is set when box _first + i is inside or crossing the frustum.
+inline int CullAABB4(const Frustum& _frustum, const AABBStream& _boxes, unsigned int _first) {
+#ifdef GLVM_FAST_MATH_SSE2
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	__m128 cx = _mm_loadu_ps(_boxes.centerX + _first);
+	__m128 cy = _mm_loadu_ps(_boxes.centerY + _first);
+	__m128 cz = _mm_loadu_ps(_boxes.centerZ + _first);
+	__m128 ex = _mm_loadu_ps(_boxes.extentX + _first);
+	__m128 ey = _mm_loadu_ps(_boxes.extentY + _first);
+	__m128 ez = _mm_loadu_ps(_boxes.extentZ + _first);
+	__m128 outside = _mm_setzero_ps();
+
+	for (int i = 0; i < Frustum::ePLANES_NUMBER; ++i) {
+		const Plane& plane = _frustum.planes[i];
+		__m128 nx = _mm_set1_ps(plane.normal[0]);
+		__m128 ny = _mm_set1_ps(plane.normal[1]);
+		__m128 nz = _mm_set1_ps(plane.normal[2]);
+
+		__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+									 _mm_add_ps(_mm_mul_ps(nz, cz), _mm_set1_ps(plane.d)));
+		__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, absMask), ex),
+											  _mm_mul_ps(_mm_and_ps(ny, absMask), ey)),
+								   _mm_mul_ps(_mm_and_ps(nz, absMask), ez));
+		outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+	}
+
+	return ~_mm_movemask_ps(outside) & 0xf;
+#else
+	int mask = 0;
+	for (unsigned int lane = 0; lane < 4; ++lane) {
+		unsigned int i = _first + lane;
+		AABB box{ .min = vec3(_boxes.centerX[i] - _boxes.extentX[i], _boxes.centerY[i] - _boxes.extentY[i], _boxes.centerZ[i] - _boxes.extentZ[i]),
+				  .max = vec3(_boxes.centerX[i] + _boxes.extentX[i], _boxes.centerY[i] + _boxes.extentY[i], _boxes.centerZ[i] + _boxes.extentZ[i]) };
+		if (_frustum.Intersects(box))
+			mask |= 1 << lane;
+	}
+	return mask;
+#endif
+}
+
+///< Eight boxes per call with AVX2, two 4-wide calls otherwise.
+inline int CullAABB8(const Frustum& _frustum, const AABBStream& _boxes, unsigned int _first) {
+#ifdef GLVM_FAST_MATH_AVX2
+	const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	__m256 cx = _mm256_loadu_ps(_boxes.centerX + _first);
+	__m256 cy = _mm256_loadu_ps(_boxes.centerY + _first);
+	__m256 cz = _mm256_loadu_ps(_boxes.centerZ + _first);
+	__m256 ex = _mm256_loadu_ps(_boxes.extentX + _first);
+	__m256 ey = _mm256_loadu_ps(_boxes.extentY + _first);
+	__m256 ez = _mm256_loadu_ps(_boxes.extentZ + _first);
+	__m256 outside = _mm256_setzero_ps();
+
+	for (int i = 0; i < Frustum::ePLANES_NUMBER; ++i) {
+		const Plane& plane = _frustum.planes[i];
+		__m256 nx = _mm256_set1_ps(plane.normal[0]);
+		__m256 ny = _mm256_set1_ps(plane.normal[1]);
+		__m256 nz = _mm256_set1_ps(plane.normal[2]);
+
+		__m256 distance = _mm256_fmadd_ps(nx, cx, _mm256_fmadd_ps(ny, cy, _mm256_fmadd_ps(nz, cz, _mm256_set1_ps(plane.d))));
+		__m256 radius = _mm256_fmadd_ps(_mm256_and_ps(nx, absMask), ex,
+										_mm256_fmadd_ps(_mm256_and_ps(ny, absMask), ey,
+														_mm256_mul_ps(_mm256_and_ps(nz, absMask), ez)));
+		outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_LT_OQ));
+	}
+
+	return ~_mm256_movemask_ps(outside) & 0xff;
+#else
+	return CullAABB4(_frustum, _boxes, _first) | (CullAABB4(_frustum, _boxes, _first + 4) << 4);
+#endif
+}
+
+/*! Culls _count boxes, writing 1 for visible and 0 for culled into _visible.
+ *  The tail that does not fill a full batch goes through the scalar test. */
+inline void CullAABBs(const Frustum& _frustum, const AABBStream& _boxes, unsigned int _count, unsigned char* _visible) {
+	unsigned int i = 0;
+	for (; i + 8 <= _count; i += 8) {
+		int mask = CullAABB8(_frustum, _boxes, i);
+		for (unsigned int lane = 0; lane < 8; ++lane)
+			_visible[i + lane] = (mask >> lane) & 1;
+	}
+
+	for (; i < _count; ++i) {
+		AABB box{ .min = vec3(_boxes.centerX[i] - _boxes.extentX[i], _boxes.centerY[i] - _boxes.extentY[i], _boxes.centerZ[i] - _boxes.extentZ[i]),
+				  .max = vec3(_boxes.centerX[i] + _boxes.extentX[i], _boxes.centerY[i] + _boxes.extentY[i], _boxes.centerZ[i] + _boxes.extentZ[i]) };
+		_visible[i] = _frustum.Intersects(box) ? 1 : 0;
+	}
+}
+
+/*! Same output against a sphere, for point light ranges. The box to center
+ *  distance is taken per axis, a plain loop the compiler vectorizes. */
+inline void CullAABBs(const Sphere& _sphere, const AABBStream& _boxes, unsigned int _count, unsigned char* _visible) {
+	float radiusSquared = _sphere.radius * _sphere.radius;
+	for (unsigned int i = 0; i < _count; ++i) {
+		float dx = Max(std::fabs(_boxes.centerX[i] - _sphere.center[0]) - _boxes.extentX[i], 0.0f);
+		float dy = Max(std::fabs(_boxes.centerY[i] - _sphere.center[1]) - _boxes.extentY[i], 0.0f);
+		float dz = Max(std::fabs(_boxes.centerZ[i] - _sphere.center[2]) - _boxes.extentZ[i], 0.0f);
+		_visible[i] = dx * dx + dy * dy + dz * dz <= radiusSquared ? 1 : 0;
+	}
+}
+
 #endif
@@ -0,0 +1,274 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "Broadphase.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace GLVM::core
+{
+	namespace
+	{
+		constexpr int kCellBits = 21;                           ///< Bits per axis in a packed cell key.
+		constexpr int kCellLimit = 1 << (kCellBits - 1);        ///< Coordinates are clamped to [-kCellLimit, kCellLimit).
+	}
+
+	int CSpatialHash::CellCoordinate(float value) const {
+		float cell = std::floor(value * inverseCellSize_);
+		if ( !(cell >= static_cast<float>(-kCellLimit)) )
+			return -kCellLimit;
+		if ( cell > static_cast<float>(kCellLimit - 1) )
+			return kCellLimit - 1;
+		return static_cast<int>(cell);
+	}
+
+	uint64_t CSpatialHash::CellKey(int x, int y, int z) const {
+		const uint64_t mask = (uint64_t(1) << kCellBits) - 1;
+		return (uint64_t(x + kCellLimit) & mask) << (kCellBits * 2) |
+			   (uint64_t(y + kCellLimit) & mask) << kCellBits |
+			   (uint64_t(z + kCellLimit) & mask);
+	}
+
+	void CSpatialHash::Build(const AABB* boxes, unsigned int count) {
+		boxes_ = boxes;
+		entries_.Resize(0);
+		oversized_.Resize(0);
+		oversizedFlags_.Resize(0);
+		oversizedFlags_.Resize(count);
+		regularByMinX_.Resize(0);
+		regularMaxWidthX_ = 0.0f;
+
+		if ( count == 0 )
+			return;
+
+		float extentSum = 0.0f;
+		for ( unsigned int i = 0; i < count; ++i ) {
+			vec3 extents = Extents(boxes[i]);
+			extentSum += Max(extents[0], Max(extents[1], extents[2]));
+		}
+
+		cellSize_ = Max(2.0f * extentSum / static_cast<float>(count), 1e-3f);
+		inverseCellSize_ = 1.0f / cellSize_;
+
+		entries_.Reserve(count * 8);
+		for ( unsigned int i = 0; i < count; ++i ) {
+			const AABB& box = boxes[i];
+			int minX = CellCoordinate(box.min[0]), maxX = CellCoordinate(box.max[0]);
+			int minY = CellCoordinate(box.min[1]), maxY = CellCoordinate(box.max[1]);
+			int minZ = CellCoordinate(box.min[2]), maxZ = CellCoordinate(box.max[2]);
+
+			uint64_t cells = uint64_t(maxX - minX + 1) * uint64_t(maxY - minY + 1) * uint64_t(maxZ - minZ + 1);
+			if ( cells > kMaxCellsPerBox ) {
+				oversized_.Push(i);
+				oversizedFlags_[i] = 1;
+				continue;
+			}
+
+			if ( box.max[0] - box.min[0] > regularMaxWidthX_ )
+				regularMaxWidthX_ = box.max[0] - box.min[0];
+
+			for ( int x = minX; x <= maxX; ++x )
+				for ( int y = minY; y <= maxY; ++y )
+					for ( int z = minZ; z <= maxZ; ++z )
+						PushGrowing(entries_, CellEntry{ CellKey(x, y, z), i });
+		}
+
+		CellEntry* entries = entries_.GetVectorContainer();
+		std::sort(entries, entries + entries_.GetSize(), [](const CellEntry& a, const CellEntry& b) {
+			return a.key < b.key || (a.key == b.key && a.index < b.index);
+		});
+
+		if ( oversized_.GetSize() == 0 )
+			return;
+
+		regularByMinX_.Reserve(count - oversized_.GetSize());
+		for ( unsigned int i = 0; i < count; ++i ) {
+			if ( !oversizedFlags_[i] )
+				regularByMinX_.Push(AxisEntry{ boxes[i].min[0], i });
+		}
+
+		AxisEntry* axis = regularByMinX_.GetVectorContainer();
+		std::sort(axis, axis + regularByMinX_.GetSize(), [](const AxisEntry& a, const AxisEntry& b) {
+			return a.min < b.min;
+		});
+	}
+
+	void CSpatialHash::CollectPairs(core::vector<BroadphasePair>& pairs) {
+		unsigned int entriesNumber = entries_.GetSize();
+		unsigned int runBegin = 0;
+		while ( runBegin < entriesNumber ) {
+			uint64_t key = entries_[runBegin].key;
+			unsigned int runEnd = runBegin + 1;
+			while ( runEnd < entriesNumber && entries_[runEnd].key == key )
+				++runEnd;
+
+			for ( unsigned int a = runBegin; a < runEnd; ++a ) {
+				for ( unsigned int b = a + 1; b < runEnd; ++b ) {
+					const AABB& first = boxes_[entries_[a].index];
+					const AABB& second = boxes_[entries_[b].index];
+					if ( !Overlaps(first, second) )
+						continue;
+
+					// Boxes sharing several cells are reported only from the cell holding the
+					// minimum corner of their intersection.
+					uint64_t ownerKey = CellKey(CellCoordinate(Max(first.min[0], second.min[0])),
+												CellCoordinate(Max(first.min[1], second.min[1])),
+												CellCoordinate(Max(first.min[2], second.min[2])));
+					if ( ownerKey == key )
+						PushGrowing(pairs, BroadphasePair{ entries_[a].index, entries_[b].index });
+				}
+			}
+
+			runBegin = runEnd;
+		}
+
+		const AxisEntry* axisBegin = regularByMinX_.GetVectorContainer();
+		const AxisEntry* axisEnd = axisBegin + regularByMinX_.GetSize();
+		for ( unsigned int i = 0; i < oversized_.GetSize(); ++i ) {
+			unsigned int large = oversized_[i];
+			const AABB& largeBox = boxes_[large];
+
+			for ( unsigned int j = i + 1; j < oversized_.GetSize(); ++j ) {
+				if ( Overlaps(largeBox, boxes_[oversized_[j]]) )
+					PushGrowing(pairs, BroadphasePair{ std::min(large, oversized_[j]), std::max(large, oversized_[j]) });
+			}
+
+			// A regular box can only reach back regularMaxWidthX_ from its min x.
+			float firstMin = largeBox.min[0] - regularMaxWidthX_;
+			const AxisEntry* entry = std::lower_bound(axisBegin, axisEnd, firstMin, [](const AxisEntry& a, float value) {
+				return a.min < value;
+			});
+			for ( ; entry != axisEnd && entry->min < largeBox.max[0]; ++entry ) {
+				if ( Overlaps(largeBox, boxes_[entry->index]) )
+					PushGrowing(pairs, BroadphasePair{ std::min(large, entry->index), std::max(large, entry->index) });
+			}
+		}
+	}
+
+	bool CSweepAndPrune::ChooseAxis(const AABB* boxes, unsigned int count) {
+		if ( count < 2 )
+			return false;
+
+		float sum[3] = { 0.0f, 0.0f, 0.0f };
+		float squaresSum[3] = { 0.0f, 0.0f, 0.0f };
+		for ( unsigned int i = 0; i < count; ++i ) {
+			for ( int axis = 0; axis < 3; ++axis ) {
+				float center = (boxes[i].min[axis] + boxes[i].max[axis]) * 0.5f;
+				sum[axis] += center;
+				squaresSum[axis] += center * center;
+			}
+		}
+
+		float variance[3];
+		for ( int axis = 0; axis < 3; ++axis )
+			variance[axis] = squaresSum[axis] - sum[axis] * sum[axis] / static_cast<float>(count);
+
+		int best = axis_;
+		for ( int axis = 0; axis < 3; ++axis ) {
+			if ( variance[axis] > variance[best] )
+				best = axis;
+		}
+
+		if ( best == axis_ || variance[best] <= 1.5f * variance[axis_] )
+			return false;
+
+		axis_ = best;
+		return true;
+	}
+
+	void CSweepAndPrune::Update(const unsigned int* ids, const AABB* boxes, unsigned int count) {
+		boxes_ = boxes;
+		bool axisChanged = ChooseAxis(boxes, count);
+
+		unsigned int maxId = 0;
+		for ( unsigned int i = 0; i < count; ++i ) {
+			if ( ids[i] > maxId )
+				maxId = ids[i];
+		}
+
+		if ( count > 0 && maxId >= indexOfId_.GetSize() ) {
+			unsigned int oldSize = indexOfId_.GetSize();
+			indexOfId_.Resize(maxId + 1);
+			for ( unsigned int i = oldSize; i <= maxId; ++i )
+				indexOfId_[i] = kInvalidIndex;
+		}
+
+		for ( unsigned int i = 0; i < count; ++i )
+			indexOfId_[ids[i]] = i;
+
+		// Keep the surviving endpoints in their old order, the ids are marked as seen
+		// by invalidating them, whatever stays valid afterwards is new.
+		unsigned int kept = 0;
+		for ( unsigned int i = 0; i < endpoints_.GetSize(); ++i ) {
+			Endpoint endpoint = endpoints_[i];
+			if ( endpoint.id >= indexOfId_.GetSize() || indexOfId_[endpoint.id] == kInvalidIndex )
+				continue;
+
+			endpoint.index = indexOfId_[endpoint.id];
+			endpoint.min = boxes[endpoint.index].min[axis_];
+			endpoint.max = boxes[endpoint.index].max[axis_];
+			indexOfId_[endpoint.id] = kInvalidIndex;
+			endpoints_[kept++] = endpoint;
+		}
+
+		endpoints_.Resize(kept);
+		for ( unsigned int i = 0; i < count; ++i ) {
+			if ( indexOfId_[ids[i]] == kInvalidIndex )
+				continue;
+
+			PushGrowing(endpoints_, Endpoint{ boxes[i].min[axis_], boxes[i].max[axis_], ids[i], i });
+			indexOfId_[ids[i]] = kInvalidIndex;
+		}
+
+		insertionShifts_ = 0;
+		Endpoint* endpoints = endpoints_.GetVectorContainer();
+		auto lessMin = [](const Endpoint& a, const Endpoint& b) { return a.min < b.min; };
+		if ( axisChanged ) {
+			// The kept order is the one of the old axis, as good as random on the new one.
+			std::sort(endpoints, endpoints + endpoints_.GetSize(), lessMin);
+			return;
+		}
+
+		// Survivors are nearly sorted already; the new ones are sorted apart and merged in.
+		for ( unsigned int i = 1; i < kept; ++i ) {
+			Endpoint endpoint = endpoints[i];
+			unsigned int j = i;
+			while ( j > 0 && endpoints[j - 1].min > endpoint.min ) {
+				endpoints[j] = endpoints[j - 1];
+				--j;
+			}
+
+			insertionShifts_ += i - j;
+			endpoints[j] = endpoint;
+		}
+
+		if ( endpoints_.GetSize() > kept ) {
+			std::sort(endpoints + kept, endpoints + endpoints_.GetSize(), lessMin);
+			std::inplace_merge(endpoints, endpoints + kept, endpoints + endpoints_.GetSize(), lessMin);
+		}
+	}
+
+	void CSweepAndPrune::CollectPairs(core::vector<BroadphasePair>& pairs) {
+		const Endpoint* endpoints = endpoints_.GetVectorContainer();
+		unsigned int endpointsNumber = endpoints_.GetSize();
+		sortedBounds_.Resize(endpointsNumber);
+		for ( unsigned int i = 0; i < endpointsNumber; ++i )
+			sortedBounds_.Set(i, boxes_[endpoints[i].index]);
+
+		// A block may run past the first box starting beyond current.max; those lanes
+		// fail the sweep axis test, so only the loop bound needs the sorted order.
+		for ( unsigned int i = 0; i < endpointsNumber; ++i ) {
+			const Endpoint& current = endpoints[i];
+			const AABB& box = boxes_[current.index];
+			for ( unsigned int j = i + 1; j < endpointsNumber && endpoints[j].min < current.max; j += CBoundsSoA::kLanes ) {
+				for ( unsigned int mask = OverlapMask8(box, sortedBounds_, j); mask != 0; mask &= mask - 1 ) {
+					unsigned int other = endpoints[j + std::countr_zero(mask)].index;
+					PushGrowing(pairs, BroadphasePair{ std::min(current.index, other), std::max(current.index, other) });
+				}
+			}
+		}
+	}
+}
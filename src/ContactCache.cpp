@@ -0,0 +1,80 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "ContactCache.hpp"
+#include "Broadphase.hpp"
+#include <algorithm>
+
+namespace GLVM::ecs
+{
+	void CContactCache::Begin() {
+		incoming_.Resize(0);
+		events_.Resize(0);
+	}
+
+	void CContactCache::Add(Entity a, Entity b, const vec3& normal, float depth) {
+		if ( a < b )
+			core::PushGrowing(incoming_, ContactManifold{ a, b, normal, depth, 0 });
+		else
+			core::PushGrowing(incoming_, ContactManifold{ b, a, vec3(-normal[0], -normal[1], -normal[2]), depth, 0 });
+	}
+
+	void CContactCache::End(const core::vector<unsigned char>& resting) {
+		ContactManifold* incoming = incoming_.GetVectorContainer();
+		std::sort(incoming, incoming + incoming_.GetSize(), [](const ContactManifold& a, const ContactManifold& b) {
+			return Key(a) < Key(b);
+		});
+
+		auto isResting = [&resting](Entity entity) {
+			return entity < resting.GetSize() && resting[entity] != 0;
+		};
+
+		// Both lists are sorted, one merge pass classifies every pair.
+		merged_.Resize(0);
+		unsigned int oldIndex = 0;
+		unsigned int newIndex = 0;
+		while ( oldIndex < manifolds_.GetSize() || newIndex < incoming_.GetSize() ) {
+			bool hasOld = oldIndex < manifolds_.GetSize();
+			bool hasNew = newIndex < incoming_.GetSize();
+			uint64_t oldKey = hasOld ? Key(manifolds_[oldIndex]) : UINT64_MAX;
+			uint64_t newKey = hasNew ? Key(incoming_[newIndex]) : UINT64_MAX;
+
+			if ( hasNew && newKey == oldKey ) {
+				ContactManifold manifold = incoming_[newIndex++];
+				manifold.age = manifolds_[oldIndex++].age + 1;
+				core::PushGrowing(merged_, manifold);
+				core::PushGrowing(events_, ContactEvent{ eCONTACT_PERSIST, manifold.first, manifold.second });
+			} else if ( hasNew && newKey < oldKey ) {
+				ContactManifold manifold = incoming_[newIndex++];
+				core::PushGrowing(merged_, manifold);
+				core::PushGrowing(events_, ContactEvent{ eCONTACT_BEGIN, manifold.first, manifold.second });
+			} else {
+				ContactManifold manifold = manifolds_[oldIndex++];
+				if ( isResting(manifold.first) && isResting(manifold.second) ) {
+					++manifold.age;
+					core::PushGrowing(merged_, manifold);
+					core::PushGrowing(events_, ContactEvent{ eCONTACT_PERSIST, manifold.first, manifold.second });
+				} else {
+					core::PushGrowing(events_, ContactEvent{ eCONTACT_END, manifold.first, manifold.second });
+				}
+			}
+		}
+
+		// operator= reallocates on every call, copying into the kept storage does not.
+		manifolds_.Resize(merged_.GetSize());
+		for ( unsigned int i = 0; i < merged_.GetSize(); ++i )
+			manifolds_[i] = merged_[i];
+	}
+
+	const ContactManifold* CContactCache::Find(Entity a, Entity b) const {
+		uint64_t key = a < b ? Key(a, b) : Key(b, a);
+		const ContactManifold* begin = manifolds_.GetVectorContainer();
+		const ContactManifold* end = begin + manifolds_.GetSize();
+		const ContactManifold* found = std::lower_bound(begin, end, key, [](const ContactManifold& manifold, uint64_t value) {
+			return Key(manifold) < value;
+		});
+		return found != end && Key(*found) == key ? found : nullptr;
+	}
+}
@@ -0,0 +1,375 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "DynamicAABBTree.hpp"
+#include "Broadphase.hpp"
+#include <algorithm>
+
+namespace GLVM::core
+{
+	namespace
+	{
+		float SurfaceArea(const AABB& box) {
+			float x = box.max[0] - box.min[0];
+			float y = box.max[1] - box.min[1];
+			float z = box.max[2] - box.min[2];
+			return 2.0f * (x * y + y * z + z * x);
+		}
+
+		AABB Fatten(const AABB& box, float margin) {
+			return AABB{ .min = vec3(box.min[0] - margin, box.min[1] - margin, box.min[2] - margin),
+						 .max = vec3(box.max[0] + margin, box.max[1] + margin, box.max[2] + margin) };
+		}
+
+		bool Contains(const AABB& outer, const AABB& inner) {
+			return outer.min[0] <= inner.min[0] && outer.min[1] <= inner.min[1] && outer.min[2] <= inner.min[2] &&
+				   inner.max[0] <= outer.max[0] && inner.max[1] <= outer.max[1] && inner.max[2] <= outer.max[2];
+		}
+	}
+
+	int CDynamicAABBTree::AllocateNode() {
+		int node;
+		if ( freeList_ != kNullNode ) {
+			node = freeList_;
+			freeList_ = nodes_[node].parent;
+		} else {
+			PushGrowing(nodes_, Node{});
+			node = static_cast<int>(nodes_.GetSize()) - 1;
+		}
+
+		nodes_[node].parent = kNullNode;
+		nodes_[node].left = kNullNode;
+		nodes_[node].right = kNullNode;
+		nodes_[node].height = 0;
+		nodes_[node].userData = 0;
+		return node;
+	}
+
+	void CDynamicAABBTree::FreeNode(int node) {
+		nodes_[node].parent = freeList_;
+		nodes_[node].height = -1;
+		freeList_ = node;
+	}
+
+	int CDynamicAABBTree::CreateProxy(const AABB& bounds, unsigned int userData) {
+		int proxy = AllocateNode();
+		Node& node = nodes_[proxy];
+		node.bounds = bounds;
+		node.fat = Fatten(bounds, margin_);
+		node.userData = userData;
+		InsertLeaf(proxy);
+		++proxiesNumber_;
+		return proxy;
+	}
+
+	void CDynamicAABBTree::DestroyProxy(int proxy) {
+		assert( IsLeaf(proxy) );
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		--proxiesNumber_;
+	}
+
+	bool CDynamicAABBTree::MoveProxy(int proxy, const AABB& bounds) {
+		assert( IsLeaf(proxy) );
+		nodes_[proxy].bounds = bounds;
+		if ( Contains(nodes_[proxy].fat, bounds) )
+			return false;
+
+		RemoveLeaf(proxy);
+		nodes_[proxy].fat = Fatten(bounds, margin_);
+		InsertLeaf(proxy);
+		return true;
+	}
+
+	void CDynamicAABBTree::InsertLeaf(int leaf) {
+		if ( root_ == kNullNode ) {
+			root_ = leaf;
+			nodes_[leaf].parent = kNullNode;
+			return;
+		}
+
+		// Descend towards the sibling whose merge adds the least surface area.
+		AABB leafBox = nodes_[leaf].fat;
+		int index = root_;
+		while ( !IsLeaf(index) ) {
+			const Node& node = nodes_[index];
+			float area = SurfaceArea(node.fat);
+			float combinedArea = SurfaceArea(Merge(node.fat, leafBox));
+			float cost = 2.0f * combinedArea;
+			float inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto descendCost = [&](int child) {
+				float mergedArea = SurfaceArea(Merge(leafBox, nodes_[child].fat));
+				if ( IsLeaf(child) )
+					return mergedArea + inheritanceCost;
+				return mergedArea - SurfaceArea(nodes_[child].fat) + inheritanceCost;
+			};
+
+			float leftCost = descendCost(node.left);
+			float rightCost = descendCost(node.right);
+			if ( cost < leftCost && cost < rightCost )
+				break;
+
+			index = leftCost < rightCost ? node.left : node.right;
+		}
+
+		int sibling = index;
+		int oldParent = nodes_[sibling].parent;
+		int newParent = AllocateNode();
+		nodes_[newParent].parent = oldParent;
+		nodes_[newParent].fat = Merge(leafBox, nodes_[sibling].fat);
+		nodes_[newParent].height = nodes_[sibling].height + 1;
+		nodes_[newParent].left = sibling;
+		nodes_[newParent].right = leaf;
+		nodes_[sibling].parent = newParent;
+		nodes_[leaf].parent = newParent;
+
+		if ( oldParent != kNullNode ) {
+			if ( nodes_[oldParent].left == sibling )
+				nodes_[oldParent].left = newParent;
+			else
+				nodes_[oldParent].right = newParent;
+		} else {
+			root_ = newParent;
+		}
+
+		RefitAncestors(nodes_[leaf].parent);
+	}
+
+	void CDynamicAABBTree::RemoveLeaf(int leaf) {
+		if ( leaf == root_ ) {
+			root_ = kNullNode;
+			return;
+		}
+
+		int parent = nodes_[leaf].parent;
+		int grandParent = nodes_[parent].parent;
+		int sibling = nodes_[parent].left == leaf ? nodes_[parent].right : nodes_[parent].left;
+
+		if ( grandParent != kNullNode ) {
+			if ( nodes_[grandParent].left == parent )
+				nodes_[grandParent].left = sibling;
+			else
+				nodes_[grandParent].right = sibling;
+			nodes_[sibling].parent = grandParent;
+			FreeNode(parent);
+			RefitAncestors(grandParent);
+		} else {
+			root_ = sibling;
+			nodes_[sibling].parent = kNullNode;
+			FreeNode(parent);
+		}
+	}
+
+	void CDynamicAABBTree::RefitAncestors(int node) {
+		while ( node != kNullNode ) {
+			node = Balance(node);
+
+			int left = nodes_[node].left;
+			int right = nodes_[node].right;
+			nodes_[node].height = 1 + std::max(nodes_[left].height, nodes_[right].height);
+			nodes_[node].fat = Merge(nodes_[left].fat, nodes_[right].fat);
+
+			node = nodes_[node].parent;
+		}
+	}
+
+	int CDynamicAABBTree::Balance(int indexA) {
+		Node& a = nodes_[indexA];
+		if ( IsLeaf(indexA) || a.height < 2 )
+			return indexA;
+
+		int indexB = a.left;
+		int indexC = a.right;
+		Node& b = nodes_[indexB];
+		Node& c = nodes_[indexC];
+		int balance = c.height - b.height;
+
+		// Rotate the taller child up, its taller grandchild stays under it.
+		if ( balance > 1 ) {
+			int indexF = c.left;
+			int indexG = c.right;
+			Node& f = nodes_[indexF];
+			Node& g = nodes_[indexG];
+
+			c.left = indexA;
+			c.parent = a.parent;
+			a.parent = indexC;
+			if ( c.parent != kNullNode ) {
+				if ( nodes_[c.parent].left == indexA )
+					nodes_[c.parent].left = indexC;
+				else
+					nodes_[c.parent].right = indexC;
+			} else {
+				root_ = indexC;
+			}
+
+			if ( f.height > g.height ) {
+				c.right = indexF;
+				a.right = indexG;
+				g.parent = indexA;
+				a.fat = Merge(b.fat, g.fat);
+				c.fat = Merge(a.fat, f.fat);
+				a.height = 1 + std::max(b.height, g.height);
+				c.height = 1 + std::max(a.height, f.height);
+			} else {
+				c.right = indexG;
+				a.right = indexF;
+				f.parent = indexA;
+				a.fat = Merge(b.fat, f.fat);
+				c.fat = Merge(a.fat, g.fat);
+				a.height = 1 + std::max(b.height, f.height);
+				c.height = 1 + std::max(a.height, g.height);
+			}
+
+			return indexC;
+		}
+
+		if ( balance < -1 ) {
+			int indexD = b.left;
+			int indexE = b.right;
+			Node& d = nodes_[indexD];
+			Node& e = nodes_[indexE];
+
+			b.left = indexA;
+			b.parent = a.parent;
+			a.parent = indexB;
+			if ( b.parent != kNullNode ) {
+				if ( nodes_[b.parent].left == indexA )
+					nodes_[b.parent].left = indexB;
+				else
+					nodes_[b.parent].right = indexB;
+			} else {
+				root_ = indexB;
+			}
+
+			if ( d.height > e.height ) {
+				b.right = indexD;
+				a.left = indexE;
+				e.parent = indexA;
+				a.fat = Merge(c.fat, e.fat);
+				b.fat = Merge(a.fat, d.fat);
+				a.height = 1 + std::max(c.height, e.height);
+				b.height = 1 + std::max(a.height, d.height);
+			} else {
+				b.right = indexE;
+				a.left = indexD;
+				d.parent = indexA;
+				a.fat = Merge(c.fat, d.fat);
+				b.fat = Merge(a.fat, e.fat);
+				a.height = 1 + std::max(c.height, d.height);
+				b.height = 1 + std::max(a.height, e.height);
+			}
+
+			return indexB;
+		}
+
+		return indexA;
+	}
+
+	void CDynamicAABBTree::QueryAABB(const AABB& box, core::vector<int>& proxies) const {
+		if ( root_ == kNullNode )
+			return;
+
+		int stack[kStackSize];
+		int stackSize = 0;
+		stack[stackSize++] = root_;
+		while ( stackSize > 0 ) {
+			int index = stack[--stackSize];
+			const Node& node = nodes_[index];
+			if ( !Overlaps(node.fat, box) )
+				continue;
+
+			if ( IsLeaf(index) ) {
+				if ( Overlaps(node.bounds, box) )
+					PushGrowing(proxies, index);
+				continue;
+			}
+
+			assert( stackSize + 2 <= kStackSize );
+			stack[stackSize++] = node.left;
+			stack[stackSize++] = node.right;
+		}
+	}
+
+	void CDynamicAABBTree::RaycastBatch(const Ray* rays, unsigned int count, RaycastHit* hits) const {
+		int stack[kStackSize];
+		for ( unsigned int i = 0; i < count; ++i ) {
+			const Ray& ray = rays[i];
+			RaycastHit hit;
+			if ( root_ == kNullNode ) {
+				hits[i] = hit;
+				continue;
+			}
+
+			int stackSize = 0;
+			stack[stackSize++] = root_;
+			while ( stackSize > 0 ) {
+				int index = stack[--stackSize];
+				const Node& node = nodes_[index];
+				float tEnter;
+
+				// Subtrees entered after the closest hit so far cannot improve it.
+				if ( !IntersectSegmentAABB(ray.origin, ray.delta, node.fat, tEnter) || tEnter > hit.t )
+					continue;
+
+				if ( IsLeaf(index) ) {
+					if ( IntersectSegmentAABB(ray.origin, ray.delta, node.bounds, tEnter) &&
+						 (hit.proxy == kNullNode || tEnter < hit.t) ) {
+						hit.proxy = index;
+						hit.t = tEnter;
+						hit.userData = node.userData;
+					}
+					continue;
+				}
+
+				assert( stackSize + 2 <= kStackSize );
+				stack[stackSize++] = node.left;
+				stack[stackSize++] = node.right;
+			}
+
+			hits[i] = hit;
+		}
+	}
+
+	bool CDynamicAABBTree::Validate() const {
+		if ( root_ == kNullNode )
+			return proxiesNumber_ == 0;
+
+		if ( nodes_[root_].parent != kNullNode )
+			return false;
+
+		int leaves = 0;
+		int stack[kStackSize];
+		int stackSize = 0;
+		stack[stackSize++] = root_;
+		while ( stackSize > 0 ) {
+			int index = stack[--stackSize];
+			const Node& node = nodes_[index];
+			if ( IsLeaf(index) ) {
+				if ( node.right != kNullNode || node.height != 0 || !Contains(node.fat, node.bounds) )
+					return false;
+				++leaves;
+				continue;
+			}
+
+			const Node& left = nodes_[node.left];
+			const Node& right = nodes_[node.right];
+			if ( left.parent != index || right.parent != index )
+				return false;
+			if ( node.height != 1 + std::max(left.height, right.height) )
+				return false;
+			if ( !Contains(node.fat, left.fat) || !Contains(node.fat, right.fat) )
+				return false;
+			if ( stackSize + 2 > kStackSize )
+				return false;
+
+			stack[stackSize++] = node.left;
+			stack[stackSize++] = node.right;
+		}
+
+		return leaves == proxiesNumber_;
+	}
+}
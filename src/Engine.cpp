@@ -18,6 +18,7 @@
 #include "Systems/MovementSystem.hpp"
 #include "Systems/PhysicsSystem.hpp"
 #include "Systems/ProjectileSystem.hpp"
+#include "Systems/WorldBoundsSystem.hpp"
 #include "Texture.hpp"
 #include <cstdint>
 #include <limits>
@@ -71,6 +72,7 @@ namespace GLVM::core
 		movementSystem           = new ecs::CMovementSystem(Input_Stack_);
 		physicsSystem            = new ecs::CPhysicsSystem(gravity, Input_Stack_);
 		projectileSystem         = new ecs::CProjectileSystem(Input_Stack_);
+		worldBoundsSystem        = new ecs::CWorldBoundsSystem();
         
 		deltaFrameTime             = 0.0;
 		g_eEvent.SetEvent(eDEFAULT);
@@ -82,6 +84,7 @@ namespace GLVM::core
 		pSystem_Manager->ActivateSystem(projectileSystem);
 		pSystem_Manager->ActivateSystem(collisionSystem);
 		pSystem_Manager->ActivateSystem(physicsSystem);
+		pSystem_Manager->ActivateSystem(worldBoundsSystem);
 
 		std::thread sound_thread(PlaybackSound, std::ref(soundEngine));
 		sound_thread.detach();
@@ -111,7 +114,6 @@ namespace GLVM::core
 	}
 	
 	void Engine::RenderOpengl() {
-		ecs::CSystemManager* pSystem_Manager = ecs::CSystemManager::GetInstance();
 		bool bGame_Loop_Active = true;
 
 		projectileSystem->textureHandlers = textureHandlers;
@@ -122,6 +124,7 @@ namespace GLVM::core
 		openglRenderer->pathsGLTF_             = pathsGLTF_;
 		openglRenderer->run();
 		openglRenderer->Window.Input_Stack_    = &Input_Stack_;
+		activeRenderer_ = openglRenderer;
 		
 #ifdef __linux__
 		// XEvent uXEvent;
@@ -146,7 +149,6 @@ namespace GLVM::core
 		while(bGame_Loop_Active) {
 			deltaFrameTime = chrono->GetElapsed();
 			chrono->Reset();
-		    gravity += deltaFrameTime;
 
 			openglRenderer->Window.ClearDisplay();
              
@@ -162,26 +164,21 @@ namespace GLVM::core
 								  &g_eEvent.mousePointerPosition.offset_X,
 								  &g_eEvent.mousePointerPosition.offset_Y);
 
-			movementSystem->deltaFrameTime            = deltaFrameTime;
-			movementSystem->gravity                   = gravity;
-			collisionSystem->fDelta_Time_             = deltaFrameTime;
-			collisionSystem->gravity                  = gravity;
-			projectileSystem->deltaFrameTime          = deltaFrameTime;
-			projectileSystem->soundEngine             = soundEngine;
-			physicsSystem->fDelta_Time_               = deltaFrameTime;
-			physicsSystem->fAcceleration_of_Gravity_ += (deltaFrameTime / 20);
-			physicsSystem->gravity                    = gravity;
 			openglRenderer->EnlargeFrameAccumulator(deltaFrameTime);
-			pSystem_Manager->Update();
+			unsigned int steps = fixedTimestep_.Advance(deltaFrameTime);
+			for(unsigned int step = 0; step < steps; ++step)
+				SimulateFixedStep(fixedTimestep_.GetStep());
+			openglRenderer->SetInterpolationAlpha(fixedTimestep_.GetAlpha());
 			openglRenderer->draw();
 			openglRenderer->Window.SwapBuffers();
+			if ( bStatsReport_ )
+				FPScounter();
 		}
 
 		openglRenderer->Window.Close();
 	}
 	
 	void Engine::RenderVulkan() {
-		ecs::CSystemManager* pSystem_Manager = ecs::CSystemManager::GetInstance();
 		bool bGame_Loop_Active = true;
 
 		projectileSystem->textureHandlers = textureHandlers;
@@ -193,6 +190,7 @@ namespace GLVM::core
 		vulkanRenderer->pathsGLTF_             = pathsGLTF_;
 		vulkanRenderer->run();
 		vulkanRenderer->Window.Input_Stack_    = &Input_Stack_;		
+		activeRenderer_ = vulkanRenderer;
 
 #ifdef __linux__
 		// XEvent uXEvent;
@@ -222,7 +220,6 @@ namespace GLVM::core
 		while(bGame_Loop_Active) {
 			deltaFrameTime = chrono->GetElapsed();
 			chrono->Reset();
-		    gravity += deltaFrameTime;
 
 			vulkanRenderer->Window.ClearDisplay();
              
@@ -238,24 +235,47 @@ namespace GLVM::core
 								  &g_eEvent.mousePointerPosition.offset_X,
 								  &g_eEvent.mousePointerPosition.offset_Y);
 
-			movementSystem->deltaFrameTime            = deltaFrameTime;
-			movementSystem->gravity                   = gravity;
-			collisionSystem->fDelta_Time_             = deltaFrameTime;
-			collisionSystem->gravity                  = gravity;
-			projectileSystem->deltaFrameTime          = deltaFrameTime;
-			projectileSystem->soundEngine             = soundEngine;
-			physicsSystem->fDelta_Time_               = deltaFrameTime;
-			physicsSystem->fAcceleration_of_Gravity_ += (deltaFrameTime / 20);
-			physicsSystem->gravity                    = gravity;
 			vulkanRenderer->EnlargeFrameAccumulator(deltaFrameTime);
-			pSystem_Manager->Update();
+			unsigned int steps = fixedTimestep_.Advance(deltaFrameTime);
+			for(unsigned int step = 0; step < steps; ++step)
+				SimulateFixedStep(fixedTimestep_.GetStep());
+			vulkanRenderer->SetInterpolationAlpha(fixedTimestep_.GetAlpha());
 			vulkanRenderer->draw();
 			vulkanRenderer->Window.SwapBuffers();
+			if ( bStatsReport_ )
+				FPScounter();
 		}
 
 		vulkanRenderer->Window.Close();
 	}
 
+	void Engine::StorePreviousTransforms() {
+		core::vector<ecs::components::transform>* transforms =
+			ecs::ComponentManager::GetInstance()->GetComponentContainer<ecs::components::transform>();
+		for(unsigned int i = 0; i < transforms->GetSize(); ++i)
+			ecs::components::StorePreviousState((*transforms)[i]);
+	}
+
+	/*! One simulation step of constant length, so the per step gravity and jump
+	 *  increments of the movement and physics systems give the same trajectory
+	 *  whatever the frame rate. */
+	void Engine::SimulateFixedStep(float step) {
+		ecs::CSystemManager* pSystem_Manager = ecs::CSystemManager::GetInstance();
+
+		StorePreviousTransforms();
+		gravity += step;
+		movementSystem->deltaFrameTime            = step;
+		movementSystem->gravity                   = gravity;
+		collisionSystem->fDelta_Time_             = step;
+		collisionSystem->gravity                  = gravity;
+		projectileSystem->deltaFrameTime          = step;
+		projectileSystem->soundEngine             = soundEngine;
+		physicsSystem->fDelta_Time_               = step;
+		physicsSystem->fAcceleration_of_Gravity_ += (step / 20);
+		physicsSystem->gravity                    = gravity;
+		pSystem_Manager->Update();
+	}
+
 	ecs::TextureHandle Engine::LoadTextureFromFile(const char* path_to_texture) {
 		uint32_t textureID = textureVector.size();
 		ecs::TextureHandle textureHandle;
@@ -301,7 +321,10 @@ namespace GLVM::core
 		++fpsCounter;
 		fpsAccumulator += deltaFrameTime;
 		if (fpsAccumulator > 1.0f) {
-			std::cout << "FPS: " << fpsCounter << std::endl;
+			std::cout << "FPS: " << fpsCounter << " awake bodies: " << collisionSystem->GetAwakeBodies()
+					  << " sleeping bodies: " << collisionSystem->GetSleepingBodies() << std::endl;
+			if ( activeRenderer_ != nullptr )
+				activeRenderer_->ReportStats(fpsCounter);
 			fpsCounter = 0;
 			fpsAccumulator = 0;
 		}
@@ -321,5 +344,7 @@ namespace GLVM::core
 		physicsSystem = nullptr;
 		delete projectileSystem;
 		projectileSystem = nullptr;
+		delete worldBoundsSystem;
+		worldBoundsSystem = nullptr;
     }
 } // namespace GLVM::core
@@ -5,6 +5,7 @@
 
 #include "Components/RigidBodyComponent.hpp"
 #include "Engine.hpp"
+#include "Prefab.hpp"
 #include "SpritesData.hpp"
 #include "Texture.hpp"
 #include "TimerCreator.hpp"
@@ -21,8 +22,7 @@ using namespace GLVM;
 namespace cm = GLVM::ecs::components;
 
 // Global variables for cube spawning system
-static std::vector<Entity> fallingCubes;
-static std::vector<vec3> cubePositions; // Track cube positions for distance checking
+static std::unique_ptr<ecs::CPrefabPool> fallingCubePool; // Cubes in play, recycled once below GROUND_Y_LEVEL
 static GLVM::Time::IChrono* gameTimer = nullptr;
 static double lastSpawnTime = 0.0;
 static const double SPAWN_INTERVAL = 1.5; 
@@ -41,28 +41,60 @@ static std::unique_ptr<GLVM::core::Sound::ProceduralMusicSystem> proceduralMusic
 struct GameResources {
 	cm::MeshHandle hyperCubeHandle;
 	ecs::TextureHandle glvmTextureHandle;
+	ecs::CPrefab* groundPlanePrefab;
+	ecs::CPrefab* fallingCubePrefab;
+	ecs::CPrefabPool* fallingCubePool;
 };
 
 // Function declarations
 GameResources LoadGameAssets(core::Engine* engine);
 Entity CreatePlayerEntity(ecs::EntityManager* entityManager, ecs::ComponentManager* componentManager);
-Entity CreateGroundPlane(ecs::EntityManager* entityManager, ecs::ComponentManager* componentManager, 
-                        const GameResources& resources, const vec3& position = {0.0f, -20.5f, 0.0f});
-Entity CreateFallingCube(ecs::EntityManager* entityManager, ecs::ComponentManager* componentManager, 
-                        const GameResources& resources, float x, float z, float playerY);
+Entity CreateGroundPlane(ecs::ComponentManager* componentManager, const GameResources& resources,
+                        const vec3& position = {0.0f, -20.5f, 0.0f});
+Entity CreateFallingCube(ecs::ComponentManager* componentManager, const GameResources& resources,
+                        float x, float z, float playerY);
 vec3 GenerateRandomColor(); // Generate random color for cubes
-bool IsPositionTooClose(float x, float z); // Check if position is too close to existing cubes
+bool IsPositionTooClose(ecs::ComponentManager* componentManager, const GameResources& resources,
+                        float x, float z); // Check if position is too close to existing cubes
 
-void SpawnCubeIfNeeded(ecs::EntityManager* entityManager, ecs::ComponentManager* componentManager, 
-                      const GameResources& resources, Entity player);
-void CubeManagementLoop(ecs::EntityManager* entityManager, ecs::ComponentManager* componentManager, 
-                       const GameResources& resources, Entity player);
+void SpawnCubeIfNeeded(ecs::ComponentManager* componentManager, const GameResources& resources, Entity player);
+void CubeManagementLoop(ecs::ComponentManager* componentManager, const GameResources& resources, Entity player);
 
 GameResources LoadGameAssets(core::Engine* engine)
 {
 	GameResources resources;
 	resources.hyperCubeHandle = engine->LoadMeshFromFile_GLTF("../gltf/hyper_cube.gltf");
 	resources.glvmTextureHandle = engine->LoadTextureFromAddress(128, 128, glvm_dat_len, glvm_dat);
+
+	ecs::CPrefabRegistry* prefabRegistry = ecs::CPrefabRegistry::GetInstance();
+	// Without the file the prefabs would come back empty, no transform or collider to place.
+	if ( !prefabRegistry->LoadFromFile("../prefabs/prefabs.json") ) {
+		std::cout << "Game prefabs could not be loaded, exiting." << std::endl;
+		exit(1);
+	}
+	// Register() would hand back an empty prefab for a name the file lacks, look them up instead.
+	resources.groundPlanePrefab = prefabRegistry->Get("groundPlane");
+	resources.fallingCubePrefab = prefabRegistry->Get("fallingCube");
+	if ( resources.groundPlanePrefab == nullptr || resources.fallingCubePrefab == nullptr ) {
+		std::cout << "Game prefabs \"groundPlane\" and \"fallingCube\" must be defined in ../prefabs/prefabs.json, exiting." << std::endl;
+		exit(1);
+	}
+
+	// Handles are known only after loading, patch them into the prefabs once.
+	for ( ecs::CPrefab* prefab : { resources.groundPlanePrefab, resources.fallingCubePrefab } ) {
+		prefab->Add<cm::mesh>()->handle = resources.hyperCubeHandle;
+		cm::material* material = prefab->Get<cm::material>();
+		if ( material == nullptr )
+			material = prefab->Add<cm::material>();
+		material->diffuseTextureID_ = resources.glvmTextureHandle;
+		material->specularTextureID_ = resources.glvmTextureHandle;
+	}
+
+	// Cubes that miss every platform go back to the pool instead of falling forever
+	fallingCubePool = std::make_unique<ecs::CPrefabPool>(*resources.fallingCubePrefab);
+	resources.fallingCubePool = fallingCubePool.get();
+	engine->GetWorldBoundsSystem()->minHeight = GROUND_Y_LEVEL;
+	engine->GetWorldBoundsSystem()->AddPool(resources.fallingCubePool);
 	return resources;
 }
 
@@ -86,10 +118,16 @@ vec3 GenerateRandomColor()
 	return colors[colorIndex(gen)];
 }
 
-bool IsPositionTooClose(float x, float z)
+bool IsPositionTooClose(ecs::ComponentManager* componentManager, const GameResources& resources,
+                        float x, float z)
 {
-	// Check if the new position is too close to any existing cube
-	for (const vec3& pos : cubePositions) {
+	// Check if the new position is too close to any cube still in play
+	core::vector<Entity> cubes = resources.fallingCubePool->GetActive();
+	for (unsigned int i = 0; i < cubes.GetSize(); ++i) {
+		cm::transform* transform = componentManager->GetComponent<cm::transform>(cubes[i]);
+		if (!transform) continue;
+
+		const vec3& pos = transform->tPosition;
 		float deltaX = x - pos[0];
 		float deltaZ = z - pos[2];
 		float distanceXZ = sqrt(deltaX * deltaX + deltaZ * deltaZ);
@@ -129,69 +167,34 @@ Entity CreatePlayerEntity(ecs::EntityManager* entityManager, ecs::ComponentManag
 	return player;
 }
 
-Entity CreateGroundPlane(ecs::EntityManager* entityManager, ecs::ComponentManager* componentManager, 
-                        const GameResources& resources, const vec3& position)
+Entity CreateGroundPlane(ecs::ComponentManager* componentManager, const GameResources& resources,
+                        const vec3& position)
 {
-	Entity ground = entityManager->CreateEntity();
-	componentManager->CreateComponent<cm::material, cm::mesh, cm::transform, cm::collider>(ground);
-	
-	// Configure ground transform with passed position
-	*componentManager->GetComponent<cm::transform>(ground) = { 
-		.tPosition = position, 
-		.pitch = 90.0f,
-		.fScale = 10.2f, 
-		.gltf = true 
-	};
-	vec3 randomColor = GenerateRandomColor();
+	Entity ground = ecs::CPrefabRegistry::GetInstance()->Instantiate(*resources.groundPlanePrefab)[0];
 
-		// Set ground mesh
-	componentManager->GetComponent<cm::mesh>(ground)->handle = resources.hyperCubeHandle;
-		// Configure ground material - neutral gray color
-	*componentManager->GetComponent<cm::material>(ground) = { 
-		.diffuseTextureID_ = resources.glvmTextureHandle, 
-		.specularTextureID_ = resources.glvmTextureHandle, 
-		.ambient = randomColor,  // Gray color for ground
-		.shininess = 1.0f 
-	};
-		return ground;
+	// Only the per-instance fields differ from the prefab
+	cm::transform* transform = componentManager->GetComponent<cm::transform>(ground);
+	if (transform) transform->tPosition = position;
+	componentManager->GetComponent<cm::material>(ground)->ambient = GenerateRandomColor();
+	return ground;
 }
 
-Entity CreateFallingCube(ecs::EntityManager* entityManager, ecs::ComponentManager* componentManager,
-                        const GameResources& resources, float x, float z, float playerY)
+Entity CreateFallingCube(ecs::ComponentManager* componentManager, const GameResources& resources,
+                        float x, float z, float playerY)
 {
-	Entity cube = entityManager->CreateEntity();
-	componentManager->CreateComponent<cm::mesh, cm::material, cm::transform, cm::rigidBody, cm::collider>(cube);
-		// Configure cube transform - spawn 15 units above current player position
-	*componentManager->GetComponent<cm::transform>(cube) = { 
-		.tPosition = vec3(x, playerY + 1.0f, z), 
-		.pitch = 90.0f,
-		.fScale = 1.0f,
-		.gltf = true 
-	};
-	
-	// Configure cube physics - enable gravity with reduced speed
-	*componentManager->GetComponent<cm::rigidBody>(cube) = { 
-		.fMass_ = 0.1f,  // Increased mass to slow down falling
-		.bGravity_ = true
-	};
-		// Set cube mesh
-	componentManager->GetComponent<cm::mesh>(cube)->handle = resources.hyperCubeHandle;
-		// Configure cube material with random color
-	vec3 randomColor = GenerateRandomColor();
-	*componentManager->GetComponent<cm::material>(cube) = { 
-		.diffuseTextureID_ = resources.glvmTextureHandle, 
-		.specularTextureID_ = resources.glvmTextureHandle, 
-		.ambient = randomColor,  // Use random color instead of white
-		.shininess = 1.0f 
-	};
-	
+	// Reuses a despawned cube when there is one, components come back with the prefab values
+	Entity cube = resources.fallingCubePool->Acquire();
+
+	// Spawn above current player position with random color
+	cm::transform* transform = componentManager->GetComponent<cm::transform>(cube);
+	if (transform) transform->tPosition = vec3(x, playerY + 1.0f, z);
+	componentManager->GetComponent<cm::material>(cube)->ambient = GenerateRandomColor();
 	return cube;
 }
 
 
 
-void SpawnCubeIfNeeded(ecs::EntityManager* entityManager, ecs::ComponentManager* componentManager, 
-                      const GameResources& resources, Entity player)
+void SpawnCubeIfNeeded(ecs::ComponentManager* componentManager, const GameResources& resources, Entity player)
 {
 	if (!gameTimer) return;
 	
@@ -213,28 +216,22 @@ void SpawnCubeIfNeeded(ecs::EntityManager* entityManager, ecs::ComponentManager*
 			randomX = playerX + positionDist(gen);
 			randomZ = playerZ + positionDist(gen);
 			attempts++;
-		} while (IsPositionTooClose(randomX, randomZ) && attempts < maxAttempts);
+		} while (IsPositionTooClose(componentManager, resources, randomX, randomZ) && attempts < maxAttempts);
 		
 		// If we found a valid position (or exhausted attempts), spawn the cube
-		if (attempts < maxAttempts || cubePositions.empty()) {
+		if (attempts < maxAttempts || resources.fallingCubePool->GetActiveNumber() == 0) {
 			// Create new falling cube relative to player position
-			Entity newCube = CreateFallingCube(entityManager, componentManager, resources, randomX, randomZ, playerY);
-			fallingCubes.push_back(newCube);
-			
-			// Store the cube position for future distance checks
-			cubePositions.push_back(vec3(randomX, playerY + 1.0f, randomZ));
-			
+			CreateFallingCube(componentManager, resources, randomX, randomZ, playerY);
 			lastSpawnTime = currentTime;
 		}
 	}
 }
 
-void CubeManagementLoop(ecs::EntityManager* entityManager, ecs::ComponentManager* componentManager,
-                       const GameResources& resources, Entity player)
+void CubeManagementLoop(ecs::ComponentManager* componentManager, const GameResources& resources, Entity player)
 {
 	while (gameRunning.load()) {
 		// Spawn new cubes if needed
-		SpawnCubeIfNeeded(entityManager, componentManager, resources, player);
+		SpawnCubeIfNeeded(componentManager, resources, player);
 				// Check if player has fallen below Y = -50 and teleport back if so
 		cm::transform* playerTransform = componentManager->GetComponent<cm::transform>(player);
 		if (playerTransform && playerTransform->tPosition[1] < -50.0f) {
@@ -256,12 +253,15 @@ void CubeManagementLoop(ecs::EntityManager* entityManager, ecs::ComponentManager
 	}
 }
 
-int main()
+int main(int argc, char** argv)
 {
 	// Initialize engine systems
 	ecs::EntityManager* entityManager = ecs::EntityManager::GetInstance();
 	ecs::ComponentManager* componentManager = ecs::ComponentManager::GetInstance();
 	core::Engine* engine = core::Engine::GetInstance();
+	// --stats prints FPS and the per frame counters once a second
+	for (int i = 1; i < argc; ++i)
+		if (std::string(argv[i]) == "--stats") engine->SetStatsReport(true);
 	
 	// Initialize timer for cube spawning
 	GLVM::Time::CTimerCreator timerCreator;
@@ -272,14 +272,14 @@ int main()
 	// Load game assets
 	GameResources resources = LoadGameAssets(engine);	// Create game entities
 	Entity player = CreatePlayerEntity(entityManager, componentManager);
-	CreateGroundPlane(entityManager, componentManager, resources, {0.0f, -20.0f, 0.0f});
-	CreateGroundPlane(entityManager, componentManager, resources, {40.0f, 0.0f, 0.0f});
-	CreateGroundPlane(entityManager, componentManager, resources, {40.0f*2, 20.0f, 0.0f});
-	CreateGroundPlane(entityManager, componentManager, resources, {40.0f*3, 20.0f*2, 0.0f});
+	CreateGroundPlane(componentManager, resources, {0.0f, -20.0f, 0.0f});
+	CreateGroundPlane(componentManager, resources, {40.0f, 0.0f, 0.0f});
+	CreateGroundPlane(componentManager, resources, {40.0f*2, 20.0f, 0.0f});
+	CreateGroundPlane(componentManager, resources, {40.0f*3, 20.0f*2, 0.0f});
 	
-	CreateGroundPlane(entityManager, componentManager, resources, {40.0f*3, 20.0f*3, 40.0f});
-	CreateGroundPlane(entityManager, componentManager, resources, {40.0f*3, 20.0f*4, 40.0f*2});
-	CreateGroundPlane(entityManager, componentManager, resources, {40.0f*3, 20.0f*5, 40.0f*3});
+	CreateGroundPlane(componentManager, resources, {40.0f*3, 20.0f*3, 40.0f});
+	CreateGroundPlane(componentManager, resources, {40.0f*3, 20.0f*4, 40.0f*2});
+	CreateGroundPlane(componentManager, resources, {40.0f*3, 20.0f*5, 40.0f*3});
 	
 	// Initialize procedural music system
 	proceduralMusic = std::make_unique<GLVM::core::Sound::ProceduralMusicSystem>(engine->GetSoundEngine());
@@ -291,7 +291,7 @@ int main()
 	proceduralMusic->Start();
 	
 	// Start cube management thread
-	std::thread cubeThread(CubeManagementLoop, entityManager, componentManager, std::ref(resources), player);
+	std::thread cubeThread(CubeManagementLoop, componentManager, std::ref(resources), player);
 	
 	// Start game loop and cleanup
 	engine->GameLoop(core::OPENGL_RENDERER);
@@ -315,6 +315,7 @@ int main()
 	}
 	
 	engine->GameKill();
+	fallingCubePool.reset();
 
 	return 0;
 }
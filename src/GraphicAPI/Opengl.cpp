@@ -14,6 +14,7 @@
 #include "Constants.hpp"
 #include "Engine.hpp"
 #include "Event.hpp"
+#include "FastMath.hpp"
 #include "Components/MaterialComponent.hpp"
 #include "Components/TransformComponent.hpp"
 #include "GLPointer.h"
@@ -36,25 +37,97 @@
 #include "WavefrontObjParser.hpp"
 
 #include <chrono>
+#include <algorithm>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <iostream>
+#include <iterator>
 #include <math.h>
 #include <ratio>
 #include <sstream>
 #include <thread>
+#include <utility>
 
 namespace GLVM::core
 {
+	namespace
+	{
+		const char* const kElementField[] = { "]" };
+
+		vec4 Pack(const vec3& vector, float w) {
+			return vec4(vector[0], vector[1], vector[2], w);
+		}
+
+		const char* const kSkinnedDefine = "#define SKINNED";
+		constexpr unsigned int kInitialSkinPalettes     = 16;     ///< The streams grow when a frame needs more.
+		constexpr unsigned int kInitialStreamedInstances = 4096;
+		constexpr GLsizeiptr kInitialMeshVertexBytes    = 4 << 20;
+		constexpr GLsizeiptr kInitialMeshIndexBytes     = 1 << 20;
+		constexpr GLsizei kMeshVertexStride             = 16 * sizeof(float);
+
+		constexpr uint32_t kPointShadowSlot = 0x80000000u;   ///< Atlas tile slots stay below, see AtlasSlot().
+		constexpr GLenum kPointShadowMapUnit = GL_TEXTURE0;
+		constexpr GLenum kFlatShadowMapUnit  = GL_TEXTURE24;
+
+		uint32_t AtlasSlot(const ShadowTile& tile) {
+			return tile.x | tile.y << 16;
+		}
+
+		/// Scales and moves the clip space of a whole map onto the tile of an atlasSize wide atlas.
+		mat4 AtlasTileMatrix(const ShadowTile& tile, unsigned int atlasSize) {
+			float scale = (float)tile.size / (float)atlasSize;
+			mat4 matrix(1.0f);
+			matrix[0][0] = scale;
+			matrix[1][1] = scale;
+			matrix[3][0] = (float)(2 * tile.x + tile.size) / (float)atlasSize - 1.0f;
+			matrix[3][1] = (float)(2 * tile.y + tile.size) / (float)atlasSize - 1.0f;
+			return matrix;
+		}
+
+		constexpr GLuint kInstanceModelMatrixLayout = 5;   ///< Four vec4 attributes, 5 to 8.
+		constexpr GLuint kInstanceMaterialLayout    = 9;
+
+		/// Points the per instance attributes of the bound VAO at instance firstInstance of the instances written
+		/// at offset into the bound array buffer.
+		void PointInstanceAttributes(GLintptr offset, unsigned int firstInstance) {
+			size_t base = offset + firstInstance * sizeof(InstanceData);
+			for ( GLuint column = 0; column < 4; ++column )
+				pGLVertex_Attrib_Pointer(kInstanceModelMatrixLayout + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+										 (void*)(base + offsetof(InstanceData, modelMatrix) + column * sizeof(vec4)));
+			pGLVertex_Attrib_Pointer(kInstanceMaterialLayout, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+									 (void*)(base + offsetof(InstanceData, ambientShininess)));
+		}
+	}
+
     COpenglRenderer::COpenglRenderer()
 	{
-		coreShaderProgram           = new Shader("../GLshaders/CoreShader.vert", "../GLshaders/CoreShader.frag");
-		flatShadowMapShaderProgram  = new Shader("../GLshaders/FlatShadowMap.vert", "../GLshaders/FlatShadowMap.frag");
- 		cubeShadowMapShaderProgram  = new Shader("../GLshaders/CubeShadowMap.vert", "../GLshaders/CubeShadowMap.frag",
-			                                     "../GLshaders/CubeShadowMap.geom");
+		// Light arrays take the whole block the driver allows, the shader gets the lengths as defines.
+		GLint maxUniformBlockSize = 0;
+		glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &maxUniformBlockSize);
+		maxDirectionalLights_ = maxUniformBlockSize / sizeof(DirectionalLightBlock);
+		maxPointLights_       = maxUniformBlockSize / sizeof(PointLightBlock);
+		maxSpotLights_        = maxUniformBlockSize / sizeof(SpotLightBlock);
+		std::string lightDefines = "#define MAX_DIRECTIONAL_LIGHTS " + std::to_string(maxDirectionalLights_) +
+								   "\n#define MAX_POINT_LIGHTS " + std::to_string(maxPointLights_) +
+								   "\n#define MAX_SPOT_LIGHTS " + std::to_string(maxSpotLights_);
+
+		// Static meshes get variants without the joint palette, they skip skinning altogether.
+		std::string skinnedLightDefines = lightDefines + "\n" + kSkinnedDefine;
+		coreShaderPrograms[eSTATIC_MESH_SHADER]          = new Shader("../GLshaders/CoreShader.vert", "../GLshaders/CoreShader.frag",
+																	   nullptr, lightDefines.c_str());
+		coreShaderPrograms[eSKINNED_MESH_SHADER]         = new Shader("../GLshaders/CoreShader.vert", "../GLshaders/CoreShader.frag",
+																	   nullptr, skinnedLightDefines.c_str());
+		flatShadowMapShaderPrograms[eSTATIC_MESH_SHADER] = new Shader("../GLshaders/FlatShadowMap.vert", "../GLshaders/FlatShadowMap.frag");
+		flatShadowMapShaderPrograms[eSKINNED_MESH_SHADER] = new Shader("../GLshaders/FlatShadowMap.vert", "../GLshaders/FlatShadowMap.frag",
+																		nullptr, kSkinnedDefine);
+		cubeShadowMapShaderPrograms[eSTATIC_MESH_SHADER] = new Shader("../GLshaders/CubeShadowMap.vert", "../GLshaders/CubeShadowMap.frag",
+																	   "../GLshaders/CubeShadowMap.geom");
+		cubeShadowMapShaderPrograms[eSKINNED_MESH_SHADER] = new Shader("../GLshaders/CubeShadowMap.vert", "../GLshaders/CubeShadowMap.frag",
+																		"../GLshaders/CubeShadowMap.geom", kSkinnedDefine);
 		debugQuadDepth_             = new Shader("../GLshaders/DebugQuadDepth.vert", "../GLshaders/DebugQuadDepth.frag");
 		debugLines                  = new Shader("../GLshaders/debugLines.vert", "../GLshaders/debugLines.frag");
 		
@@ -64,16 +137,45 @@ namespace GLVM::core
 		debugQuadDepth_->Use();
 		debugQuadDepth_->SetInt("depthMap", 31);
 		
-		coreShaderProgram->Use();
-		coreShaderProgram->SetInt("material.diffuse", 28);
-		coreShaderProgram->SetInt("material.specular", 29);
+		for ( Shader* coreShaderProgram : coreShaderPrograms ) {
+			coreShaderProgram->Use();
+			coreShaderProgram->SetInt("material.diffuse", 28);
+			coreShaderProgram->SetInt("material.specular", 29);
+			coreShaderProgram->BindUniformBlock("DirectionalLights", eDIRECTIONAL_LIGHTS_BINDING);
+			coreShaderProgram->BindUniformBlock("PointLights", ePOINT_LIGHTS_BINDING);
+			coreShaderProgram->BindUniformBlock("SpotLights", eSPOT_LIGHTS_BINDING);
+		}
+
+		// Every light block and palette starts on an offset the driver can bind a range at.
+		GLint uniformBufferOffsetAlignment = 1;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferOffsetAlignment);
+		paletteStride_ = PaletteStride(MAX_JOINTS_NUMBER, sizeof(mat4), uniformBufferOffsetAlignment);
+		GLsizeiptr paletteBytes = paletteStride_ * sizeof(mat4);
+		GLsizeiptr lightBlocksBytes = maxDirectionalLights_ * sizeof(DirectionalLightBlock) + maxPointLights_ * sizeof(PointLightBlock) +
+									  maxSpotLights_ * sizeof(SpotLightBlock) + 3 * uniformBufferOffsetAlignment;
+		uniformStream_ = std::make_unique<CStreamingBuffer>(GL_UNIFORM_BUFFER, lightBlocksBytes + kInitialSkinPalettes * paletteBytes,
+															uniformBufferOffsetAlignment);
+		coreShaderPrograms[eSKINNED_MESH_SHADER]->BindUniformBlock("SkinPalette", eSKIN_PALETTE_BINDING);
+		flatShadowMapShaderPrograms[eSKINNED_MESH_SHADER]->BindUniformBlock("SkinPalette", eSKIN_PALETTE_BINDING);
+		cubeShadowMapShaderPrograms[eSKINNED_MESH_SHADER]->BindUniformBlock("SkinPalette", eSKIN_PALETTE_BINDING);
+		for ( unsigned int variant = 0; variant < eBATCH_SHADERS_NUMBER; ++variant )
+			ResolveArrayUniforms(cubeShadowMapShaderPrograms[variant], shadowMatrixUniforms_[variant], "shadowMatrices[",
+								 kElementField, 1, 6);
+
+		// The mesh VAO points its instance attributes at this buffer, see PointMeshAttributes().
+		instanceStream_ = std::make_unique<CStreamingBuffer>(GL_ARRAY_BUFFER, kInitialStreamedInstances * sizeof(InstanceData),
+															 sizeof(vec4));
+		meshBuffer_ = std::make_unique<CMeshBuffer>(kMeshVertexStride, kInitialMeshVertexBytes, kInitialMeshIndexBytes);
+		PointMeshAttributes();
+
+		multiDrawIndirect_ = pGLMulti_Draw_Elements_Indirect != nullptr && GLSupports(4, 3, "GL_ARB_multi_draw_indirect") &&
+							 GLSupports(4, 2, "GL_ARB_base_instance");
+		if ( multiDrawIndirect_ )
+			indirectStream_ = std::make_unique<CStreamingBuffer>(GL_DRAW_INDIRECT_BUFFER,
+																 kInitialStreamedInstances * sizeof(DrawElementsIndirectCommand),
+																 sizeof(GLuint));
 		
-		AllocateTextureMemory(pointLightCubeShadowMapFBOcontainer, pointLightCubeShadowMapTextureContainer,
-							  GL_TEXTURE_CUBE_MAP, GL_CLAMP_TO_EDGE, 2, "pointLightCubeShadowMapArray", 0);
-		AllocateTextureMemory(spotLightFlatShadowMapFBOContainer, spotLightFlatShadowMapTextureContainer,
-							  GL_TEXTURE_2D, GL_CLAMP_TO_BORDER, 2, "spotLightFlatShadowMapArray", 2);
-		AllocateTextureMemory(directionalLightFlatShadowMapFBOcontainer, directionalLightFlatShadowMapTextureContainer,
-							  GL_TEXTURE_2D, GL_CLAMP_TO_BORDER, 2, "directionalLightFlatShadowMapArray", 4);
+		AllocateShadowMaps();
 
 		glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
 
@@ -81,19 +183,15 @@ namespace GLVM::core
 	
 	COpenglRenderer::~COpenglRenderer()
 	{
-        delete coreShaderProgram;
-        coreShaderProgram = nullptr;
-		delete flatShadowMapShaderProgram;
-		flatShadowMapShaderProgram = nullptr;
-		delete cubeShadowMapShaderProgram;
-		cubeShadowMapShaderProgram = nullptr;
-
-		for (unsigned int i = 0; i < VBOcontainer_.size(); ++i)
-			pGLDelete_Buffers(NUMBER_OF_CREATING_VBO_OBJECT_1, &VBOcontainer_[i]);
-		
-		for (unsigned int i = 0; i < VAOcontainer_.size(); ++i)
-			pGLDelete_Vertex_Arrays(NUMBER_OF_CREATING_VAO_OBJECT_1, &VAOcontainer_[i]);
-		
+		for ( unsigned int variant = 0; variant < eBATCH_SHADERS_NUMBER; ++variant ) {
+			delete coreShaderPrograms[variant];
+			coreShaderPrograms[variant] = nullptr;
+			delete flatShadowMapShaderPrograms[variant];
+			flatShadowMapShaderPrograms[variant] = nullptr;
+			delete cubeShadowMapShaderPrograms[variant];
+			cubeShadowMapShaderPrograms[variant] = nullptr;
+		}
+
         pGLDelete_Buffers(NUMBER_OF_CREATING_VBO_OBJECT_1, &quadVBO_);
 		pGLDelete_Vertex_Arrays(NUMBER_OF_CREATING_VAO_OBJECT_1, &quadVAO_);
 	}
@@ -106,60 +204,61 @@ namespace GLVM::core
 
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		
-		coreShaderProgram->Use();
+
+		BuildInstanceBatches();
+		ComputeDirectionalLight();
+		ComputePointLight();
+		ComputeSpotLight();
+		StreamFrameUniforms();
 		
 		core::vector<unsigned int>* pEntityContainerRefDirectionalLight =
 			pComponent_Manager->GetEntityContainer<cm::directionalLight>();
+		core::vector<unsigned int>* pEntityContainerRefSpotLight =
+			pComponent_Manager->GetEntityContainer<cm::spotLight>();
+		// Only the first lights of a kind that got an atlas tile cast shadows; the rest are lit unshadowed.
+		unsigned int shadowedDirectionalLightsNumber = std::min<unsigned int>(pEntityContainerRefDirectionalLight->GetSize(),
+																			  std::size(directionalShadowTiles_));
+		unsigned int shadowedSpotLightsNumber = std::min<unsigned int>(pEntityContainerRefSpotLight->GetSize(),
+																	   std::size(spotShadowTiles_));
+		AllocateShadowTiles(shadowedDirectionalLightsNumber, shadowedSpotLightsNumber);
+
 		unsigned int appropriateDirectionalLightComponentIndex = 0;
 		sampledDirectionalLightEntityIDcontainer.clear();
 		mat4 directionalProjectionMatrixLight = ortho(-10.0f, 10.0f, -10.0f, 10.0f,
 													  nearPlaneFlatShadowMap, farPlaneFlatShadowMap);
-		for ( unsigned int i = 0; i < pEntityContainerRefDirectionalLight->GetSize(); ++i ) {
+		for ( unsigned int i = 0; i < shadowedDirectionalLightsNumber; ++i ) {
+			if ( directionalShadowTiles_[i].size == 0 )
+				continue;
 			unsigned int uiDirectionalLightsEntity = (*pEntityContainerRefDirectionalLight)[i];
 			cm::directionalLight* directionalLightComponent = pComponent_Manager->
 				GetComponent<cm::directionalLight>(uiDirectionalLightsEntity);
 
 			directionalLightSpaceMatrixContainer[appropriateDirectionalLightComponentIndex] =
-				EvaluateFlatShadowMap(directionalLightFlatShadowMapFBOcontainer[i],
+				EvaluateFlatShadowMap(directionalShadowTiles_[i],
 									  *directionalLightComponent,directionalProjectionMatrixLight) ;
 
 			sampledDirectionalLightEntityIDcontainer.push_back(i);
-			coreShaderProgram->Use();
-			coreShaderProgram->SetInt(ConcatIntBetweenTwoStrings("sampledShadowOrdinalNumbers[",
-																 appropriateDirectionalLightComponentIndex, "]"), i);
-			
 			++appropriateDirectionalLightComponentIndex;
 		}
-
-		coreShaderProgram->SetInt("sampledDirectionalShadowOrdinalNumbersArraySize",
-								  sampledDirectionalLightEntityIDcontainer.size());
 		
-		core::vector<unsigned int>* pEntityContainerRefSpotLight =
-			pComponent_Manager->GetEntityContainer<cm::spotLight>();
 		unsigned int appropriateSpotLightComponentIndex = 0;
 		sampledSpotLightEntityIDcontainer.clear();
 		mat4 spotProjectionMatrixLight = Perspective(Radians(90.0f),
 													 (float)SHADOW_WIDTH / (float)SHADOW_HEIGHT,
 													 nearPlaneFlatShadowMap, farPlaneFlatShadowMap);
-		
-		for ( unsigned int i = 0; i < pEntityContainerRefSpotLight->GetSize(); ++i ) {
+		for ( unsigned int i = 0; i < shadowedSpotLightsNumber; ++i ) {
+			if ( spotShadowTiles_[i].size == 0 )
+				continue;
 			unsigned int uiSpotLightsEntity = (*pEntityContainerRefSpotLight)[i];
 			cm::spotLight* spotLightComponent = pComponent_Manager->GetComponent<cm::spotLight>(uiSpotLightsEntity);
 
 			spotLightSpaceMatrixContainer[appropriateSpotLightComponentIndex] =
-				EvaluateFlatShadowMap(spotLightFlatShadowMapFBOContainer[i],
+				EvaluateFlatShadowMap(spotShadowTiles_[i],
 									  *spotLightComponent,spotProjectionMatrixLight) ;
 
 			sampledSpotLightEntityIDcontainer.push_back(i);
-			coreShaderProgram->Use();
-			coreShaderProgram->SetInt(ConcatIntBetweenTwoStrings("spotLightFlatShadowMapComponentIndices[",
-																 appropriateSpotLightComponentIndex, "]"), i);
 			++appropriateSpotLightComponentIndex;
 		}
-
-		coreShaderProgram->SetInt("sampledSpotShadowOrdinalNumbersArraySize",
-								  sampledSpotLightEntityIDcontainer.size());
 		
 		// core::vector<unsigned int>* pEntityContainerRefView =
 		// 	pComponent_Manager->GetEntityContainer<cm::beholder>();
@@ -167,7 +266,8 @@ namespace GLVM::core
 		// cm::transform* playerTransformComponent = pComponent_Manager->GetComponent<cm::transform>(uiPlayerEntity);
 		core::vector<unsigned int>* pEntityContainerRefPointLight =
 			pComponent_Manager->GetEntityContainer<cm::pointLight>();
-		unsigned int pointLightComponentContainerSize = pEntityContainerRefPointLight->GetSize();
+		unsigned int pointLightComponentContainerSize = std::min<unsigned int>(pEntityContainerRefPointLight->GetSize(),
+																			   POINT_SHADOW_MAPS_NUMBER);
 
 		sampledPointLightEntityIDcontainer.clear();
 		unsigned int appropriatePointLightComponentIndex = 0;
@@ -177,138 +277,188 @@ namespace GLVM::core
 //			float distance = VectorLength(playerTransformComponent->tPosition, pointLightComponent->position);
 
 //			if ( distance < 4.5f ) {
-				glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 				sampledPointLightEntityIDcontainer.push_back(i);
 				
-				EvaluateCubeShadowMap(pointLightCubeShadowMapFBOcontainer[appropriatePointLightComponentIndex],
-									  *pointLightComponent);
-				
-				coreShaderProgram->Use();
-				coreShaderProgram->SetInt(ConcatIntBetweenTwoStrings("pointLightCubeShadowMapComponentIndices[",
-																	 appropriatePointLightComponentIndex, "]"), i);
+				EvaluateCubeShadowMap(appropriatePointLightComponentIndex, *pointLightComponent);
 				++appropriatePointLightComponentIndex;
 //			}
 		}
-		
-		coreShaderProgram->SetInt("sampledPointShadowOrdinalNumbersArraySize",
-								  sampledPointLightEntityIDcontainer.size());
-		
-		ComputeDirectionalLight();
-		ComputePointLight();
-		ComputeSpotLight();
 
+		if ( shadowFramebufferBound_ ) {
+			pGLBind_Framebuffer(GL_FRAMEBUFFER, 0);
+			++stateStats.framebufferBinds;
+			shadowFramebufferBound_ = false;
+		}
+		
 	    EvaluateCoreShader();
-		RenderScene(coreShaderProgram);
+		CullInstances(Frustum::FromViewProjection(cameraViewMatrix_ * cameraProjectionMatrix_));
+		RenderScene(coreShaderPrograms, eCAMERA_PASS);
+
+		instanceStream_->NextFrame();
+		uniformStream_->NextFrame();
+		if ( indirectStream_ )
+			indirectStream_->NextFrame();
+	}
+
+	void COpenglRenderer::AllocateShadowMaps() {
+		pGLGen_Framebuffers(1, &shadowFBO_);
+		pGLActive_Texture(GL_TEXTURE0);
+
+		glGenTextures(1, &shadowAtlasTexture_);
+		glBindTexture(GL_TEXTURE_2D, shadowAtlasTexture_);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_ATLAS_SIZE, SHADOW_ATLAS_SIZE, 0, GL_DEPTH_COMPONENT,
+					 GL_FLOAT, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+		glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+		glGenTextures(1, &pointShadowMapArray_);
+		glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, pointShadowMapArray_);
+		pGLTex_Image_3D(GL_TEXTURE_CUBE_MAP_ARRAY, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT,
+						6 * POINT_SHADOW_MAPS_NUMBER, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+		// Attach depth texture as FBO's depth buffer
+		pGLBind_Framebuffer(GL_FRAMEBUFFER, shadowFBO_);
+		pGLFramebuffer_Texture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowAtlasTexture_, 0);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		pGLBind_Framebuffer(GL_FRAMEBUFFER, 0);
+		shadowAttachedTexture_ = shadowAtlasTexture_;
+		shadowAttachedLayer_ = -1;
+
+		for ( Shader* coreShaderProgram : coreShaderPrograms ) {
+			coreShaderProgram->Use();
+			coreShaderProgram->SetInt("pointShadowMapArray", kPointShadowMapUnit - GL_TEXTURE0);
+			coreShaderProgram->SetInt("flatShadowMapAtlas", kFlatShadowMapUnit - GL_TEXTURE0);
+		}
 	}
 
-	void COpenglRenderer::AllocateTextureMemory(std::vector<unsigned int>& shadowMapFBOcontainer,
-												std::vector<unsigned int>& shadowMapTextureContainer,
-												GLenum textureTarget, GLint clampType,
-												unsigned int lightSourceNumber,
-												std::string shadowMapArrayType,
-		                                        unsigned int textureUnitBaseIndex) {
-		for ( unsigned int i = 0; i < lightSourceNumber; ++i ) {
-			shadowMapFBOcontainer.emplace_back();
-			shadowMapTextureContainer.emplace_back();
-			InitializeShadowMapData(shadowMapFBOcontainer[i], shadowMapTextureContainer[i],
-									textureTarget, clampType);
+	void COpenglRenderer::AllocateShadowTiles(unsigned int directionalLightsNumber, unsigned int spotLightsNumber) {
+		namespace cm = GLVM::ecs::components;
+		ecs::ComponentManager* pComponent_Manager = ecs::ComponentManager::GetInstance();
+		core::vector<unsigned int>* pEntityContainerRefDirectionalLight =
+			pComponent_Manager->GetEntityContainer<cm::directionalLight>();
+		core::vector<unsigned int>* pEntityContainerRefSpotLight =
+			pComponent_Manager->GetEntityContainer<cm::spotLight>();
+
+		std::pair<unsigned int, ShadowTile*> requests[(sizeof(directionalShadowTiles_) + sizeof(spotShadowTiles_)) / sizeof(ShadowTile)];
+		unsigned int requestsNumber = 0;
+		for ( unsigned int i = 0; i < std::size(directionalShadowTiles_); ++i ) {
+			directionalShadowTiles_[i] = ShadowTile{};
+			if ( i < directionalLightsNumber )
+				requests[requestsNumber++] = { pComponent_Manager->GetComponent<cm::directionalLight>(
+						(*pEntityContainerRefDirectionalLight)[i])->shadowMapSize, &directionalShadowTiles_[i] };
 		}
-		unsigned int lightCounter = 0;
-		int* lightArrayUniformIndices = new int[lightSourceNumber];
-		for ( unsigned int i = textureUnitBaseIndex; i < textureUnitBaseIndex + lightSourceNumber; ++i ) {
-			lightArrayUniformIndices[lightCounter] = i;
-			++lightCounter;
+		for ( unsigned int i = 0; i < std::size(spotShadowTiles_); ++i ) {
+			spotShadowTiles_[i] = ShadowTile{};
+			if ( i < spotLightsNumber )
+				requests[requestsNumber++] = { pComponent_Manager->GetComponent<cm::spotLight>(
+						(*pEntityContainerRefSpotLight)[i])->shadowMapSize, &spotShadowTiles_[i] };
 		}
 
-		coreShaderProgram->Use();
-		coreShaderProgram->SetInt(shadowMapArrayType, lightSourceNumber, lightArrayUniformIndices);
-		delete [] lightArrayUniformIndices;
-		lightArrayUniformIndices = nullptr;
-	}
-	
-	void COpenglRenderer::InitializeShadowMapData(unsigned int& fbo_, unsigned int& texture_, GLenum textureTarget_,
-												  GLint clampType_) {
-				pGLGen_Framebuffers(1, &fbo_);
-				glGenTextures(1, &texture_);
-				pGLActive_Texture(GL_TEXTURE0);
-				glBindTexture(textureTarget_, texture_);
-				AllocateTexture(textureTarget_, clampType_);
-				
-				// Attach depth texture as FBO's depth buffer
-				pGLBind_Framebuffer(GL_FRAMEBUFFER, fbo_);
-				pGLFramebuffer_Texture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture_, 0);
-				glDrawBuffer(GL_NONE);
-				glReadBuffer(GL_NONE);
-				pGLBind_Framebuffer(GL_FRAMEBUFFER, 0);
+		// Stable, so lights asking the same size keep their tiles from frame to frame.
+		std::stable_sort(requests, requests + requestsNumber, [](const auto& a, const auto& b) {
+			return a.first > b.first;
+		});
+		shadowAtlas_.Reset();
+		for ( unsigned int i = 0; i < requestsNumber; ++i )
+			shadowAtlas_.Allocate(requests[i].first, *requests[i].second);
+
+		// A tile may now cover maps another layout kept, none of them can be reused.
+		uint64_t layout = HashWords(directionalShadowTiles_, sizeof(directionalShadowTiles_),
+									HashWords(spotShadowTiles_, sizeof(spotShadowTiles_), 0));
+		if ( layout != shadowTilesLayout_ ) {
+			std::erase_if(shadowMapStates_, [](const auto& state) { return state.first < kPointShadowSlot; });
+			shadowTilesLayout_ = layout;
+		}
 	}
 
-	void COpenglRenderer::AllocateTexture ( GLenum textureTarget_, GLint clampType_ ) {
-		switch ( textureTarget_ ) {
-		case GL_TEXTURE_2D:
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, clampType_); 
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, clampType_);
-			glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-			break;
-		case GL_TEXTURE_CUBE_MAP:
-			for (unsigned int j = 0; j < 6; ++j)
-				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + j, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, clampType_); 
-			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, clampType_);
-			glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, clampType_);
-		break;
-		default:
-			break;
+	void COpenglRenderer::AttachShadowTarget(GLuint texture, GLint layer) {
+		if ( !shadowFramebufferBound_ ) {
+			pGLBind_Framebuffer(GL_FRAMEBUFFER, shadowFBO_);
+			++stateStats.framebufferBinds;
+			shadowFramebufferBound_ = true;
+		}
+		if ( texture == shadowAttachedTexture_ && layer == shadowAttachedLayer_ )
+			return;
+
+		if ( layer < 0 )
+			pGLFramebuffer_Texture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0);
+		else
+			pGLFramebuffer_Texture_Layer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0, layer);
+		shadowAttachedTexture_ = texture;
+		shadowAttachedLayer_ = layer;
+	}
+	
+	void COpenglRenderer::ResolveArrayUniforms(Shader* shaderProgram, std::vector<UniformHandle>& handles, const char* arrayName,
+											   const char* const* fields, unsigned int fieldsNumber,
+											   unsigned int elementsNumber) {
+		for ( unsigned int element = handles.size() / fieldsNumber; element < elementsNumber; ++element ) {
+			std::string prefix = arrayName + std::to_string(element);
+			for ( unsigned int field = 0; field < fieldsNumber; ++field )
+				handles.push_back(shaderProgram->GetUniform(prefix + fields[field]));
 		}
 	}
 
-	mat4 COpenglRenderer::EvaluateFlatShadowMap(unsigned int& shadowMapFBO, ecs::components::directionalLight& directionalLightComponent, mat4 projectionMatrixLight) {
+	mat4 COpenglRenderer::EvaluateFlatShadowMap(const ShadowTile& tile, ecs::components::directionalLight& directionalLightComponent, mat4 projectionMatrixLight) {
 		vec3 positionVectorLight  = directionalLightComponent.position;
 		vec3 directionVectorLight = directionalLightComponent.direction;
 		mat4 viewMatrixLight = LookAtMain(positionVectorLight,
 										  directionVectorLight,
 										  { 0.0f, 1.0f, 0.0f });
 		mat4 lightSpaceMatrix = viewMatrixLight * projectionMatrixLight;
-		// Render scene from light's point of view
-		flatShadowMapShaderProgram->Use();
-		flatShadowMapShaderProgram->SetMat4("lightSpaceMatrix", lightSpaceMatrix);
-		// Render to depth map
-		glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-		pGLBind_Framebuffer(GL_FRAMEBUFFER, shadowMapFBO);
-		glClear(GL_DEPTH_BUFFER_BIT);
-		RenderScene(flatShadowMapShaderProgram);
-		pGLBind_Framebuffer(GL_FRAMEBUFFER, 0);
+		RenderFlatShadowMap(tile, lightSpaceMatrix, eDIRECTIONAL_SHADOW_PASS);
+		mat4 tileMatrix = AtlasTileMatrix(tile, SHADOW_ATLAS_SIZE);
 
-		return lightSpaceMatrix;
+		return lightSpaceMatrix * tileMatrix;
 	}
  
-	mat4 COpenglRenderer::EvaluateFlatShadowMap(unsigned int& shadowMapFBO, ecs::components::spotLight& directionalLightComponent, mat4 projectionMatrixLight) {
+	mat4 COpenglRenderer::EvaluateFlatShadowMap(const ShadowTile& tile, ecs::components::spotLight& directionalLightComponent, mat4 projectionMatrixLight) {
 			vec3 positionVectorLight = directionalLightComponent.position;
 			vec3 directionVectorLight = directionalLightComponent.direction;
 			mat4 viewMatrixLight = LookAtMain(positionVectorLight,
 														 directionVectorLight,
 														 { 0.0f, 1.0f, 0.0f });
 			mat4 lightSpaceMatrix = viewMatrixLight * projectionMatrixLight;
-			// Render scene from light's point of view
-			flatShadowMapShaderProgram->Use();
-			flatShadowMapShaderProgram->SetMat4("lightSpaceMatrix", lightSpaceMatrix);
-			// Render to depth map
-			glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-			pGLBind_Framebuffer(GL_FRAMEBUFFER, shadowMapFBO);
-			glClear(GL_DEPTH_BUFFER_BIT);
-			RenderScene(flatShadowMapShaderProgram);
-			pGLBind_Framebuffer(GL_FRAMEBUFFER, 0);
+			RenderFlatShadowMap(tile, lightSpaceMatrix, eSPOT_SHADOW_PASS);
+			mat4 tileMatrix = AtlasTileMatrix(tile, SHADOW_ATLAS_SIZE);
 
-			return lightSpaceMatrix;
+			return lightSpaceMatrix * tileMatrix;
+	}
+
+	void COpenglRenderer::RenderFlatShadowMap(const ShadowTile& tile, mat4 lightSpaceMatrix, ERenderPass pass) {
+		uint64_t casters = CullInstances(Frustum::FromViewProjection(lightSpaceMatrix));
+		if ( ReuseShadowMap(AtlasSlot(tile), HashWords(&lightSpaceMatrix, sizeof(mat4), tile.size), casters) )
+			return;
+		// Render scene from light's point of view
+		for ( unsigned int variant = 0; variant < shaderVariantsNumber_; ++variant ) {
+			flatShadowMapShaderPrograms[variant]->Use();
+			flatShadowMapShaderPrograms[variant]->SetMat4("lightSpaceMatrix", lightSpaceMatrix);
+		}
+		// Render to the tile, the rest of the atlas keeps the maps reused this frame
+		AttachShadowTarget(shadowAtlasTexture_, -1);
+		glViewport(tile.x, tile.y, tile.size, tile.size);
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(tile.x, tile.y, tile.size, tile.size);
+		glClear(GL_DEPTH_BUFFER_BIT);
+		glDisable(GL_SCISSOR_TEST);
+		RenderScene(flatShadowMapShaderPrograms, pass);
 	}
 	
-	void COpenglRenderer::EvaluateCubeShadowMap(unsigned int& shadowMapFBO, ecs::components::pointLight& pointLightComponent) {
+	void COpenglRenderer::EvaluateCubeShadowMap(unsigned int cubeIndex, ecs::components::pointLight& pointLightComponent) {
 				vec3 positionVectorPointLight = pointLightComponent.position;
+				// Nothing past the far plane reaches any face of the cube map.
+				uint64_t casters = CullInstances(Sphere{ .center = positionVectorPointLight, .radius = farPlaneCubeShadowMap });
+				vec4 lightRange = Pack(positionVectorPointLight, farPlaneCubeShadowMap);
+				if ( ReuseShadowMap(kPointShadowSlot | cubeIndex, HashWords(&lightRange, sizeof(vec4), 0), casters) )
+					return;
 				mat4 projectionMatrixCubeShadowMap = Perspective(Radians(90.0f), (float)SHADOW_WIDTH / (float)SHADOW_HEIGHT, nearPlaneCubeShadowMap, farPlaneCubeShadowMap);
 				vector<mat4> cubeShadowMapTransforms;
 				cubeShadowMapTransforms.Push(LookAtMain(positionVectorPointLight, positionVectorPointLight + vec3( 1.0f,  0.0f,  0.0f), vec3(0.0f, -1.0f,  0.0f)) * projectionMatrixCubeShadowMap);
@@ -319,15 +469,22 @@ namespace GLVM::core
 				cubeShadowMapTransforms.Push(LookAtMain(positionVectorPointLight, positionVectorPointLight + vec3( 0.0f,  0.0f,  -1.0f), vec3(0.0f, -1.0f,  0.0f)) * projectionMatrixCubeShadowMap);
 
 				glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-				pGLBind_Framebuffer(GL_FRAMEBUFFER, shadowMapFBO);
-				glClear(GL_DEPTH_BUFFER_BIT);
-				cubeShadowMapShaderProgram->Use();
-				for (unsigned int j = 0; j < 6; ++j)
-					cubeShadowMapShaderProgram->SetMat4("shadowMatrices[" + std::to_string(j) + "]", cubeShadowMapTransforms[j]);
-				cubeShadowMapShaderProgram->SetFloat("farPlane", farPlaneCubeShadowMap);
-				cubeShadowMapShaderProgram->SetVec3("lightPosition", positionVectorPointLight);
-				RenderScene(cubeShadowMapShaderProgram);
-				pGLBind_Framebuffer(GL_FRAMEBUFFER, 0);
+				// Clearing the layered attachment would clear every cube of the array, so the faces are cleared one by one.
+				for (unsigned int j = 0; j < 6; ++j) {
+					AttachShadowTarget(pointShadowMapArray_, 6 * cubeIndex + j);
+					glClear(GL_DEPTH_BUFFER_BIT);
+				}
+				AttachShadowTarget(pointShadowMapArray_, -1);
+				for ( unsigned int variant = 0; variant < shaderVariantsNumber_; ++variant ) {
+					Shader* cubeShadowMapShaderProgram = cubeShadowMapShaderPrograms[variant];
+					cubeShadowMapShaderProgram->Use();
+					cubeShadowMapShaderProgram->SetInt("layerBase", 6 * cubeIndex);
+					for (unsigned int j = 0; j < 6; ++j)
+						cubeShadowMapShaderProgram->SetMat4(shadowMatrixUniforms_[variant][j], cubeShadowMapTransforms[j]);
+					cubeShadowMapShaderProgram->SetFloat("farPlane", farPlaneCubeShadowMap);
+					cubeShadowMapShaderProgram->SetVec3("lightPosition", positionVectorPointLight);
+				}
+				RenderScene(cubeShadowMapShaderPrograms, ePOINT_SHADOW_PASS);
 	}
 
 	void COpenglRenderer::EvaluateCoreShader() {
@@ -339,50 +496,68 @@ namespace GLVM::core
 		cm::beholder* playerViewComponent = pComponent_Manager->GetComponent<cm::beholder>(uiPlayerEntity);
 		cm::transform* playerTransformComponent = pComponent_Manager->GetComponent<cm::transform>(uiPlayerEntity);
 		
-		vec3 viewPosition = playerTransformComponent->tPosition;
+		vec3 viewPosition = ecs::components::InterpolatedPosition(*playerTransformComponent, interpolationAlpha_);
 		bool reverseNormalsFlag = false;
 		
 		// Render scene as normal
 		glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		ComputeProjectionMatrix(coreShaderProgram);
-		ComputeViewMatrix(coreShaderProgram, *playerTransformComponent, *playerViewComponent);
-		coreShaderProgram->SetInt("shadows", shadows);		coreShaderProgram->SetBool("reverseNormals", reverseNormalsFlag);
-		coreShaderProgram->SetFloat("farPlane", farPlaneCubeShadowMap);
-		coreShaderProgram->SetVec3("viewPosition", viewPosition);
+		ComputeProjectionMatrix();
+		ComputeViewMatrix(*playerTransformComponent, *playerViewComponent);
 		// Add time uniform for shader animation effects
 		static auto startTime = std::chrono::high_resolution_clock::now();
 		auto currentTime = std::chrono::high_resolution_clock::now();
 		float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
-		coreShaderProgram->SetFloat("time", time);
-		
-		// Set number to display on texture (player's Y position)
-		coreShaderProgram->SetFloat("numberToShow", viewPosition[1]);
-
-		coreShaderProgram->SetInt("directionalLightSpaceMatrixContainerSize",
-								  sampledDirectionalLightEntityIDcontainer.size());
-		coreShaderProgram->SetMat4("directionalLightSpaceMatrixContainer",
-								   sampledDirectionalLightEntityIDcontainer.size(),
-								   directionalLightSpaceMatrixContainer[0]);
-		coreShaderProgram->SetInt("spotLightSpaceMatrixContainerSize", sampledSpotLightEntityIDcontainer.size());
-		coreShaderProgram->SetMat4("spotLightSpaceMatrixContainer", sampledSpotLightEntityIDcontainer.size(),
-								   spotLightSpaceMatrixContainer[0]);
-		coreShaderProgram->SetInt("spotLightArraySize", sampledSpotLightEntityIDcontainer.size());
-
-		for ( unsigned int i = 0; i < sampledPointLightEntityIDcontainer.size(); ++i ) {
-			pGLActive_Texture( GL_TEXTURE0 + i );
-			glBindTexture( GL_TEXTURE_CUBE_MAP, pointLightCubeShadowMapTextureContainer[i] );
-		}
 
-		for ( unsigned int i = 0; i < sampledSpotLightEntityIDcontainer.size(); ++i ) {
-			pGLActive_Texture( GL_TEXTURE16 + i );
-			glBindTexture( GL_TEXTURE_2D, spotLightFlatShadowMapTextureContainer[i] );
-		}
+		// Indices of the shadow casting lights among all lights of their kind, then their number.
+		auto setSampledShadows = [this](Shader* coreShaderProgram, std::vector<UniformHandle>& handles, const char* arrayName,
+										const std::vector<unsigned int>& sampledLights, const char* sizeName) {
+			ResolveArrayUniforms(coreShaderProgram, handles, arrayName, kElementField, 1, sampledLights.size());
+			for ( unsigned int i = 0; i < sampledLights.size(); ++i )
+				coreShaderProgram->SetInt(handles[i], (int)sampledLights[i]);
+			coreShaderProgram->SetInt(sizeName, sampledLights.size());
+		};
 
-		for ( unsigned int i = 0; i < sampledDirectionalLightEntityIDcontainer.size(); ++i ) {
-			pGLActive_Texture( GL_TEXTURE24 + i );
-			glBindTexture( GL_TEXTURE_2D, directionalLightFlatShadowMapTextureContainer[i] );
+		for ( unsigned int variant = 0; variant < shaderVariantsNumber_; ++variant ) {
+			Shader* coreShaderProgram = coreShaderPrograms[variant];
+			coreShaderProgram->Use();
+			coreShaderProgram->SetMat4("projectionMatrix", cameraProjectionMatrix_);
+			coreShaderProgram->SetMat4("viewMatrix", cameraViewMatrix_);
+			coreShaderProgram->SetInt("shadows", shadows);		coreShaderProgram->SetBool("reverseNormals", reverseNormalsFlag);
+			coreShaderProgram->SetFloat("farPlane", farPlaneCubeShadowMap);
+			coreShaderProgram->SetVec3("viewPosition", viewPosition);
+			coreShaderProgram->SetFloat("time", time);
+			
+			// Set number to display on texture (player's Y position)
+			coreShaderProgram->SetFloat("numberToShow", viewPosition[1]);
+
+			coreShaderProgram->SetInt("directionalLightsArraySize", directionalLightBlocks_.size());
+			coreShaderProgram->SetInt("pointLightsArraySize", pointLightBlocks_.size());
+			coreShaderProgram->SetInt("spotLightsArraySize", spotLightBlocks_.size());
+
+			setSampledShadows(coreShaderProgram, sampledDirectionalShadowUniforms_[variant], "sampledShadowOrdinalNumbers[",
+							  sampledDirectionalLightEntityIDcontainer, "sampledDirectionalShadowOrdinalNumbersArraySize");
+			setSampledShadows(coreShaderProgram, sampledSpotShadowUniforms_[variant], "spotLightFlatShadowMapComponentIndices[",
+							  sampledSpotLightEntityIDcontainer, "sampledSpotShadowOrdinalNumbersArraySize");
+			setSampledShadows(coreShaderProgram, sampledPointShadowUniforms_[variant], "pointLightCubeShadowMapComponentIndices[",
+							  sampledPointLightEntityIDcontainer, "sampledPointShadowOrdinalNumbersArraySize");
+
+			coreShaderProgram->SetInt("directionalLightSpaceMatrixContainerSize",
+									  sampledDirectionalLightEntityIDcontainer.size());
+			coreShaderProgram->SetMat4("directionalLightSpaceMatrixContainer",
+									   sampledDirectionalLightEntityIDcontainer.size(),
+									   directionalLightSpaceMatrixContainer[0]);
+			coreShaderProgram->SetInt("spotLightSpaceMatrixContainerSize", sampledSpotLightEntityIDcontainer.size());
+			coreShaderProgram->SetMat4("spotLightSpaceMatrixContainer", sampledSpotLightEntityIDcontainer.size(),
+									   spotLightSpaceMatrixContainer[0]);
+			coreShaderProgram->SetInt("spotLightArraySize", sampledSpotLightEntityIDcontainer.size());
 		}
+
+		pGLActive_Texture( kPointShadowMapUnit );
+		glBindTexture( GL_TEXTURE_CUBE_MAP_ARRAY, pointShadowMapArray_ );
+		pGLActive_Texture( kFlatShadowMapUnit );
+		glBindTexture( GL_TEXTURE_2D, shadowAtlasTexture_ );
+		stateStats.shadowSamplerBinds += 2;
 	}
 
 	void COpenglRenderer::EvaluateFlatDebugShader() {
@@ -393,7 +568,7 @@ namespace GLVM::core
 		debugQuadDepth_->SetFloat("nearPlane", nearPlaneFlatShadowMap);
 		debugQuadDepth_->SetFloat("farPlane", farPlaneFlatShadowMap);
 		pGLActive_Texture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, directionalLightFlatShadowMapTextureContainer[0]);
+		glBindTexture(GL_TEXTURE_2D, shadowAtlasTexture_);
 	}
 	
 	void COpenglRenderer::ComputeDirectionalLight() {
@@ -403,22 +578,19 @@ namespace GLVM::core
 			pComponent_Manager->GetEntityContainer<cm::directionalLight>();
 		unsigned int directionalLightComponentContainerSize = pEntityContainerRefDirectionalLight->GetSize();
 
-		coreShaderProgram->SetInt("directionalLightsArraySize", directionalLightComponentContainerSize);
+		if ( directionalLightComponentContainerSize > maxDirectionalLights_ )
+			directionalLightComponentContainerSize = maxDirectionalLights_;
+
+		directionalLightBlocks_.resize(directionalLightComponentContainerSize);
 		for(unsigned int x = 0; x < directionalLightComponentContainerSize; ++x) {
 			unsigned int uiDirectionalLightEntity = (*pEntityContainerRefDirectionalLight)[x];
 			cm::directionalLight* directionalLightComponent = pComponent_Manager->GetComponent<cm::directionalLight>(uiDirectionalLightEntity);
-			std::string leftString = "directionalLights[";
-			coreShaderProgram->SetVec3(ConcatIntBetweenTwoStrings(leftString, x, "].position"),
-									   directionalLightComponent->position);
-			coreShaderProgram->SetVec3(ConcatIntBetweenTwoStrings(leftString, x, "].direction"),
-										directionalLightComponent->direction);
-			coreShaderProgram->SetVec3(ConcatIntBetweenTwoStrings(leftString, x, "].ambient"),
-									   directionalLightComponent->ambient);
-			coreShaderProgram->SetVec3(ConcatIntBetweenTwoStrings(leftString, x, "].diffuse"),
-									   directionalLightComponent->diffuse); // darken diffuse light a bit
-			coreShaderProgram->SetVec3(ConcatIntBetweenTwoStrings(leftString, x, "].specular"),
-									   directionalLightComponent->specular);
-
+			DirectionalLightBlock& block = directionalLightBlocks_[x];
+			block.position  = Pack(directionalLightComponent->position, 0.0f);
+			block.direction = Pack(directionalLightComponent->direction, 0.0f);
+			block.ambient   = Pack(directionalLightComponent->ambient, 0.0f);
+			block.diffuse   = Pack(directionalLightComponent->diffuse, 0.0f); // darken diffuse light a bit
+			block.specular  = Pack(directionalLightComponent->specular, 0.0f);
 		}
 	}
 
@@ -428,26 +600,18 @@ namespace GLVM::core
 		core::vector<unsigned int>* pEntityContainerRefPointLight =
 			pComponent_Manager->GetEntityContainer<cm::pointLight>();
 		unsigned int pointLightComponentContainerSize = pEntityContainerRefPointLight->GetSize();
-		coreShaderProgram->SetInt("pointLightsArraySize", pointLightComponentContainerSize);
+		if ( pointLightComponentContainerSize > maxPointLights_ )
+			pointLightComponentContainerSize = maxPointLights_;
+
+		pointLightBlocks_.resize(pointLightComponentContainerSize);
 		for(unsigned int x = 0; x < pointLightComponentContainerSize; ++x) {
 			unsigned int uiPointLightEntity = (*pEntityContainerRefPointLight)[x];
 			cm::pointLight* pointLightComponent = pComponent_Manager->GetComponent<cm::pointLight>(uiPointLightEntity);
-
-			std::string leftString = "pointLights[";
-			coreShaderProgram->SetVec3(ConcatIntBetweenTwoStrings(leftString, x, "].position"),
-									   pointLightComponent->position);
-			coreShaderProgram->SetVec3(ConcatIntBetweenTwoStrings(leftString, x, "].ambient"),
-									   pointLightComponent->ambient);
-			coreShaderProgram->SetVec3(ConcatIntBetweenTwoStrings(leftString, x, "].diffuse"),
-									   pointLightComponent->diffuse); // darken diffuse light a bit
-			coreShaderProgram->SetVec3(ConcatIntBetweenTwoStrings(leftString, x, "].specular"),
-									   pointLightComponent->specular);
-			coreShaderProgram->SetFloat(ConcatIntBetweenTwoStrings(leftString, x, "].constant"),
-										pointLightComponent->constant);
-			coreShaderProgram->SetFloat(ConcatIntBetweenTwoStrings(leftString, x, "].linear"),
-										pointLightComponent->linear);
-			coreShaderProgram->SetFloat(ConcatIntBetweenTwoStrings(leftString, x, "].quadratic"),
-										pointLightComponent->quadratic);
+			PointLightBlock& block = pointLightBlocks_[x];
+			block.positionConstant = Pack(pointLightComponent->position, pointLightComponent->constant);
+			block.ambientLinear    = Pack(pointLightComponent->ambient, pointLightComponent->linear);
+			block.diffuseQuadratic = Pack(pointLightComponent->diffuse, pointLightComponent->quadratic);
+			block.specular         = Pack(pointLightComponent->specular, 0.0f);
 		}
 	}
 
@@ -457,180 +621,320 @@ namespace GLVM::core
 		core::vector<unsigned int>* pEntityContainerRefSpotLight =
 			pComponent_Manager->GetEntityContainer<cm::spotLight>();
 		unsigned int spotLightComponentContainerSize = pEntityContainerRefSpotLight->GetSize();
-		coreShaderProgram->SetInt("spotLightsArraySize", spotLightComponentContainerSize);
+		if ( spotLightComponentContainerSize > maxSpotLights_ )
+			spotLightComponentContainerSize = maxSpotLights_;
+
+		spotLightBlocks_.resize(spotLightComponentContainerSize);
 		for(unsigned int x = 0; x < spotLightComponentContainerSize; ++x) {
 			unsigned int uiSpotLightEntity = (*pEntityContainerRefSpotLight)[x];
 			cm::spotLight* spotLightComponent = pComponent_Manager->GetComponent<cm::spotLight>(uiSpotLightEntity);
-			std::string leftString = "spotLights[";
-			coreShaderProgram->SetVec3(ConcatIntBetweenTwoStrings(leftString, x, "].position"),
-									   spotLightComponent->position);
-			coreShaderProgram->SetVec3(ConcatIntBetweenTwoStrings(leftString, x, "].direction"),
-									   spotLightComponent->direction);
-			coreShaderProgram->SetFloat(ConcatIntBetweenTwoStrings(leftString, x, "].cutOff"),
-										std::cos(Radians(spotLightComponent->cutOff)));
-			coreShaderProgram->SetFloat(ConcatIntBetweenTwoStrings(leftString, x, "].outerCutOff"),
-										std::cos(Radians(spotLightComponent->outerCutOff)));
-			coreShaderProgram->SetVec3(ConcatIntBetweenTwoStrings(leftString, x, "].ambient"),
-									   spotLightComponent->ambient);
-			coreShaderProgram->SetVec3(ConcatIntBetweenTwoStrings(leftString, x, "].diffuse"),
-									   spotLightComponent->diffuse); // darken diffuse light a bit
-			coreShaderProgram->SetVec3(ConcatIntBetweenTwoStrings(leftString, x, "].specular"),
-									   spotLightComponent->specular);
-			coreShaderProgram->SetFloat(ConcatIntBetweenTwoStrings(leftString, x, "].constant"),
-										spotLightComponent->constant);
-			coreShaderProgram->SetFloat(ConcatIntBetweenTwoStrings(leftString, x, "].linear"),
-										spotLightComponent->linear);
-			coreShaderProgram->SetFloat(ConcatIntBetweenTwoStrings(leftString, x, "].quadratic"),
-										spotLightComponent->quadratic);
+			SpotLightBlock& block = spotLightBlocks_[x];
+			block.positionCutOff       = Pack(spotLightComponent->position, std::cos(Radians(spotLightComponent->cutOff)));
+			block.directionOuterCutOff = Pack(spotLightComponent->direction, std::cos(Radians(spotLightComponent->outerCutOff)));
+			block.ambientConstant      = Pack(spotLightComponent->ambient, spotLightComponent->constant);
+			block.diffuseLinear        = Pack(spotLightComponent->diffuse, spotLightComponent->linear); // darken diffuse light a bit
+			block.specularQuadratic    = Pack(spotLightComponent->specular, spotLightComponent->quadratic);
+		}
+	}
+
+	void COpenglRenderer::StreamFrameUniforms() {
+		// Bound ranges cover the whole block the shader declares, only the lights in use are written.
+		GLsizeiptr directionalLightsSpan = maxDirectionalLights_ * sizeof(DirectionalLightBlock);
+		GLsizeiptr pointLightsSpan       = maxPointLights_ * sizeof(PointLightBlock);
+		GLsizeiptr spotLightsSpan        = maxSpotLights_ * sizeof(SpotLightBlock);
+		GLsizeiptr paletteBytes          = skinPalettes_.size() * sizeof(mat4);
+		GLintptr directionalLightsOffset;
+		GLintptr pointLightsOffset;
+		GLintptr spotLightsOffset;
+
+		// A write that grew the storage lost the ones before it, the frame is written again into the new storage.
+		unsigned int allocation;
+		do {
+			allocation = uniformStream_->GetAllocations();
+			directionalLightsOffset = uniformStream_->Write(directionalLightBlocks_.data(),
+															directionalLightBlocks_.size() * sizeof(DirectionalLightBlock),
+															directionalLightsSpan);
+			pointLightsOffset = uniformStream_->Write(pointLightBlocks_.data(), pointLightBlocks_.size() * sizeof(PointLightBlock),
+													  pointLightsSpan);
+			spotLightsOffset  = uniformStream_->Write(spotLightBlocks_.data(), spotLightBlocks_.size() * sizeof(SpotLightBlock),
+													  spotLightsSpan);
+			if ( paletteBytes > 0 )
+				skinPalettesOffset_ = uniformStream_->Write(skinPalettes_.data(), paletteBytes);
+		} while ( allocation != uniformStream_->GetAllocations() );
+
+		GLuint buffer = uniformStream_->GetBuffer();
+		pGLBind_Buffer_Range(GL_UNIFORM_BUFFER, eDIRECTIONAL_LIGHTS_BINDING, buffer, directionalLightsOffset, directionalLightsSpan);
+		pGLBind_Buffer_Range(GL_UNIFORM_BUFFER, ePOINT_LIGHTS_BINDING, buffer, pointLightsOffset, pointLightsSpan);
+		pGLBind_Buffer_Range(GL_UNIFORM_BUFFER, eSPOT_LIGHTS_BINDING, buffer, spotLightsOffset, spotLightsSpan);
+		if ( paletteBytes > 0 ) {
+			++stateStats.paletteUploads;
+			stateStats.paletteUploadBytes += paletteBytes;
 		}
 	}
 	
-	void COpenglRenderer::RenderScene(Shader* shaderProgram_) {
+	void COpenglRenderer::BuildInstanceBatches() {
 		namespace cm = GLVM::ecs::components;
 		ecs::ComponentManager* pComponent_Manager = GLVM::ecs::ComponentManager::GetInstance();
-		mat4 modelMatrix(1.0f);
-
-		Raycasting();
-
 
-		
-
-		namespace cm = GLVM::ecs::components;
 		core::vector<Entity> linkedEntities      = pComponent_Manager->collectLinkedEntities<cm::transform,
 																							 cm::material,
 																							 cm::mesh>();
+		unsigned int linkedEntitiesVectorSize      = linkedEntities.GetSize();
 
-		unsigned int linkedEntitiesVectorSize      = linkedEntities.GetSize();			
+		vec3 eye(0.0f, 0.0f, 0.0f);
+		core::vector<unsigned int>* pEntityContainerRefView = pComponent_Manager->GetEntityContainer<cm::beholder>();
+		if ( pEntityContainerRefView->GetSize() > 0 )
+			eye = ecs::components::InterpolatedPosition(*pComponent_Manager->GetComponent<cm::transform>((*pEntityContainerRefView)[0]),
+														interpolationAlpha_);
+		float depthScale = CRenderQueue::kMaxDepth / farPlaneView;
+
+		renderQueue_.Clear();
+		for ( unsigned int i = 0; i < linkedEntitiesVectorSize; ++i ) {
+			Entity entity = linkedEntities[i];
+			unsigned int meshID = pComponent_Manager->GetComponent<cm::mesh>(entity)->handle.id;
+			cm::material* material = pComponent_Manager->GetComponent<cm::material>(entity);
+			cm::transform* transformComponent = pComponent_Manager->GetComponent<cm::transform>(entity);
+
+			bool skinned = meshID < jointMatricesPerMesh.GetSize() && jointMatricesPerMesh[meshID].GetSize() > 0;
+			// Advanced here once per frame, not once per pass.
+			if ( skinned && transformComponent->frameAccumulator >= frames[meshID][transformComponent->currentAnimationFrame] * 1.0f ) {
+				++transformComponent->currentAnimationFrame;
+				if ( transformComponent->currentAnimationFrame == frames[meshID].GetSize() ) {
+					transformComponent->currentAnimationFrame = 0;
+					transformComponent->frameAccumulator = 0.0f;
+				}
+			}
 
-		for(unsigned int i = 0; i < linkedEntitiesVectorSize; ++i) {
-			unsigned int uiEntity_refTexture = linkedEntities[i];
-
-			cm::mesh* vertexComponent = pComponent_Manager->GetComponent<cm::mesh>(uiEntity_refTexture);
-			unsigned int uiVertexId = 0;
-			if ( vertexComponent != nullptr )
-				uiVertexId = vertexComponent->handle.id;
-
-			cm::material* material = pComponent_Manager->GetComponent<cm::material>(uiEntity_refTexture);
-			unsigned int diffuseTextureID  = 0;
-			unsigned int specularTextureID = 0;
-			if ( material != nullptr ) {
-				diffuseTextureID  = material->diffuseTextureID_.id;
-				specularTextureID = material->specularTextureID_.id;
+			// Front to back inside a batch, nearer instances fill the depth buffer first.
+			float depth = std::min(VectorLength(eye, transformComponent->tPosition) * depthScale, (float)CRenderQueue::kMaxDepth);
+			renderQueue_.Push(CRenderQueue::MakeKey(skinned ? eSKINNED_MESH_SHADER : eSTATIC_MESH_SHADER,
+													material->diffuseTextureID_.id, material->specularTextureID_.id,
+													meshID, (unsigned int)depth), entity);
+		}
+		renderQueue_.Sort();
+
+		unsigned int queueSize = renderQueue_.GetSize();
+		instances_.resize(queueSize);
+		instanceCenterX_.resize(queueSize);
+		instanceCenterY_.resize(queueSize);
+		instanceCenterZ_.resize(queueSize);
+		instanceExtentX_.resize(queueSize);
+		instanceExtentY_.resize(queueSize);
+		instanceExtentZ_.resize(queueSize);
+		instanceHashes_.resize(queueSize);
+		batches_.clear();
+		skinPalettes_.clear();
+		for ( unsigned int i = 0; i < queueSize; ++i ) {
+			const RenderItem& item = renderQueue_[i];
+			Entity entity = item.value;
+			cm::transform* transformComponent = pComponent_Manager->GetComponent<cm::transform>(entity);
+			bool skinned = CRenderQueue::ShaderOf(item.key) == eSKINNED_MESH_SHADER;
+			cm::material* material = pComponent_Manager->GetComponent<cm::material>(entity);
+			unsigned int meshID = pComponent_Manager->GetComponent<cm::mesh>(entity)->handle.id;
+
+			if ( AddToBatches(batches_, i, meshID, material->diffuseTextureID_.id, material->specularTextureID_.id, skinned) &&
+				 skinned ) {
+				const core::vector<core::vector<mat4>>& joints = jointMatricesPerMesh[meshID];
+				unsigned int jointsNumber = std::min<unsigned int>(joints.GetSize(), MAX_JOINTS_NUMBER);
+
+				batches_.back().skinPalette = skinPalettes_.size() / paletteStride_;
+				for ( unsigned int j = 0; j < jointsNumber; ++j )
+					skinPalettes_.push_back(joints[j][transformComponent->currentAnimationFrame]);
+				skinPalettes_.resize(skinPalettes_.size() + paletteStride_ - jointsNumber, mat4(1.0f));
 			}
 
-			cm::mesh* mesh = pComponent_Manager->GetComponent<cm::mesh>(uiEntity_refTexture);
-			unsigned int meshID = mesh->handle.id;
-			cm::transform* _transformComponent = pComponent_Manager->GetComponent<cm::transform>(uiEntity_refTexture);
-			
-			if ( jointMatricesPerMesh.GetSize() > 0 && jointMatricesPerMesh[meshID].GetSize() > 0 &&
-				 _transformComponent->frameAccumulator >= frames[meshID][_transformComponent->currentAnimationFrame] * 1.0f ) {
-				++_transformComponent->currentAnimationFrame;
-				if ( jointMatricesPerMesh[meshID].GetSize() > 0 && _transformComponent->currentAnimationFrame == frames[meshID].GetSize() ) {
-					_transformComponent->currentAnimationFrame = 0;
-					_transformComponent->frameAccumulator = 0.0f;
+			instances_[i].modelMatrix = SetModelMatrix(*transformComponent);
+			instances_[i].ambientShininess = Pack(material->ambient, material->shininess);
+
+			// The model matrix carries fScale, so the world box follows it.
+			AABB bounds = TransformAABB(meshBounds_[batches_.back().meshID], instances_[i].modelMatrix);
+			vec3 center = Center(bounds);
+			vec3 extents = Extents(bounds);
+			instanceCenterX_[i] = center[0];
+			instanceCenterY_[i] = center[1];
+			instanceCenterZ_[i] = center[2];
+			instanceExtentX_[i] = extents[0];
+			instanceExtentY_[i] = extents[1];
+			instanceExtentZ_[i] = extents[2];
+
+			uint64_t instanceHash = HashWords(&instances_[i].modelMatrix, sizeof(mat4), uint64_t(entity) << 32 | batches_.back().meshID);
+			if ( skinned )
+				instanceHash = HashWords(&skinPalettes_[batches_.back().skinPalette * paletteStride_],
+										 MAX_JOINTS_NUMBER * sizeof(mat4), instanceHash);
+			instanceHashes_[i] = instanceHash;
+		}
+
+		// Written by the first pass that draws it.
+		frameInstancesOffset_ = -1;
+
+		// Every palette of the frame is written once by StreamFrameUniforms(), the passes only bind ranges of it.
+		shaderVariantsNumber_ = skinPalettes_.empty() ? 1 : eBATCH_SHADERS_NUMBER;
+	}
+
+	AABBStream COpenglRenderer::GetInstanceBounds() const {
+		return AABBStream{ instanceCenterX_.data(), instanceCenterY_.data(), instanceCenterZ_.data(),
+						   instanceExtentX_.data(), instanceExtentY_.data(), instanceExtentZ_.data() };
+	}
+
+	uint64_t COpenglRenderer::CullInstances(const Frustum& frustum) {
+		visibleInstances_.resize(instances_.size());
+		CullAABBs(frustum, GetInstanceBounds(), instances_.size(), visibleInstances_.data());
+		return SumVisibleHashes(batches_, visibleInstances_.data(), instanceHashes_.data());
+	}
+
+	uint64_t COpenglRenderer::CullInstances(const Sphere& range) {
+		visibleInstances_.resize(instances_.size());
+		CullAABBs(range, GetInstanceBounds(), instances_.size(), visibleInstances_.data());
+		return SumVisibleHashes(batches_, visibleInstances_.data(), instanceHashes_.data());
+	}
+
+	bool COpenglRenderer::ReuseShadowMap(uint32_t shadowMapSlot, uint64_t light, uint64_t casters) {
+		auto found = shadowMapStates_.find(shadowMapSlot);
+		if ( found != shadowMapStates_.end() && found->second.light == light && found->second.casters == casters ) {
+			++stateStats.reusedShadowMaps;
+			return true;
+		}
+
+		shadowMapStates_[shadowMapSlot] = ShadowMapState{ light, casters };
+		return false;
+	}
+
+	void COpenglRenderer::RenderScene(Shader* const* shaderPrograms, ERenderPass pass) {
+		passBatches_.clear();
+		passInstances_.clear();
+		for ( const InstanceBatch& batch : batches_ ) {
+			InstanceBatch passBatch = batch;
+			passBatch.firstInstance = passInstances_.size();
+			passBatch.instancesNumber = 0;
+			for ( unsigned int i = batch.firstInstance; i < batch.firstInstance + batch.instancesNumber; ++i ) {
+				if ( visibleInstances_[i] != 0 || batch.skinPalette >= 0 ) {
+					passInstances_.push_back(instances_[i]);
+					++passBatch.instancesNumber;
 				}
 			}
-		
-			unsigned int joinMatricesDataSize{};
-			if ( jointMatricesPerMesh.GetSize() > 0 )
-				joinMatricesDataSize = jointMatricesPerMesh[meshID].GetSize();
-			mat4* jointMatricesData = nullptr;
-			if ( joinMatricesDataSize == 0 ) {
-				jointMatricesData = new mat4[MAX_JOINTS_NUMBER];
-				for ( unsigned int i = 0; i < MAX_JOINTS_NUMBER; ++i ) {
-					mat4 unitMatrix(1.0f);
-					jointMatricesData[i] = unitMatrix;
-				}
-				
-			} else {
-				jointMatricesData = new mat4[MAX_JOINTS_NUMBER];
-				for ( unsigned int i = 0; i < joinMatricesDataSize; ++i ) {
-					jointMatricesData[i] = jointMatricesPerMesh[meshID][i][_transformComponent->currentAnimationFrame];
-				}
+			if ( passBatch.instancesNumber > 0 )
+				passBatches_.push_back(passBatch);
+		}
 
-				for ( unsigned int i = joinMatricesDataSize; i < MAX_JOINTS_NUMBER; ++i ) {
-					mat4 unitMatrix(1.0f);
-					jointMatricesData[i] = unitMatrix;
-				}
+		stateStats.drawnInstances[pass] += passInstances_.size();
+		stateStats.culledInstances[pass] += instances_.size() - passInstances_.size();
+
+		// A pass that culls nothing draws the frame batches, the whole frame is written once for all such passes.
+		bool allVisible = passInstances_.size() == instances_.size();
+		const std::vector<InstanceBatch>& drawBatches = allVisible ? batches_ : passBatches_;
+		GLintptr instancesOffset;
+		if ( !allVisible ) {
+			instancesOffset = instanceStream_->Write(passInstances_.data(), sizeof(InstanceData) * passInstances_.size());
+		} else {
+			if ( frameInstancesOffset_ < 0 || frameInstancesAllocation_ != instanceStream_->GetAllocations() ) {
+				frameInstancesOffset_ = instanceStream_->Write(instances_.data(), sizeof(InstanceData) * instances_.size());
+				frameInstancesAllocation_ = instanceStream_->GetAllocations();
 			}
-		
-			shaderProgram_->SetMat4("jointMatrices", MAX_JOINTS_NUMBER, jointMatricesData[0]);
-			delete [] jointMatricesData;
-			jointMatricesData = nullptr;
-			
-			cm::transform* transformComponent = pComponent_Manager->GetComponent<cm::transform>(uiEntity_refTexture);
-			if ( transformComponent != nullptr )
-				modelMatrix = SetModelMatrix(*transformComponent);
-
-			shaderProgram_->SetMat4("modelMatrix", modelMatrix);
-			pGLActive_Texture(GL_TEXTURE28);
-			glBindTexture(GL_TEXTURE_2D, textureVector[diffuseTextureID].iTexture_);
-			pGLActive_Texture(GL_TEXTURE29);
-			glBindTexture(GL_TEXTURE_2D, textureVector[specularTextureID].iTexture_);
-			pGLBind_Vertex_Array(VAOcontainer_[uiVertexId]);
-			cm::material* materialComponent = pComponent_Manager->GetComponent<cm::material>(uiEntity_refTexture);
-			shaderProgram_->SetFloat("material.shininess", materialComponent->shininess);
-			shaderProgram_->SetVec3("material.ambient",  materialComponent->ambient[0], materialComponent->ambient[1], materialComponent->ambient[2]);
-			glDrawElements(GL_TRIANGLES, aIndices_[uiVertexId].size(), GL_UNSIGNED_INT, 0);
+			instancesOffset = frameInstancesOffset_;
 		}
-	}
+		pGLBind_Buffer(GL_ARRAY_BUFFER, instanceStream_->GetBuffer());
+		// Every mesh is in the shared buffers, the pass binds their VAO once whatever the meshes it draws.
+		pGLBind_Vertex_Array(meshBuffer_->GetVertexArray());
+		++stateStats.vertexArrayBinds;
+
+		// All commands of the pass go out in one write, each multi draw submits the run since the last state change.
+		GLintptr commandsOffset = 0;
+		unsigned int runStart = 0;
+		if ( multiDrawIndirect_ ) {
+			drawCommands_.clear();
+			for ( const InstanceBatch& batch : drawBatches ) {
+				const MeshRange& mesh = meshRanges_[batch.meshID];
+				drawCommands_.push_back(DrawElementsIndirectCommand{ mesh.indicesNumber, batch.instancesNumber, mesh.firstIndex,
+																	 mesh.baseVertex, batch.firstInstance });
+			}
+			commandsOffset = indirectStream_->Write(drawCommands_.data(), sizeof(DrawElementsIndirectCommand) * drawCommands_.size());
+			pGLBind_Buffer(GL_DRAW_INDIRECT_BUFFER, indirectStream_->GetBuffer());
+			// The base instance of each command finds its batch, the attributes point at the pass once.
+			PointInstanceAttributes(instancesOffset, 0);
+		}
+		auto submitRun = [&](unsigned int runEnd) {
+			if ( runEnd > runStart ) {
+				pGLMulti_Draw_Elements_Indirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+												(void*)(commandsOffset + runStart * sizeof(DrawElementsIndirectCommand)),
+												runEnd - runStart, 0);
+				++stateStats.drawCalls;
+			}
+			runStart = runEnd;
+		};
 
-	void COpenglRenderer::Raycasting() {
-		namespace cm = GLVM::ecs::components;
-		ecs::ComponentManager* componentManager  = ecs::ComponentManager::GetInstance();
-		core::vector<Entity> linkedEntities      = componentManager->collectUniqueLinkedEntities<cm::projectile,
-																								 cm::transform,
-																								 cm::material,
-																								 cm::mesh,
-																								 cm::collider>();
-		
-		core::vector<Entity> otherLinkedEntities = componentManager->collectUniqueLinkedEntities<cm::material,
-																								 cm::collider,
-																								 cm::mesh,
-																								 cm::transform>();
+		unsigned int usedVariant = eBATCH_SHADERS_NUMBER;
 
-		unsigned int linkedEntitiesVectorSize      = linkedEntities.GetSize();
-		unsigned int otherLinkedEntitiesVectorSize = otherLinkedEntities.GetSize();
-
-        for(unsigned int x = 0; x < linkedEntitiesVectorSize; ++x) {
-          unsigned int uiEntity_refProjectile = linkedEntities[x];
-          cm::transform* rTransformProjectile = componentManager->GetComponent<cm::transform>(uiEntity_refProjectile);
-		  float rayLength = 1.0f;
-		  vec3 ray        = rTransformProjectile->tForward * rayLength;
-
-			for(unsigned int j = 0; j < otherLinkedEntitiesVectorSize; ++j) {
-				unsigned int entityOther = otherLinkedEntities[j];
-				cm::transform* transformOther = componentManager->GetComponent<cm::transform>(entityOther);
-				float otherHalfScale = transformOther->fScale * 0.5f;
-				float min = 0.0f;
-				float max = 1.0f;
-
-				for ( int dimension = 0; dimension < 3; ++dimension ) {
-					float axis_invariant = 1.0f / ray[dimension];
-					float box_min = transformOther->tPosition[dimension] - otherHalfScale;
-					float box_max = transformOther->tPosition[dimension] + otherHalfScale;
-					
-					float delta1  = (box_min - rTransformProjectile->tPosition[dimension]) * axis_invariant;
-					float delta2  = (box_max - rTransformProjectile->tPosition[dimension]) * axis_invariant;
+		// Batches come in render queue order, the filter below binds only what changed since the last batch.
+		unsigned int boundDiffuseTextureID  = UINT32_MAX;
+		unsigned int boundSpecularTextureID = UINT32_MAX;
 
-					min = Max(min, Min(delta1, delta2));
-					max = Min(max, Max(delta1, delta2));
-					
-					if ( max < min )
-						break;
-				}
+		for ( unsigned int batchIndex = 0; batchIndex < drawBatches.size(); ++batchIndex ) {
+			const InstanceBatch& batch = drawBatches[batchIndex];
+			unsigned int variant = batch.skinPalette >= 0 ? eSKINNED_MESH_SHADER : eSTATIC_MESH_SHADER;
+			if ( multiDrawIndirect_ && batchIndex > 0 && BreaksDrawRun(batch, drawBatches[batchIndex - 1]) )
+				submitRun(batchIndex);
 
-				if ( max > min ) {
-					ecs::EntityManager* entityManager       = GLVM::ecs::EntityManager::GetInstance();
-					entityManager->RemoveEntity(uiEntity_refProjectile, componentManager);
-					/// TODO: There is a big quastion is this decrement have sence.
-//					--linkedEntitiesVectorSize;  
- 				}
+			if ( variant != usedVariant ) {
+				shaderPrograms[variant]->Use();
+				usedVariant = variant;
+			}
+			if ( batch.skinPalette >= 0 ) {
+				pGLBind_Buffer_Range(GL_UNIFORM_BUFFER, eSKIN_PALETTE_BINDING, uniformStream_->GetBuffer(),
+									 PaletteOffset(skinPalettesOffset_, batch.skinPalette, paletteStride_, sizeof(mat4)),
+									 MAX_JOINTS_NUMBER * sizeof(mat4));
+				++stateStats.paletteBinds;
 			}
+
+			if ( batch.diffuseTextureID != boundDiffuseTextureID ) {
+				pGLActive_Texture(GL_TEXTURE28);
+				glBindTexture(GL_TEXTURE_2D, textureVector[batch.diffuseTextureID].iTexture_);
+				boundDiffuseTextureID = batch.diffuseTextureID;
+				++stateStats.textureBinds;
+			}
+			if ( batch.specularTextureID != boundSpecularTextureID ) {
+				pGLActive_Texture(GL_TEXTURE29);
+				glBindTexture(GL_TEXTURE_2D, textureVector[batch.specularTextureID].iTexture_);
+				boundSpecularTextureID = batch.specularTextureID;
+				++stateStats.textureBinds;
+			}
+
+			if ( !multiDrawIndirect_ ) {
+				// Without base instance the instance attributes are moved to the batch instead.
+				const MeshRange& mesh = meshRanges_[batch.meshID];
+				PointInstanceAttributes(instancesOffset, batch.firstInstance);
+				pGLDraw_Elements_Instanced_Base_Vertex(GL_TRIANGLES, mesh.indicesNumber, GL_UNSIGNED_INT,
+													   (void*)(mesh.firstIndex * sizeof(GLuint)), batch.instancesNumber,
+													   mesh.baseVertex);
+				++stateStats.drawCalls;
+			}
+			++stateStats.draws;
+		}
+		if ( multiDrawIndirect_ )
+			submitRun(drawBatches.size());
+	}
+
+	void COpenglRenderer::PointMeshAttributes() {
+		pGLBind_Vertex_Array(meshBuffer_->GetVertexArray());
+		pGLBind_Buffer(GL_ARRAY_BUFFER, meshBuffer_->GetVertexBuffer());
+		pGLVertex_Attrib_Pointer(LAYOUT_0, VERTEX_SIZE, GL_FLOAT, GL_FALSE, kMeshVertexStride, (void*)VERTEX_OFFSET);
+        pGLEnable_Vertex_Attrib_Array(LAYOUT_0);
+		pGLVertex_Attrib_Pointer(LAYOUT_1, 3, GL_FLOAT, GL_FALSE, kMeshVertexStride, (void*)(3 * sizeof(float)));
+		pGLEnable_Vertex_Attrib_Array(LAYOUT_1);
+		pGLVertex_Attrib_Pointer(2, TEXTURE_SIZE, GL_FLOAT, GL_FALSE, kMeshVertexStride, (void*)(6 * sizeof(float)));
+		pGLEnable_Vertex_Attrib_Array(2);
+		pGLVertex_Attrib_Pointer(3, 4, GL_FLOAT, GL_FALSE, kMeshVertexStride, (void*)(8 * sizeof(float)));
+		pGLEnable_Vertex_Attrib_Array(3);
+		pGLVertex_Attrib_Pointer(4, 4, GL_FLOAT, GL_FALSE, kMeshVertexStride, (void*)(12 * sizeof(float)));
+		pGLEnable_Vertex_Attrib_Array(4);
+
+		pGLBind_Buffer(GL_ARRAY_BUFFER, instanceStream_->GetBuffer());
+		PointInstanceAttributes(0, 0);
+		for ( GLuint layout = kInstanceModelMatrixLayout; layout <= kInstanceMaterialLayout; ++layout ) {
+			pGLEnable_Vertex_Attrib_Array(layout);
+			pGLVertex_Attrib_Divisor(layout, 1);
 		}
 	}
 
-	
 	void COpenglRenderer::RaycastingDebug() {
 		/// TODO: This code for debug purpouses only
 		// float plane[] = {
@@ -662,10 +966,11 @@ namespace GLVM::core
 		cm::beholder* playerViewComponent = componentManager->GetComponent<cm::beholder>(uiPlayerEntity);
 		cm::transform* playerTransformComponent = componentManager->GetComponent<cm::transform>(uiPlayerEntity);
 		
-		unsigned int location = pGLGet_Uniform_Location(debugLines->iID, "modelMatrix");
-		pGLUniform_Matrix4fv(location, NUMBER_OF_MATRICES, GL_FALSE, &planeModelMatrix[0][0]);
-		ComputeProjectionMatrix(debugLines);
-		ComputeViewMatrix(debugLines, *playerTransformComponent, *playerViewComponent);
+		debugLines->SetMat4("modelMatrix", planeModelMatrix);
+		ComputeProjectionMatrix();
+		ComputeViewMatrix(*playerTransformComponent, *playerViewComponent);
+		debugLines->SetMat4("projectionMatrix", cameraProjectionMatrix_);
+		debugLines->SetMat4("viewMatrix", cameraViewMatrix_);
 		pGLGen_Vertex_Arrays(1, &vaoPlane);
 		pGLGen_Buffers(1, &vboPlane);
 		pGLBind_Vertex_Array(vaoPlane);
@@ -694,8 +999,7 @@ namespace GLVM::core
 		linesModelMatrix[3][1] = 0.0;
 		linesModelMatrix[3][2] = 0.0;
 
-		unsigned int locationLines = pGLGet_Uniform_Location(debugLines->iID, "modelMatrix");
-		pGLUniform_Matrix4fv(locationLines, NUMBER_OF_MATRICES, GL_FALSE, &linesModelMatrix[0][0]);
+		debugLines->SetMat4("modelMatrix", linesModelMatrix);
 
 		float lines[36] = {
 			0.0f, 5.0f, 0.0f,
@@ -758,38 +1062,23 @@ namespace GLVM::core
 	
 	void COpenglRenderer::SetVertices(std::vector<unsigned int>& _aIndices,
 									  std::vector<float>& _aVertices) {
-		GLuint iVbo_;
-		GLuint iVao_;
-		GLuint iEbo_;
-		pGLGen_Vertex_Arrays(NUMBER_OF_CREATING_VAO_OBJECT_1, &iVao_);
-        pGLGen_Buffers(NUMBER_OF_CREATING_VBO_OBJECT_1, &iVbo_);
-		
-        pGLGen_Buffers(1, &iEbo_);
-        
-        ///< First we link the vertex array object, then we link and set the vertex buffers, and then we configure the vertex attributes.
-        
-        pGLBind_Vertex_Array(iVao_);
-		
-		pGLBind_Buffer(GL_ARRAY_BUFFER, iVbo_);
-        pGLBuffer_Data(GL_ARRAY_BUFFER, sizeof(float) * _aVertices.size(), _aVertices.data(), GL_DYNAMIC_DRAW);
-
-        pGLBind_Buffer(GL_ELEMENT_ARRAY_BUFFER, iEbo_);
-        pGLBuffer_Data(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * _aIndices.size(), _aIndices.data(), GL_STATIC_DRAW);
-        
-		pGLVertex_Attrib_Pointer(LAYOUT_0, VERTEX_SIZE, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)VERTEX_OFFSET);
-        pGLEnable_Vertex_Attrib_Array(LAYOUT_0);
-		pGLVertex_Attrib_Pointer(LAYOUT_1, 3, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)(3 * sizeof(float)));
-		pGLEnable_Vertex_Attrib_Array(LAYOUT_1);
-		pGLVertex_Attrib_Pointer(2, TEXTURE_SIZE, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)(6 * sizeof(float)));
-		pGLEnable_Vertex_Attrib_Array(2);
-		pGLVertex_Attrib_Pointer(3, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)(8 * sizeof(float)));
-		pGLEnable_Vertex_Attrib_Array(3);
-		pGLVertex_Attrib_Pointer(4, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)(12 * sizeof(float)));
-		pGLEnable_Vertex_Attrib_Array(4);
-
-		VBOcontainer_.push_back(iVbo_);
-		VAOcontainer_.push_back(iVao_);
-		EBOcontainer_.push_back(iEbo_);
+		// Meshes never change once loaded, they are appended to the shared buffers and drawn by their range.
+		meshRanges_.push_back(meshBuffer_->Add(_aVertices.data(), sizeof(float) * _aVertices.size(), _aIndices.data(),
+											   _aIndices.size()));
+		PointMeshAttributes();
+
+		// Bind pose bounds, positions lead each 16 float vertex.
+		AABB bounds;
+		if ( _aVertices.size() >= 3 ) {
+			bounds.min = bounds.max = vec3(_aVertices[0], _aVertices[1], _aVertices[2]);
+			for ( unsigned int i = 0; i + 2 < _aVertices.size(); i += 16 ) {
+				for ( unsigned int axis = 0; axis < 3; ++axis ) {
+					bounds.min[axis] = Min(bounds.min[axis], _aVertices[i + axis]);
+					bounds.max[axis] = Max(bounds.max[axis], _aVertices[i + axis]);
+				}
+			}
+		}
+		meshBounds_.push_back(bounds);
 	}
 	
     void COpenglRenderer::loadWavefrontObj() {
@@ -841,6 +1130,40 @@ namespace GLVM::core
         }
     }
 
+	void COpenglRenderer::ReportStats(unsigned int frames) {
+		if ( frames == 0 )
+			return;
+
+		std::cout << "Uniform uploads per frame: " << Shader::callStats.uploads / frames
+				  << " upload bytes per frame: " << Shader::callStats.uploadBytes / frames
+				  << " location queries per frame: " << Shader::callStats.locationQueries / frames << std::endl;
+		std::cout << "Draws per frame: " << stateStats.draws / frames
+				  << " draw calls: " << stateStats.drawCalls / frames
+				  << " texture binds: " << stateStats.textureBinds / frames
+				  << " vertex array binds: " << stateStats.vertexArrayBinds / frames
+				  << " palette uploads: " << stateStats.paletteUploads / frames
+				  << " (" << stateStats.paletteUploadBytes / frames << " bytes)"
+				  << " palette binds: " << stateStats.paletteBinds / frames
+				  << " reused shadow maps: " << stateStats.reusedShadowMaps / frames
+				  << " framebuffer binds: " << stateStats.framebufferBinds / frames
+				  << " shadow sampler binds: " << stateStats.shadowSamplerBinds / frames << std::endl;
+		const char* const passNames[eRENDER_PASSES_NUMBER] = { "camera", "directional", "spot", "point" };
+		std::cout << "Drawn/culled instances per frame,";
+		for ( unsigned int pass = 0; pass < eRENDER_PASSES_NUMBER; ++pass )
+			std::cout << " " << passNames[pass] << ": " << stateStats.drawnInstances[pass] / frames
+					  << "/" << stateStats.culledInstances[pass] / frames;
+		std::cout << std::endl;
+		const StreamingBufferStats& streamingStats = CStreamingBuffer::stats;
+		std::cout << "Streamed bytes per frame: " << streamingStats.writtenBytes / frames
+				  << " in " << frames << " frames, stalls: " << streamingStats.stalls
+				  << " stall time: " << streamingStats.stallNanoseconds / 1000 << " us"
+				  << " stream allocations: " << streamingStats.allocations << std::endl;
+
+		Shader::callStats = UniformCallStats{};
+		stateStats = RenderStateStats{};
+		CStreamingBuffer::stats = StreamingBufferStats{};
+	}
+
 	void COpenglRenderer::EnlargeFrameAccumulator(float value) {
 		namespace cm = GLVM::ecs::components;
 		
@@ -859,54 +1182,34 @@ namespace GLVM::core
 	
 	mat4 COpenglRenderer::SetModelMatrix(ecs::components::transform& transformComponent_)
 	{
-        mat4 rotationMatrix(1.0f);
-        mat4 modelMatrix(1.0f);
-        mat4 scalingMatrix(1.0f);
-        mat4 translationMatrix(1.0f);
-
-        scalingMatrix[0][0] = transformComponent_.fScale;
-        scalingMatrix[1][1] = transformComponent_.fScale;
-        scalingMatrix[2][2] = transformComponent_.fScale;
-		scalingMatrix[3][3] = 1.0f;
-        
-        translationMatrix[3][0] = transformComponent_.tPosition[0];
-		translationMatrix[3][1] = transformComponent_.tPosition[1];
-		translationMatrix[3][2] = transformComponent_.tPosition[2];
-        translationMatrix[3][3] = 1.0f;
-
-		float sinPitch = std::sin(Radians(-transformComponent_.pitch / 2));
-		float cosPitch = std::cos(Radians(-transformComponent_.pitch / 2));
-		float sinYaw = std::sin(Radians(-(transformComponent_.yaw)  / 2));
-		float cosYaw = std::cos(Radians(-(transformComponent_.yaw)  / 2));
-		
-		Quaternion pitchQuat;
-		Quaternion yawQuat;
-		pitchQuat.w = cosPitch;
-		pitchQuat.x = 0.0f;
-		pitchQuat.y = 0.0f;
-		pitchQuat.z = sinPitch;
+		// scale * rotation * translation, folded: uniform scale multiplies the rotation
+		// rows and the translation lands in the last row.
+        mat4 modelMatrix = unitQuaternionToMatrix(ecs::components::InterpolatedRotation(transformComponent_, interpolationAlpha_));
 
-		yawQuat.w = cosYaw;
-		yawQuat.x = 0.0f;
-		yawQuat.y = sinYaw;
-		yawQuat.z = 0.0f;
+		for (int row = 0; row < 3; ++row)
+			for (int column = 0; column < 3; ++column)
+				modelMatrix[row][column] *= transformComponent_.fScale;
 
-		Quaternion result;
-		result = multiplyQuaternion(pitchQuat, yawQuat);
-		rotationMatrix = rotateQuaternion<float, 4>(result);
-        modelMatrix = scalingMatrix * rotationMatrix * translationMatrix;
+		vec3 position = ecs::components::InterpolatedPosition(transformComponent_, interpolationAlpha_);
+        modelMatrix[3][0] = position[0];
+		modelMatrix[3][1] = position[1];
+		modelMatrix[3][2] = position[2];
 
 		return modelMatrix;
 	}
 
     void COpenglRenderer::SetViewMatrix(mat4 _viewMatrix) {
-        unsigned int uniformLocationViewWorld = pGLGet_Uniform_Location(coreShaderProgram->iID, "viewMatrix");
-        pGLUniform_Matrix4fv(uniformLocationViewWorld, NUMBER_OF_MATRICES, GL_FALSE, &_viewMatrix[0][0]);
+		for ( Shader* coreShaderProgram : coreShaderPrograms ) {
+			coreShaderProgram->Use();
+			coreShaderProgram->SetMat4("viewMatrix", _viewMatrix);
+		}
     }
 
     void COpenglRenderer::SetProjectionMatrix(mat4 _projectionMatrix) {
-        unsigned int uniformLocationProjectionWorld = pGLGet_Uniform_Location(coreShaderProgram->iID, "projectionMatrix");
-		pGLUniform_Matrix4fv(uniformLocationProjectionWorld, NUMBER_OF_MATRICES, GL_FALSE, &_projectionMatrix[0][0]);
+		for ( Shader* coreShaderProgram : coreShaderPrograms ) {
+			coreShaderProgram->Use();
+			coreShaderProgram->SetMat4("projectionMatrix", _projectionMatrix);
+		}
     }
     
     void COpenglRenderer::SetTextureData(std::vector<ecs::Texture>& _texture_data) {
@@ -991,7 +1294,7 @@ namespace GLVM::core
 		}
 	}
 
-	void COpenglRenderer::ComputeViewMatrix(Shader* shaderProgram, ecs::components::transform& player, ecs::components::beholder& beholder)
+	void COpenglRenderer::ComputeViewMatrix(ecs::components::transform& player, ecs::components::beholder& beholder)
     {
         Matrix<float, 4> viewMatrix(1.0f);
         const float kSensitivity = 0.1f;
@@ -1010,10 +1313,9 @@ namespace GLVM::core
             pitch = -89.0f;
 
 		vec3 forward;
-		float sinPitch = std::sin(Radians(pitch / 2));
-		float cosPitch = std::cos(Radians(pitch / 2));
-		float sinYaw = std::sin(Radians(-fYaw / 2));
-		float cosYaw = std::cos(Radians(-fYaw / 2));
+		float sinPitch, cosPitch, sinYaw, cosYaw;
+		core::math::sincosDegrees(pitch / 2, sinPitch, cosPitch);
+		core::math::sincosDegrees(-fYaw / 2, sinYaw, cosYaw);
 		
 		Quaternion pitchQuat;
 		Quaternion yawQuat;
@@ -1037,15 +1339,15 @@ namespace GLVM::core
 		forward[1] = result.y;
 		forward[2] = result.z;
         beholder.forward = Normalize(forward);
-        viewMatrix = LookAtMain(player.tPosition,
-								player.tPosition + beholder.forward,
+		vec3 eye = ecs::components::InterpolatedPosition(player, interpolationAlpha_);
+        viewMatrix = LookAtMain(eye,
+								eye + beholder.forward,
 								beholder.up);
 
-		shaderProgram->SetMat4("viewMatrix", viewMatrix);
+		cameraViewMatrix_ = viewMatrix;
     }
 
-	void COpenglRenderer::ComputeProjectionMatrix(Shader* shaderProgram) {
-		mat4 tProjection_Matrix = Perspective(Radians(90.0f), (float)1920 / (float)1080, 0.1f, 1000.0f);
-		shaderProgram->SetMat4("projectionMatrix", tProjection_Matrix);
+	void COpenglRenderer::ComputeProjectionMatrix() {
+		cameraProjectionMatrix_ = Perspective(Radians(90.0f), (float)1920 / (float)1080, nearPlaneView, farPlaneView);
 	}
 }
@@ -235,8 +235,9 @@ namespace GLVM::core
 		forward[1] = result.y;
 		forward[2] = result.z;
         cameraComponent.forward = Normalize(forward);
-        viewMatrix_ = LookAtMain(_Player.tPosition,
-								_Player.tPosition + cameraComponent.forward,
+		vec3 eye = ecs::components::InterpolatedPosition(_Player, interpolationAlpha_);
+        viewMatrix_ = LookAtMain(eye,
+								eye + cameraComponent.forward,
 								cameraComponent.up);
 
 		viewMatrix = viewMatrix_;
@@ -3185,7 +3186,7 @@ namespace GLVM::core
 		core::vector<Entity> pointLightEntities = componentManager->collectLinkedEntities<GLVM::ecs::components::controller>();
 		if ( pointLightEntities.GetSize() > 0 )
 
-			lightDataUBO.viewPosition = transformComponent->tPosition;
+			lightDataUBO.viewPosition = ecs::components::InterpolatedPosition(*transformComponent, interpolationAlpha_);
 
 		DirectionalLight directionalLight{};
 
@@ -4118,31 +4119,13 @@ namespace GLVM::core
 		scalingMatrix[1][1] = _transformComponent->fScale;
 		scalingMatrix[2][2] = _transformComponent->fScale;
 
-		translationMatrix[3][0] = _transformComponent->tPosition[0];
-		translationMatrix[3][1] = _transformComponent->tPosition[1];
-		translationMatrix[3][2] = _transformComponent->tPosition[2];
+		vec3 position = ecs::components::InterpolatedPosition(*_transformComponent, interpolationAlpha_);
+		translationMatrix[3][0] = position[0];
+		translationMatrix[3][1] = position[1];
+		translationMatrix[3][2] = position[2];
 		translationMatrix[3][3] = 1.0f;
 
-		float sinPitch = std::sin(Radians(-_transformComponent->pitch / 2));
-		float cosPitch = std::cos(Radians(-_transformComponent->pitch / 2));
-		float sinYaw = std::sin(Radians(-(_transformComponent->yaw)  / 2));
-		float cosYaw = std::cos(Radians(-(_transformComponent->yaw)  / 2));
-		
-		Quaternion pitchQuat;
-		Quaternion yawQuat;
-		pitchQuat.w = cosPitch;
-		pitchQuat.x = 0.0f;
-		pitchQuat.y = 0.0f;
-		pitchQuat.z = sinPitch;
-
-		yawQuat.w = cosYaw;
-		yawQuat.x = 0.0f;
-		yawQuat.y = sinYaw;
-		yawQuat.z = 0.0f;
-
-		Quaternion result;
-		result = multiplyQuaternion(pitchQuat, yawQuat);
-		rotationMatrix = rotateQuaternion<float, 4>(result);
+		rotationMatrix = unitQuaternionToMatrix(ecs::components::InterpolatedRotation(*_transformComponent, interpolationAlpha_));
 		
         return scalingMatrix * rotationMatrix * translationMatrix;
 	}
@@ -48,8 +48,11 @@ namespace GLVM::Core
 				}
 			}
 			
+			// Value parsers stop on the character after the value, step back so the
+			// increment at the end of the loop does not swallow a closing bracket.
 			if (currentChar_ == '"') {
 				bufferString_ = StringParse();
+				--globalFileCounter_;
 
 				if (keyFlag) {
 					JsonValue jsonString(bufferString_);
@@ -61,6 +64,7 @@ namespace GLVM::Core
 			} else if ((currentChar_ >= '0' && currentChar_ <= '9') ||
 					   currentChar_ == '+' || currentChar_ == '-') {
 				bufferString_ = NumberAsStringParse();
+				--globalFileCounter_;
 				core::vector<char> vector = StringToVectorOfChars(bufferString_);
 				double fNumber = 0.0f;
 				int iNumber = 0;
@@ -90,6 +94,7 @@ namespace GLVM::Core
 				       currentChar_ == 'f' ||
 				       currentChar_ == 'n') {
 				std::string boolOrNullString = BoolOrNullParse();
+				--globalFileCounter_;
 
 				if (boolOrNullString == "true") {
 					if (keyFlag) {
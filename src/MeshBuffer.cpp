@@ -0,0 +1,73 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "MeshBuffer.hpp"
+#include "StreamingBuffer.hpp"
+#include <algorithm>
+
+namespace GLVM::core
+{
+	CMeshBuffer::CMeshBuffer(GLsizei vertexStride, GLsizeiptr vertexCapacity, GLsizeiptr indexCapacity)
+		: vertexStride_(vertexStride), vertexCapacity_(vertexCapacity), indexCapacity_(indexCapacity) {
+		Allocate(vertexBuffer_, vertexCapacity_);
+		Allocate(indexBuffer_, indexCapacity_);
+		pGLGen_Vertex_Arrays(1, &vertexArray_);
+		pGLBind_Vertex_Array(vertexArray_);
+		pGLBind_Buffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer_);
+	}
+
+	CMeshBuffer::~CMeshBuffer() {
+		pGLDelete_Vertex_Arrays(1, &vertexArray_);
+		pGLDelete_Buffers(1, &vertexBuffer_);
+		pGLDelete_Buffers(1, &indexBuffer_);
+	}
+
+	void CMeshBuffer::Allocate(GLuint& buffer, GLsizeiptr capacity) {
+		// The copy targets bind nothing a VAO records, the element array binding of the bound one stays.
+		pGLGen_Buffers(1, &buffer);
+		pGLBind_Buffer(GL_COPY_WRITE_BUFFER, buffer);
+		// Immutable storage still takes appended meshes through glBufferSubData with the dynamic storage bit.
+		if ( BufferStorageSupported() )
+			pGLBuffer_Storage(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_DYNAMIC_STORAGE_BIT);
+		else
+			pGLBuffer_Data(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STATIC_DRAW);
+	}
+
+	void CMeshBuffer::Reserve(GLuint& buffer, GLsizeiptr& capacity, GLsizeiptr used, GLsizeiptr needed) {
+		if ( used + needed <= capacity )
+			return;
+
+		// Doubling keeps the copies of a loading scene to a handful.
+		GLuint oldBuffer = buffer;
+		capacity = std::max(used + needed, capacity * 2);
+		Allocate(buffer, capacity);
+		pGLBind_Buffer(GL_COPY_READ_BUFFER, oldBuffer);
+		pGLCopy_Buffer_Sub_Data(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used);
+		pGLDelete_Buffers(1, &oldBuffer);
+	}
+
+	MeshRange CMeshBuffer::Add(const float* vertices, GLsizeiptr verticesBytes, const unsigned int* indices,
+							   GLuint indicesNumber) {
+		GLsizeiptr indicesBytes = indicesNumber * sizeof(unsigned int);
+		MeshRange range{ GLuint(indexBytes_ / sizeof(unsigned int)), indicesNumber, GLint(vertexBytes_ / vertexStride_) };
+
+		Reserve(vertexBuffer_, vertexCapacity_, vertexBytes_, verticesBytes);
+		pGLBind_Buffer(GL_COPY_WRITE_BUFFER, vertexBuffer_);
+		pGLBuffer_Sub_Data(GL_COPY_WRITE_BUFFER, vertexBytes_, verticesBytes, vertices);
+		vertexBytes_ += verticesBytes;
+
+		GLuint indexBuffer = indexBuffer_;
+		Reserve(indexBuffer_, indexCapacity_, indexBytes_, indicesBytes);
+		pGLBind_Buffer(GL_COPY_WRITE_BUFFER, indexBuffer_);
+		pGLBuffer_Sub_Data(GL_COPY_WRITE_BUFFER, indexBytes_, indicesBytes, indices);
+		indexBytes_ += indicesBytes;
+		if ( indexBuffer != indexBuffer_ ) {
+			pGLBind_Vertex_Array(vertexArray_);
+			pGLBind_Buffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer_);
+		}
+
+		return range;
+	}
+}
@@ -0,0 +1,284 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "Prefab.hpp"
+#include "Components/ColliderComponent.hpp"
+#include "Components/MaterialComponent.hpp"
+#include "Components/PointLightComponent.hpp"
+#include "Components/ProjectileComponent.hpp"
+#include "Components/RigidBodyComponent.hpp"
+#include "Components/TransformComponent.hpp"
+#include "Components/VertexComponent.hpp"
+#include "JsonParser.hpp"
+
+namespace GLVM::ecs
+{
+	namespace
+	{
+		using Core::JsonValue;
+
+		bool HasKey(JsonValue& object, const char* key) {
+			return object.isObject() && object.value.object->Contain(key);
+		}
+
+		void ReadFloat(JsonValue& object, const char* key, float& result) {
+			if ( !HasKey(object, key) )
+				return;
+
+			JsonValue& field = object[key];
+			if ( field.isFloat() )
+				result = static_cast<float>(field.value.fNumber);
+			else if ( field.isInterger() )
+				result = static_cast<float>(field.value.iNumber);
+		}
+
+		void ReadUnsigned(JsonValue& object, const char* key, unsigned int& result) {
+			if ( HasKey(object, key) && object[key].isInterger() )
+				result = static_cast<unsigned int>(object[key].value.iNumber);
+		}
+
+		void ReadBool(JsonValue& object, const char* key, bool& result) {
+			if ( HasKey(object, key) && object[key].isBoolean() )
+				result = object[key].value.boolean;
+		}
+
+		void ReadVec3(JsonValue& object, const char* key, vec3& result) {
+			if ( !HasKey(object, key) || !object[key].isArray() )
+				return;
+
+			JsonValue& array = object[key];
+			for ( unsigned int i = 0; i < 3 && i < array.value.array->GetSize(); ++i ) {
+				JsonValue& element = array[i];
+				if ( element.isFloat() )
+					result[i] = static_cast<float>(element.value.fNumber);
+				else if ( element.isInterger() )
+					result[i] = static_cast<float>(element.value.iNumber);
+			}
+		}
+
+		void LoadComponents(CPrefab* prefab, JsonValue& components) {
+			namespace cm = GLVM::ecs::components;
+
+			if ( HasKey(components, "transform") ) {
+				JsonValue& json = components["transform"];
+				cm::transform* transform = prefab->Add<cm::transform>();
+				float yaw = 0.0f;
+				float pitch = 0.0f;
+				ReadVec3(json, "position", transform->tPosition);
+				ReadFloat(json, "yaw", yaw);
+				ReadFloat(json, "pitch", pitch);
+				ReadFloat(json, "scale", transform->fScale);
+				ReadBool(json, "gltf", transform->gltf);
+				cm::SetRotation(*transform, cm::YawPitchRotation(yaw, pitch));
+			}
+
+			if ( HasKey(components, "rigidBody") ) {
+				JsonValue& json = components["rigidBody"];
+				cm::rigidBody* rigidBody = prefab->Add<cm::rigidBody>();
+				ReadFloat(json, "gravityTime", rigidBody->gravityTime);
+				ReadFloat(json, "mass", rigidBody->fMass_);
+				ReadBool(json, "gravity", rigidBody->bGravity_);
+				ReadVec3(json, "jump", rigidBody->jump);
+			}
+
+			if ( HasKey(components, "collider") ) {
+				cm::collider* collider = prefab->Add<cm::collider>();
+				ReadBool(components["collider"], "bullet", collider->bBullet_);
+			}
+
+			if ( HasKey(components, "mesh") ) {
+				cm::mesh* mesh = prefab->Add<cm::mesh>();
+				ReadUnsigned(components["mesh"], "handle", mesh->handle.id);
+			}
+
+			if ( HasKey(components, "material") ) {
+				JsonValue& json = components["material"];
+				cm::material* material = prefab->Add<cm::material>();
+				ReadUnsigned(json, "diffuseTexture", material->diffuseTextureID_.id);
+				ReadUnsigned(json, "specularTexture", material->specularTextureID_.id);
+				ReadVec3(json, "ambient", material->ambient);
+				ReadFloat(json, "shininess", material->shininess);
+			}
+
+			if ( HasKey(components, "projectile") ) {
+				JsonValue& json = components["projectile"];
+				cm::projectile* projectile = prefab->Add<cm::projectile>();
+				ReadFloat(json, "damage", projectile->fDamage_);
+				ReadFloat(json, "speed", projectile->fSpeed_);
+				ReadFloat(json, "range", projectile->fFlying_Range_);
+			}
+
+			if ( HasKey(components, "pointLight") ) {
+				JsonValue& json = components["pointLight"];
+				cm::pointLight* pointLight = prefab->Add<cm::pointLight>();
+				ReadVec3(json, "ambient", pointLight->ambient);
+				ReadVec3(json, "diffuse", pointLight->diffuse);
+				ReadVec3(json, "specular", pointLight->specular);
+				ReadFloat(json, "constant", pointLight->constant);
+				ReadFloat(json, "linear", pointLight->linear);
+				ReadFloat(json, "quadratic", pointLight->quadratic);
+			}
+		}
+	}
+
+	CPrefabRegistry* CPrefabRegistry::pInstance_ = nullptr;
+	std::mutex CPrefabRegistry::Mutex_;
+
+	CPrefab::CPrefab(const CPrefab& prefab) : name_(prefab.name_) {
+		for ( unsigned int i = 0; i < prefab.components_.GetSize(); ++i )
+			components_.Push(prefab.components_[i]->Clone());
+	}
+
+	CPrefab::~CPrefab() {
+		for ( unsigned int i = 0; i < components_.GetSize(); ++i )
+			delete components_[i];
+	}
+
+	CPrefabRegistry::~CPrefabRegistry() {
+		for ( unsigned int i = 0; i < prefabs_.GetSize(); ++i )
+			delete prefabs_[i];
+	}
+
+	CPrefabRegistry* CPrefabRegistry::GetInstance() {
+		std::lock_guard<std::mutex> lock(Mutex_);
+		if ( pInstance_ == nullptr ) {
+			pInstance_ = new CPrefabRegistry();
+		}
+		return pInstance_;
+	}
+
+	CPrefab* CPrefabRegistry::Register(const char* name) {
+		CPrefab* prefab = Get(name);
+		if ( prefab != nullptr )
+			return prefab;
+
+		prefab = new CPrefab(name);
+		prefabs_.Push(prefab);
+		return prefab;
+	}
+
+	CPrefab* CPrefabRegistry::Get(const char* name) {
+		for ( unsigned int i = 0; i < prefabs_.GetSize(); ++i ) {
+			if ( prefabs_[i]->GetName() == name )
+				return prefabs_[i];
+		}
+
+		return nullptr;
+	}
+
+	bool CPrefabRegistry::LoadFromFile(const char* path) {
+		std::ifstream file(path);
+		if ( !file.good() ) {
+			std::cout << "Error of reading prefab file: " << path << std::endl;
+			return false;
+		}
+		file.close();
+
+		Core::CJsonParser parser;
+		parser.ReadFile(path);
+		parser.Parse();
+
+		JsonValue* root = parser.GetRoot();
+		if ( root == nullptr || !HasKey(*root, "prefabs") || !(*root)["prefabs"].isArray() ) {
+			std::cout << "Prefab file has no \"prefabs\" array: " << path << std::endl;
+			return false;
+		}
+
+		JsonValue& prefabs = (*root)["prefabs"];
+		for ( unsigned int i = 0; i < prefabs.value.array->GetSize(); ++i ) {
+			JsonValue& entry = prefabs[i];
+			if ( !HasKey(entry, "name") || !entry["name"].isString() )
+				continue;
+
+			CPrefab* prefab = Register(entry["name"].value.string->c_str());
+			if ( HasKey(entry, "components") )
+				LoadComponents(prefab, entry["components"]);
+		}
+
+		return true;
+	}
+
+	core::vector<Entity> CPrefabRegistry::Instantiate(const CPrefab& prefab, unsigned int count) {
+		EntityManager* entityManager = EntityManager::GetInstance();
+		ComponentManager* componentManager = ComponentManager::GetInstance();
+
+		core::vector<Entity> entities;
+		entities.Reserve(count);
+		for ( unsigned int i = 0; i < count; ++i )
+			entities.Push(entityManager->CreateEntity());
+
+		for ( unsigned int i = 0; i < prefab.GetComponentsNumber(); ++i )
+			prefab.GetComponentRecord(i)->Instantiate(componentManager, entities.GetVectorContainer(), count);
+
+		return entities;
+	}
+
+	void CPrefabRegistry::Reset(const CPrefab& prefab, const Entity* entities, unsigned int count) {
+		ComponentManager* componentManager = ComponentManager::GetInstance();
+		for ( unsigned int i = 0; i < prefab.GetComponentsNumber(); ++i )
+			prefab.GetComponentRecord(i)->Instantiate(componentManager, entities, count);
+	}
+
+	Entity CPrefabPool::Acquire() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		Entity entity;
+		if ( free_.GetSize() > 0 ) {
+			entity = free_.GetHead();
+			free_.Pop();
+			ComponentManager::GetInstance()->EnableEntity(entity);
+			CPrefabRegistry::GetInstance()->Reset(prefab_, &entity, 1);
+		} else {
+			entity = CPrefabRegistry::GetInstance()->Instantiate(prefab_)[0];
+			++created_;
+		}
+
+		if ( entity >= activeIndex_.GetSize() ) {
+			unsigned int oldSize = activeIndex_.GetSize();
+			activeIndex_.Resize(entity + 1);
+			for ( unsigned int i = oldSize; i < activeIndex_.GetSize(); ++i )
+				activeIndex_[i] = kNotActive;
+		}
+		activeIndex_[entity] = active_.GetSize();
+		active_.Push(entity);
+		return entity;
+	}
+
+	void CPrefabPool::Release(Entity entity) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if ( entity >= activeIndex_.GetSize() || activeIndex_[entity] == kNotActive )
+			return;
+
+		// Swap with the last active entity, the order of active_ does not matter.
+		unsigned int index = activeIndex_[entity];
+		Entity last = active_.GetHead();
+		active_[index] = last;
+		activeIndex_[last] = index;
+		active_.Pop();
+		activeIndex_[entity] = kNotActive;
+
+		ComponentManager::GetInstance()->DisableEntity(entity);
+		free_.Push(entity);
+	}
+
+	core::vector<Entity> CPrefabPool::GetActive() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return active_;
+	}
+
+	unsigned int CPrefabPool::GetActiveNumber() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return active_.GetSize();
+	}
+
+	unsigned int CPrefabPool::GetFreeNumber() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return free_.GetSize();
+	}
+
+	unsigned int CPrefabPool::GetCreatedNumber() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return created_;
+	}
+}
@@ -4,6 +4,8 @@
 // License: http://opensource.org/licenses/MIT
 
 #include "ProceduralMusicSystem.hpp"
+#include "FastMath.hpp"
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <iostream>
@@ -62,36 +64,53 @@ namespace GLVM::core::Sound
         std::vector<int16_t> audioData(numSamples);
         
         const float amplitude = 16384.0f * settings.volume; // Use 16-bit range
-        const float pi2 = 2.0f * 3.14159265359f;
+        const float fadeSamples = sampleRate * 0.01f;
         
-        for (int i = 0; i < numSamples; ++i) {
-            float t = static_cast<float>(i) / sampleRate;
-            float sample = 0.0f;
+        // Sine based waveforms are evaluated eight samples per call. The phase is
+        // wrapped to a single turn so the polynomial stays in its accurate range.
+        float angles[8], sines[8], cosines[8];
+        
+        for (int block = 0; block < numSamples; block += 8) {
+            int blockSize = std::min(8, numSamples - block);
             
-            switch (settings.waveform) {
-                case 0: // Sine wave
-                    sample = std::sin(pi2 * frequency * t);
-                    break;
-                case 1: // Square wave
-                    sample = (std::sin(pi2 * frequency * t) > 0) ? 1.0f : -1.0f;
-                    break;
-                case 2: // Triangle wave
-                    sample = (2.0f / 3.14159265359f) * std::asin(std::sin(pi2 * frequency * t));
-                    break;
-                case 3: // Sawtooth wave
-                    sample = 2.0f * (t * frequency - std::floor(t * frequency + 0.5f));
-                    break;
+            if (settings.waveform <= 2) {
+                for (int lane = 0; lane < 8; ++lane) {
+                    float t = static_cast<float>(block + lane) / sampleRate;
+                    angles[lane] = math::kTwoPi * math::WrapTurns(frequency * t);
+                }
+                math::sincos8(angles, sines, cosines);
             }
             
-            // Apply envelope (fade in/out to avoid clicks)
-            float envelope = 1.0f;
-            if (i < sampleRate * 0.01f) { // 10ms fade in
-                envelope = static_cast<float>(i) / (sampleRate * 0.01f);
-            } else if (i > numSamples - sampleRate * 0.01f) { // 10ms fade out
-                envelope = static_cast<float>(numSamples - i) / (sampleRate * 0.01f);
+            for (int lane = 0; lane < blockSize; ++lane) {
+                int i = block + lane;
+                float t = static_cast<float>(i) / sampleRate;
+                float sample = 0.0f;
+                
+                switch (settings.waveform) {
+                    case 0: // Sine wave
+                        sample = sines[lane];
+                        break;
+                    case 1: // Square wave
+                        sample = (sines[lane] > 0) ? 1.0f : -1.0f;
+                        break;
+                    case 2: // Triangle wave
+                        sample = (2.0f / 3.14159265359f) * std::asin(std::clamp(sines[lane], -1.0f, 1.0f));
+                        break;
+                    case 3: // Sawtooth wave
+                        sample = 2.0f * (t * frequency - std::floor(t * frequency + 0.5f));
+                        break;
+                }
+                
+                // Apply envelope (fade in/out to avoid clicks)
+                float envelope = 1.0f;
+                if (i < fadeSamples) { // 10ms fade in
+                    envelope = static_cast<float>(i) / fadeSamples;
+                } else if (i > numSamples - fadeSamples) { // 10ms fade out
+                    envelope = static_cast<float>(numSamples - i) / fadeSamples;
+                }
+                
+                audioData[i] = static_cast<int16_t>(sample * amplitude * envelope);
             }
-            
-            audioData[i] = static_cast<int16_t>(sample * amplitude * envelope);
         }
         
         return audioData;
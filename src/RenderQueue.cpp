@@ -0,0 +1,57 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "RenderQueue.hpp"
+#include "Broadphase.hpp"
+#include <cstring>
+
+namespace GLVM::core
+{
+	void CRenderQueue::Push(uint64_t key, unsigned int value) {
+		PushGrowing(items_, RenderItem{ key, value });
+	}
+
+	void CRenderQueue::Sort() {
+		unsigned int size = items_.GetSize();
+		if ( size < 2 )
+			return;
+
+		// One sweep counts all eight bytes.
+		unsigned int histograms[8][256] = {};
+		RenderItem* items = items_.GetVectorContainer();
+		for ( unsigned int i = 0; i < size; ++i ) {
+			uint64_t key = items[i].key;
+			for ( unsigned int digit = 0; digit < 8; ++digit )
+				++histograms[digit][(key >> (digit * 8)) & 0xFF];
+		}
+
+		scratch_.Resize(size);
+		RenderItem* source = items;
+		RenderItem* destination = scratch_.GetVectorContainer();
+		for ( unsigned int digit = 0; digit < 8; ++digit ) {
+			unsigned int shift = digit * 8;
+			unsigned int* histogram = histograms[digit];
+			// Every key has the same byte here, a pass would not move anything.
+			if ( histogram[(source[0].key >> shift) & 0xFF] == size )
+				continue;
+
+			unsigned int offset = 0;
+			for ( unsigned int bucket = 0; bucket < 256; ++bucket ) {
+				unsigned int count = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += count;
+			}
+			for ( unsigned int i = 0; i < size; ++i )
+				destination[histogram[(source[i].key >> shift) & 0xFF]++] = source[i];
+
+			RenderItem* swap = source;
+			source = destination;
+			destination = swap;
+		}
+
+		if ( source != items )
+			std::memcpy(items, source, size * sizeof(RenderItem));
+	}
+}
@@ -6,6 +6,7 @@
 #include "ShaderProgram.hpp"
 #include "GLPointer.h"
 #include <GL/gl.h>
+#include <vector>
 
 #define ARRAY_INFO_LOG_RANGE 1024
 
@@ -14,50 +15,203 @@ void Shader::Use()
 {
 	pGLUse_Program(iID);
 }
+///< Uniform table, filled once after link
+uint64_t Shader::HashName(const char* name)
+{
+	// FNV-1a, 64 bits leave no collision among the few hundred names of a program.
+	uint64_t hash = 14695981039346656037ull;
+	for ( ; *name != '\0'; ++name ) {
+		hash ^= static_cast<unsigned char>(*name);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+void Shader::ResolveUniforms()
+{
+	GLint uniformsNumber = 0;
+	GLint maxNameLength = 0;
+	pGLGet_Programiv(iID, GL_ACTIVE_UNIFORMS, &uniformsNumber);
+	pGLGet_Programiv(iID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	if ( uniformsNumber <= 0 )
+		return;
+
+	// Members of uniform blocks have no location, their buffers are filled directly.
+	std::vector<GLuint> indices(uniformsNumber);
+	std::vector<GLint> blockIndices(uniformsNumber);
+	for ( GLint i = 0; i < uniformsNumber; ++i )
+		indices[i] = i;
+	pGLGet_Active_Uniformsiv(iID, uniformsNumber, indices.data(), GL_UNIFORM_BLOCK_INDEX, blockIndices.data());
+
+	std::string buffer(maxNameLength > 0 ? maxNameLength : 1, '\0');
+	for ( GLint i = 0; i < uniformsNumber; ++i ) {
+		if ( blockIndices[i] != -1 )
+			continue;
+
+		GLsizei nameLength = 0;
+		GLint arraySize = 0;
+		GLenum type = 0;
+		pGLGet_Active_Uniform(iID, i, buffer.size(), &nameLength, &arraySize, &type, buffer.data());
+		std::string name(buffer.data(), nameLength);
+		GLint location = pGLGet_Uniform_Location(iID, name.c_str());
+		++callStats.locationQueries;
+		uniformLocations_[HashName(name.c_str())] = location;
+
+		// An array of plain type is listed once as "name[0]": its bare name and every
+		// other element get an entry too. Arrays of structs list each member already.
+		if ( name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0 ) {
+			std::string base = name.substr(0, name.size() - 3);
+			uniformLocations_[HashName(base.c_str())] = location;
+			for ( GLint element = 1; element < arraySize; ++element ) {
+				std::string elementName = base + "[" + std::to_string(element) + "]";
+				uniformLocations_[HashName(elementName.c_str())] = pGLGet_Uniform_Location(iID, elementName.c_str());
+				++callStats.locationQueries;
+			}
+		}
+	}
+}
+
+void Shader::InsertDefines(std::string& code, const char* defines)
+{
+	if ( defines == nullptr || code.empty() )
+		return;
+
+	// #version has to stay the first line, even when it is the only one.
+	if ( code.compare(0, 8, "#version") != 0 ) {
+		code.insert(0, std::string(defines) + "\n");
+		return;
+	}
+	std::size_t lineEnd = code.find('\n');
+	if ( lineEnd == std::string::npos )
+		code.append("\n").append(defines).append("\n");
+	else
+		code.insert(lineEnd + 1, std::string(defines) + "\n");
+}
+
+void Shader::BindUniformBlock(const char* blockName, GLuint binding) const
+{
+	GLuint blockIndex = pGLGet_Uniform_Block_Index(iID, blockName);
+	if ( blockIndex != GL_INVALID_INDEX )
+		pGLUniform_Block_Binding(iID, blockIndex, binding);
+}
+
+UniformHandle Shader::GetUniform(const char* name) const
+{
+	auto found = uniformLocations_.find(HashName(name));
+	return found != uniformLocations_.end() ? UniformHandle{ found->second } : UniformHandle{};
+}
+
 ///< Uniform functions
 void Shader::SetBool(const std::string& name, bool value) const
 {
-	pGLUniform1i(pGLGet_Uniform_Location(iID, name.c_str()), (int)value);
+	SetBool(GetUniform(name), value);
 }
 void Shader::SetInt(const std::string& name, int value) const
 {
-	pGLUniform1i(pGLGet_Uniform_Location(iID, name.c_str()), value);
+	SetInt(GetUniform(name), value);
 }
 void Shader::SetInt(const std::string& name, GLsizei count, const GLint* value) const
 {
-	pGLUniform1iv(pGLGet_Uniform_Location(iID, name.c_str()), count, value);
+	SetInt(GetUniform(name), count, value);
 }
 void Shader::SetFloat(const std::string& name, float value) const
 {
-	pGLUniform1f(pGLGet_Uniform_Location(iID, name.c_str()), value);
+	SetFloat(GetUniform(name), value);
 }
 void Shader::SetVec3(const std::string &name, float x, float y, float z) const
 { 
-	pGLUniform3f(pGLGet_Uniform_Location(iID, name.c_str()), x, y, z);
+	SetVec3(GetUniform(name), x, y, z);
 }
 void Shader::SetVec3(const std::string &name, const vec3& vector) const
 { 
-	pGLUniform3fv(pGLGet_Uniform_Location(iID, name.c_str()), 1, &vector[0]);
+	SetVec3(GetUniform(name), vector);
 }
 void Shader::SetVec4(const std::string &name, float x, float y, float z, float w) const {
-	pGLUniform4f(pGLGet_Uniform_Location(iID, name.c_str()), x, y, z, w);
+	SetVec4(GetUniform(name), x, y, z, w);
 }
 void Shader::SetVec4(const std::string &name, int x, int y, int z, int w) const {
-	pGLUniform4i(pGLGet_Uniform_Location(iID, name.c_str()), x, y, z, w);
+	SetVec4(GetUniform(name), x, y, z, w);
 }
 void Shader::SetUniformID(const char* _uniformIdentificator, int _id)
 {
-	pGLUniform1i(pGLGet_Uniform_Location(iID, _uniformIdentificator), _id);
+	SetInt(GetUniform(_uniformIdentificator), _id);
 }
 
 void Shader::SetMat4(const std::string &name, mat4 &mat) const
 {
-	pGLUniform_Matrix4fv(pGLGet_Uniform_Location(iID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+	SetMat4(GetUniform(name), mat);
 }
 
 void Shader::SetMat4(const std::string &name, unsigned int matrixNumber, mat4 &mat) const
 {
-	pGLUniform_Matrix4fv(pGLGet_Uniform_Location(iID, name.c_str()), matrixNumber, GL_FALSE, &mat[0][0]);
+	SetMat4(GetUniform(name), matrixNumber, mat);
+}
+
+///< Pre-resolved uniform functions, location -1 is skipped as the driver would ignore it
+void Shader::SetBool(UniformHandle uniform, bool value) const
+{
+	SetInt(uniform, (int)value);
+}
+void Shader::SetInt(UniformHandle uniform, int value) const
+{
+	if ( uniform.location < 0 ) return;
+	pGLUniform1i(uniform.location, value);
+	++callStats.uploads;
+	callStats.uploadBytes += sizeof(GLint);
+}
+void Shader::SetInt(UniformHandle uniform, GLsizei count, const GLint* value) const
+{
+	if ( uniform.location < 0 ) return;
+	pGLUniform1iv(uniform.location, count, value);
+	++callStats.uploads;
+	callStats.uploadBytes += count * sizeof(GLint);
+}
+void Shader::SetFloat(UniformHandle uniform, float value) const
+{
+	if ( uniform.location < 0 ) return;
+	pGLUniform1f(uniform.location, value);
+	++callStats.uploads;
+	callStats.uploadBytes += sizeof(GLfloat);
+}
+void Shader::SetVec3(UniformHandle uniform, float x, float y, float z) const
+{
+	if ( uniform.location < 0 ) return;
+	pGLUniform3f(uniform.location, x, y, z);
+	++callStats.uploads;
+	callStats.uploadBytes += 3 * sizeof(GLfloat);
+}
+void Shader::SetVec3(UniformHandle uniform, const vec3& vector) const
+{
+	if ( uniform.location < 0 ) return;
+	pGLUniform3fv(uniform.location, 1, &vector[0]);
+	++callStats.uploads;
+	callStats.uploadBytes += 3 * sizeof(GLfloat);
+}
+void Shader::SetVec4(UniformHandle uniform, float x, float y, float z, float w) const
+{
+	if ( uniform.location < 0 ) return;
+	pGLUniform4f(uniform.location, x, y, z, w);
+	++callStats.uploads;
+	callStats.uploadBytes += 4 * sizeof(GLfloat);
+}
+void Shader::SetVec4(UniformHandle uniform, int x, int y, int z, int w) const
+{
+	if ( uniform.location < 0 ) return;
+	pGLUniform4i(uniform.location, x, y, z, w);
+	++callStats.uploads;
+	callStats.uploadBytes += 4 * sizeof(GLint);
+}
+void Shader::SetMat4(UniformHandle uniform, const mat4& mat) const
+{
+	SetMat4(uniform, 1, mat);
+}
+void Shader::SetMat4(UniformHandle uniform, unsigned int matrixNumber, const mat4& mat) const
+{
+	if ( uniform.location < 0 ) return;
+	pGLUniform_Matrix4fv(uniform.location, matrixNumber, GL_FALSE, &mat[0][0]);
+	++callStats.uploads;
+	callStats.uploadBytes += matrixNumber * sizeof(mat4);
 }
 
 // void Shader::SetMat4(const std::string &name, glm::mat4 &mat) const
@@ -0,0 +1,130 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "SimdBounds.hpp"
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define GLVM_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace GLVM::core
+{
+	namespace
+	{
+		typedef unsigned int (*OverlapKernel)(const AABB& box, const CBoundsSoA& bounds, unsigned int first);
+
+		unsigned int OverlapMask8Scalar(const AABB& box, const CBoundsSoA& bounds, unsigned int first) {
+			const float* minX = bounds.GetMinX() + first;
+			const float* minY = bounds.GetMinY() + first;
+			const float* minZ = bounds.GetMinZ() + first;
+			const float* maxX = bounds.GetMaxX() + first;
+			const float* maxY = bounds.GetMaxY() + first;
+			const float* maxZ = bounds.GetMaxZ() + first;
+
+			unsigned int mask = 0;
+			for ( unsigned int i = 0; i < CBoundsSoA::kLanes; ++i ) {
+				bool overlap = box.max[0] > minX[i] && box.min[0] < maxX[i] &&
+							   box.max[1] > minY[i] && box.min[1] < maxY[i] &&
+							   box.max[2] > minZ[i] && box.min[2] < maxZ[i];
+				mask |= static_cast<unsigned int>(overlap) << i;
+			}
+			return mask;
+		}
+
+#ifdef GLVM_SIMD_X86
+		__attribute__((target("sse2")))
+		unsigned int OverlapMask4Sse(const AABB& box, const CBoundsSoA& bounds, unsigned int first) {
+			__m128 overlap = _mm_and_ps(_mm_cmpgt_ps(_mm_set1_ps(box.max[0]), _mm_loadu_ps(bounds.GetMinX() + first)),
+										_mm_cmplt_ps(_mm_set1_ps(box.min[0]), _mm_loadu_ps(bounds.GetMaxX() + first)));
+			overlap = _mm_and_ps(overlap, _mm_cmpgt_ps(_mm_set1_ps(box.max[1]), _mm_loadu_ps(bounds.GetMinY() + first)));
+			overlap = _mm_and_ps(overlap, _mm_cmplt_ps(_mm_set1_ps(box.min[1]), _mm_loadu_ps(bounds.GetMaxY() + first)));
+			overlap = _mm_and_ps(overlap, _mm_cmpgt_ps(_mm_set1_ps(box.max[2]), _mm_loadu_ps(bounds.GetMinZ() + first)));
+			overlap = _mm_and_ps(overlap, _mm_cmplt_ps(_mm_set1_ps(box.min[2]), _mm_loadu_ps(bounds.GetMaxZ() + first)));
+			return static_cast<unsigned int>(_mm_movemask_ps(overlap));
+		}
+
+		__attribute__((target("sse2")))
+		unsigned int OverlapMask8Sse(const AABB& box, const CBoundsSoA& bounds, unsigned int first) {
+			return OverlapMask4Sse(box, bounds, first) | OverlapMask4Sse(box, bounds, first + 4) << 4;
+		}
+
+		__attribute__((target("avx2")))
+		unsigned int OverlapMask8Avx2(const AABB& box, const CBoundsSoA& bounds, unsigned int first) {
+			__m256 overlap = _mm256_and_ps(
+				_mm256_cmp_ps(_mm256_set1_ps(box.max[0]), _mm256_loadu_ps(bounds.GetMinX() + first), _CMP_GT_OQ),
+				_mm256_cmp_ps(_mm256_set1_ps(box.min[0]), _mm256_loadu_ps(bounds.GetMaxX() + first), _CMP_LT_OQ));
+			overlap = _mm256_and_ps(overlap,
+				_mm256_cmp_ps(_mm256_set1_ps(box.max[1]), _mm256_loadu_ps(bounds.GetMinY() + first), _CMP_GT_OQ));
+			overlap = _mm256_and_ps(overlap,
+				_mm256_cmp_ps(_mm256_set1_ps(box.min[1]), _mm256_loadu_ps(bounds.GetMaxY() + first), _CMP_LT_OQ));
+			overlap = _mm256_and_ps(overlap,
+				_mm256_cmp_ps(_mm256_set1_ps(box.max[2]), _mm256_loadu_ps(bounds.GetMinZ() + first), _CMP_GT_OQ));
+			overlap = _mm256_and_ps(overlap,
+				_mm256_cmp_ps(_mm256_set1_ps(box.min[2]), _mm256_loadu_ps(bounds.GetMaxZ() + first), _CMP_LT_OQ));
+			return static_cast<unsigned int>(_mm256_movemask_ps(overlap));
+		}
+#endif
+
+		ESimdLevel DetectSimdLevel() {
+#ifdef GLVM_SIMD_X86
+			__builtin_cpu_init();
+			if ( __builtin_cpu_supports("avx2") )
+				return eSIMD_AVX2;
+			if ( __builtin_cpu_supports("sse2") )
+				return eSIMD_SSE;
+#endif
+			return eSIMD_SCALAR;
+		}
+
+		OverlapKernel KernelFor(ESimdLevel level) {
+#ifdef GLVM_SIMD_X86
+			if ( level == eSIMD_AVX2 )
+				return OverlapMask8Avx2;
+			if ( level == eSIMD_SSE )
+				return OverlapMask8Sse;
+#endif
+			(void)level;
+			return OverlapMask8Scalar;
+		}
+
+		const ESimdLevel kDetectedSimdLevel = DetectSimdLevel();
+		ESimdLevel simdLevel = kDetectedSimdLevel;
+		OverlapKernel overlapKernel = KernelFor(kDetectedSimdLevel);
+	}
+
+	void CBoundsSoA::Resize(unsigned int size) {
+		size_ = size;
+		minX_.Resize(size + kLanes); minY_.Resize(size + kLanes); minZ_.Resize(size + kLanes);
+		maxX_.Resize(size + kLanes); maxY_.Resize(size + kLanes); maxZ_.Resize(size + kLanes);
+
+		// Inverted boxes in the padding fail every comparison.
+		const float kHighest = std::numeric_limits<float>::max();
+		const float kLowest = std::numeric_limits<float>::lowest();
+		for ( unsigned int i = size; i < size + kLanes; ++i ) {
+			minX_[i] = kHighest; minY_[i] = kHighest; minZ_[i] = kHighest;
+			maxX_[i] = kLowest;  maxY_[i] = kLowest;  maxZ_[i] = kLowest;
+		}
+	}
+
+	void CBoundsSoA::Set(unsigned int index, const AABB& box) {
+		minX_[index] = box.min[0]; minY_[index] = box.min[1]; minZ_[index] = box.min[2];
+		maxX_[index] = box.max[0]; maxY_[index] = box.max[1]; maxZ_[index] = box.max[2];
+	}
+
+	ESimdLevel GetSimdLevel() {
+		return simdLevel;
+	}
+
+	void SetSimdLevel(ESimdLevel level) {
+		simdLevel = level < kDetectedSimdLevel ? level : kDetectedSimdLevel;
+		overlapKernel = KernelFor(simdLevel);
+	}
+
+	unsigned int OverlapMask8(const AABB& box, const CBoundsSoA& bounds, unsigned int first) {
+		return overlapKernel(box, bounds, first);
+	}
+}
@@ -0,0 +1,122 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "StreamingBuffer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace GLVM::core
+{
+	namespace
+	{
+		constexpr GLuint64 kFenceWaitTimeout = 1000000;   ///< Nanoseconds per wait, retried until the fence signals.
+	}
+
+	bool BufferStorageSupported() {
+		// Asked once, every buffer lives in the same context.
+		static const bool supported = pGLBuffer_Storage != nullptr && GLSupports(4, 4, "GL_ARB_buffer_storage");
+		return supported;
+	}
+
+	StreamingBufferStats CStreamingBuffer::stats;
+
+	CStreamingBuffer::CStreamingBuffer(GLenum target, GLsizeiptr regionSize, GLsizeiptr alignment)
+		: target_(target), regionSize_((regionSize + alignment - 1) / alignment * alignment), alignment_(alignment) {
+		Allocate();
+	}
+
+	CStreamingBuffer::~CStreamingBuffer() {
+		Release();
+	}
+
+	void CStreamingBuffer::Allocate() {
+		GLsizeiptr size = regionSize_ * kRegionsNumber;
+		pGLGen_Buffers(1, &buffer_);
+		pGLBind_Buffer(target_, buffer_);
+		if ( BufferStorageSupported() ) {
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			pGLBuffer_Storage(target_, size, nullptr, flags);
+			mapping_ = static_cast<unsigned char*>(pGLMap_Buffer_Range(target_, 0, size, flags));
+		} else {
+			pGLBuffer_Data(target_, size, nullptr, GL_STREAM_DRAW);
+		}
+		++allocations_;
+		++stats.allocations;
+	}
+
+	void CStreamingBuffer::Release() {
+		for ( GLsync& fence : fences_ ) {
+			if ( fence != nullptr )
+				pGLDelete_Sync(fence);
+			fence = nullptr;
+		}
+		if ( mapping_ != nullptr ) {
+			pGLBind_Buffer(target_, buffer_);
+			pGLUnmap_Buffer(target_);
+			mapping_ = nullptr;
+		}
+		// Draws already queued keep reading the old storage, GL frees it after them.
+		pGLDelete_Buffers(1, &buffer_);
+		buffer_ = 0;
+	}
+
+	GLintptr CStreamingBuffer::Write(const void* data, GLsizeiptr size, GLsizeiptr span) {
+		GLsizeiptr used = std::max(size, span);
+		GLintptr start = (head_ + alignment_ - 1) / alignment_ * alignment_;
+		if ( start + used > regionSize_ ) {
+			// Doubling keeps the reallocations of a growing scene to a handful.
+			regionSize_ = (std::max(used, regionSize_ * 2) + alignment_ - 1) / alignment_ * alignment_;
+			Release();
+			Allocate();
+			region_ = 0;
+			start = 0;
+		}
+
+		GLintptr offset = region_ * regionSize_ + start;
+		if ( size > 0 ) {
+			if ( mapping_ != nullptr ) {
+				std::memcpy(mapping_ + offset, data, size);
+			} else {
+				// The region is fenced, nothing in flight reads it, so the driver need not wait either.
+				pGLBind_Buffer(target_, buffer_);
+				void* destination = pGLMap_Buffer_Range(target_, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+														GL_MAP_UNSYNCHRONIZED_BIT);
+				std::memcpy(destination, data, size);
+				pGLUnmap_Buffer(target_);
+			}
+			stats.writtenBytes += size;
+		}
+		head_ = start + used;
+		return offset;
+	}
+
+	void CStreamingBuffer::NextFrame() {
+		// A frame that wrote nothing keeps its region for the next one.
+		if ( head_ == 0 )
+			return;
+
+		fences_[region_] = pGLFence_Sync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		region_ = (region_ + 1) % kRegionsNumber;
+		head_ = 0;
+
+		GLsync fence = fences_[region_];
+		if ( fence == nullptr )
+			return;
+
+		GLenum status = pGLClient_Wait_Sync(fence, 0, 0);
+		if ( status == GL_TIMEOUT_EXPIRED ) {
+			++stats.stalls;
+			auto waitStart = std::chrono::steady_clock::now();
+			do
+				status = pGLClient_Wait_Sync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceWaitTimeout);
+			while ( status == GL_TIMEOUT_EXPIRED );
+			stats.stallNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - waitStart).count();
+		}
+		pGLDelete_Sync(fence);
+		fences_[region_] = nullptr;
+	}
+}
@@ -6,6 +6,7 @@
 #include "Systems/CameraSystem.hpp"
 #include "Components/TransformComponent.hpp"
 #include "Components/ViewComponent.hpp"
+#include "FastMath.hpp"
 #include "VertexMath.hpp"
 
 namespace GLVM::ecs
@@ -59,10 +60,14 @@ namespace GLVM::ecs
         if(fPitch < -89.0f)
             fPitch = -89.0f;
 
+        float sinYaw, cosYaw, sinPitch, cosPitch;
+        core::math::sincosDegrees(fYaw, sinYaw, cosYaw);
+        core::math::sincosDegrees(fPitch, sinPitch, cosPitch);
+
         Vector<float, 3> front;
-        front[0] = std::cos(Radians(fYaw)) * std::cos(Radians(fPitch));
-        front[1] = std::sin(Radians(fPitch));
-        front[2] = std::sin(Radians(fYaw)) * std::cos(Radians(fPitch));
+        front[0] = cosYaw * cosPitch;
+        front[1] = sinPitch;
+        front[2] = sinYaw * cosPitch;
         cameraComponent.forward = Normalize(front);
 
 //		std::cout << "x: " << front[0] << " z: " << front[2] << std::endl;
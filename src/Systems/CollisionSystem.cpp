@@ -16,24 +16,20 @@
 #include "Components/RigidBodyComponent.hpp"
 #include "Components/ViewComponent.hpp"
 #include "EventsStack.hpp"
+#include "Query.hpp"
 #include "Vector.hpp"
 #include "VertexMath.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
 
 namespace GLVM::ecs
 {
 	bool CCollisionSystem::BoxCollider(vec3 backtrackingPosition, vec3 comparedPosition,
 		                               float backtrackingScale, float comparedScale)
 	{
-        if(backtrackingPosition[0] + backtrackingScale  > comparedPosition[0] - comparedScale &&
-           backtrackingPosition[0] - backtrackingScale  < comparedPosition[0] + comparedScale &&
-           backtrackingPosition[1] + backtrackingScale  > comparedPosition[1] - comparedScale &&
-           backtrackingPosition[1] - backtrackingScale  < comparedPosition[1] + comparedScale &&
-           backtrackingPosition[2] + backtrackingScale  > comparedPosition[2] - comparedScale &&
-           backtrackingPosition[2] - backtrackingScale  < comparedPosition[2] + comparedScale) {
-				return true;
-		}
-        
-		return false;
+        return Overlaps(AABBFromCenter(backtrackingPosition, backtrackingScale),
+						AABBFromCenter(comparedPosition, comparedScale));
 	}
 
     bool CCollisionSystem::UpperActorCheck(vec3 backtrackingPosition, vec3 comparedPosition,
@@ -46,94 +42,304 @@ namespace GLVM::ecs
         return false;
     }
 
+	/*! Time of impact of two boxes moving along their step, in the frame of the
+	 *  compared box: the backtracking center travels the relative displacement
+	 *  through the compared box grown by the backtracking half size. A thin
+	 *  target is found however far the bullet moved inside one step. */
+	bool CCollisionSystem::SweepTest(unsigned int backtracking, unsigned int compared,
+									 const core::vector<float>& halfScales, float& timeOfImpact) const {
+		const vec3& start = sweepStarts_[backtracking];
+		const vec3& a = sweepDeltas_[backtracking];
+		const vec3& b = sweepDeltas_[compared];
+		vec3 delta(a[0] - b[0], a[1] - b[1], a[2] - b[2]);
+		AABB target = AABBFromCenter(sweepStarts_[compared], halfScales[compared] + halfScales[backtracking]);
+
+		if ( delta[0] == 0.0f && delta[1] == 0.0f && delta[2] == 0.0f ) {
+			timeOfImpact = 0.0f;
+			return target.min[0] < start[0] && start[0] < target.max[0] &&
+				   target.min[1] < start[1] && start[1] < target.max[1] &&
+				   target.min[2] < start[2] && start[2] < target.max[2];
+		}
+
+		return IntersectSegmentAABB(start, delta, target, timeOfImpact);
+	}
+
+	/// Axis of least overlap of the two boxes where the contact was found, pointing from body to other.
+	void CCollisionSystem::Penetration(unsigned int body, unsigned int other, const core::vector<float>& halfScales,
+									   float timeOfImpact, vec3& normal, float& depth) const {
+		depth = -1.0f;
+		for ( unsigned int axis = 0; axis < 3; ++axis ) {
+			float a = sweepStarts_[body][axis] + sweepDeltas_[body][axis] * timeOfImpact;
+			float b = sweepStarts_[other][axis] + sweepDeltas_[other][axis] * timeOfImpact;
+			float overlap = Max(halfScales[body] + halfScales[other] - std::abs(b - a), 0.0f);
+			if ( depth < 0.0f || overlap < depth ) {
+				depth = overlap;
+				normal = vec3(0.0f, 0.0f, 0.0f);
+				normal[axis] = b < a ? -1.0f : 1.0f;
+			}
+		}
+	}
+
+	/// One manifold per touching pair; pairs skipped because both bodies rest keep last step's.
+	void CCollisionSystem::CacheContacts(core::vector<CollisionQuery::Row>& bodies, const core::vector<float>& halfScales) {
+		contactCache_.Begin();
+		Entity lastEntity = 0;
+		for ( unsigned int i = 0; i < bodies.GetSize(); ++i )
+			lastEntity = std::max(lastEntity, bodies[i].entity);
+
+		restingByEntity_.Resize(0);
+		restingByEntity_.Resize(bodies.GetSize() > 0 ? lastEntity + 1 : 0);
+		for ( unsigned int i = 0; i < bodies.GetSize(); ++i )
+			restingByEntity_[bodies[i].entity] = !active_[i];
+
+		// Both orders of a pair are tested, the lower entity records it.
+		for ( unsigned int i = 0; i < contacts_.GetSize(); ++i ) {
+			const Contact& contact = contacts_[i];
+			Entity first = bodies[contact.body].entity;
+			Entity second = bodies[contact.other].entity;
+			if ( first > second )
+				continue;
+
+			vec3 normal;
+			float depth;
+			Penetration(contact.body, contact.other, halfScales, contact.timeOfImpact, normal, depth);
+			contactCache_.Add(first, second, normal, depth);
+		}
+		contactCache_.End(restingByEntity_);
+	}
+
 	void CCollisionSystem::Update()
 	{
 		namespace cm = GLVM::ecs::components;
-		
+
         ComponentManager* componentManager = ComponentManager::GetInstance();
-		core::vector<Entity> linkedEntities = componentManager->collectLinkedEntities<cm::collider,
-																					  cm::transform>();
-		
-		core::vector<Entity> linkedEntitiesWithMove = componentManager->collectLinkedEntities<cm::collider,
-																					  cm::transform,
-																					  cm::move>();
-		
-        float cameraSpeed = 5.5f * fDelta_Time_;            
-		unsigned int linkedEntitiesVectorSize = linkedEntities.GetSize();
-		unsigned int linkedEntitiesVectorSizeWithMove = linkedEntitiesWithMove.GetSize();
-		for(unsigned int i = 0; i < linkedEntitiesVectorSize; ++i) {
-			unsigned int backtrackingEntityRefCollider = linkedEntities[i];  
-			componentManager->GetComponent<cm::collider>(backtrackingEntityRefCollider)->bGround_Collision_ = false;
-			for(unsigned int j = 0; j < linkedEntitiesVectorSize; ++j) {
-				if ( i == j )
-					continue;
-				
-                unsigned int comparedEntityRefCollider     = linkedEntities[j];
-				
-				vec3 backtrackingTransform = componentManager->
-					GetComponent<cm::transform>(backtrackingEntityRefCollider)->tPosition;
-				vec3 backtrackingTransformUpper = componentManager->
-					GetComponent<cm::transform>(backtrackingEntityRefCollider)->tPosition;
-				float backtrackingScale = componentManager->
-					GetComponent<cm::transform>(backtrackingEntityRefCollider)->fScale;
-				float backtrackingGltfFlag = componentManager->
-					GetComponent<cm::transform>(backtrackingEntityRefCollider)->gltf;
-			    vec3  comparedTransform     = componentManager->
-					GetComponent<cm::transform>(comparedEntityRefCollider)->tPosition;
-				vec3 comparedTransformUpper = componentManager->
-					GetComponent<cm::transform>(comparedEntityRefCollider)->tPosition;
-				float comparedScale     = componentManager->
-					GetComponent<cm::transform>(comparedEntityRefCollider)->fScale;
-				float comparedGltfFlag = componentManager->
-					GetComponent<cm::transform>(comparedEntityRefCollider)->gltf;
-				for ( unsigned int m = 0; m < linkedEntitiesVectorSizeWithMove; ++m) {
-					if ( backtrackingEntityRefCollider == linkedEntitiesWithMove[m] ) {
-						cm::move* backtrackingMove = componentManager->
-							GetComponent<cm::move>(backtrackingEntityRefCollider);
-						backtrackingTransform += Normalize(backtrackingMove->frameMovement) * cameraSpeed;
-						backtrackingTransform += backtrackingMove->gravity;
-					}
-				}
-				for ( unsigned int n = 0; n < linkedEntitiesVectorSizeWithMove; ++n) {
-					if ( comparedEntityRefCollider == linkedEntitiesWithMove[n] ) {
-						cm::move* comparedMove     = componentManager->
-							GetComponent<cm::move>(comparedEntityRefCollider);
-						comparedTransform += Normalize(comparedMove->frameMovement) * cameraSpeed;
-						comparedTransform += comparedMove->gravity;
+		core::vector<CollisionQuery::Row> bodies = CollisionQuery(componentManager).Collect();
+
+        float cameraSpeed = 5.5f * fDelta_Time_;
+		unsigned int bodiesNumber = bodies.GetSize();
+
+		// Predicted position and half size do not change inside the pair loop. Bullets
+		// cover their whole step, from where their owner system moved them from.
+		core::vector<AABB> predictedBounds;
+		core::vector<float> halfScales;
+		predictedBounds.Reserve(bodiesNumber);
+		halfScales.Reserve(bodiesNumber);
+		sweepStarts_.Resize(bodiesNumber);
+		sweepDeltas_.Resize(bodiesNumber);
+		active_.Resize(bodiesNumber);
+		bullets_.Resize(bodiesNumber);
+		for ( unsigned int i = 0; i < bodiesNumber; ++i ) {
+			cm::transform* transform = bodies[i].Get<cm::transform>();
+			cm::collider* collider = bodies[i].Get<cm::collider>();
+			cm::move* move = bodies[i].Get<cm::move>();
+			cm::rigidBody* rigidBody = bodies[i].Get<cm::rigidBody>();
+			bullets_[i] = collider->bBullet_;
+			active_[i] = move != nullptr || bodies[i].Get<cm::projectile>() != nullptr || collider->bBullet_;
+			vec3 position = transform->tPosition;
+			if ( move != nullptr ) {
+				position += Normalize(move->frameMovement) * cameraSpeed;
+				position += move->gravity;
+			}
+
+			vec3 start = transform->tPosition;
+			if ( collider->bBullet_ ) {
+				start = vec3(start[0] - collider->tSweep_[0], start[1] - collider->tSweep_[1], start[2] - collider->tSweep_[2]);
+				collider->fTimeOfImpact_ = 1.0f;
+			}
+			sweepStarts_[i] = start;
+			sweepDeltas_[i] = vec3(position[0] - start[0], position[1] - start[1], position[2] - start[2]);
+
+			float halfScale = transform->gltf ? transform->fScale : transform->fScale / 2;
+			halfScales.Push(halfScale);
+			if ( collider->bBullet_ )
+				predictedBounds.Push(Merge(AABBFromCenter(start, halfScale), AABBFromCenter(position, halfScale)));
+			else
+				predictedBounds.Push(AABBFromCenter(position, halfScale));
+
+			// A sleeping body keeps the support it fell asleep on.
+			if ( rigidBody == nullptr || rigidBody->bAwake_ )
+				bodies[i].Get<cm::collider>()->bGround_Collision_ = false;
+		}
+
+		// Narrowphase of one ordered pair, the flag goes to the backtracking body only.
+		// Reads shared data and writes the caller's buffer, so workers can run it at once.
+		// Pairs where nothing moves (resting on resting or static) cannot change any flag.
+		auto testPair = [&](unsigned int backtracking, unsigned int compared, core::vector<Contact>& contacts) {
+			if ( !active_[backtracking] && !active_[compared] )
+				return;
+			if ( !Overlaps(predictedBounds[backtracking], predictedBounds[compared]) )
+				return;
+
+			float timeOfImpact = 1.0f;
+			if ( (bullets_[backtracking] || bullets_[compared]) && !SweepTest(backtracking, compared, halfScales, timeOfImpact) )
+				return;
+
+			bool ground = UpperActorCheck(bodies[backtracking].Get<cm::transform>()->tPosition,
+										  bodies[compared].Get<cm::transform>()->tPosition,
+										  halfScales[backtracking],
+										  halfScales[compared]);
+			core::PushGrowing(contacts, Contact{ backtracking, compared, ground, timeOfImpact });
+		};
+
+		// Flags are only raised, so the single pass over the merged contacts is the one
+		// place the colliders get written.
+		auto resolveContacts = [&]() {
+			for ( unsigned int i = 0; i < contacts_.GetSize(); ++i ) {
+				cm::collider* collider = bodies[contacts_[i].body].Get<cm::collider>();
+				if ( contacts_[i].ground )
+					collider->bGround_Collision_ = true;
+				else
+					collider->bWall_Collision_ = true;
+				if ( collider->bBullet_ )
+					collider->fTimeOfImpact_ = Min(collider->fTimeOfImpact_, contacts_[i].timeOfImpact);
+			}
+		};
+
+		contacts_.Resize(0);
+		if ( broadphase == eBRUTE_FORCE ) {
+			bounds_.Resize(bodiesNumber);
+			for ( unsigned int i = 0; i < bodiesNumber; ++i )
+				bounds_.Set(i, predictedBounds[i]);
+
+			for ( unsigned int i = 0; i < bodiesNumber; ++i ) {
+				for ( unsigned int j = 0; j < bodiesNumber; j += core::CBoundsSoA::kLanes ) {
+					unsigned int mask = core::OverlapMask8(predictedBounds[i], bounds_, j);
+					for ( ; mask != 0; mask &= mask - 1 ) {
+						unsigned int other = j + std::countr_zero(mask);
+						if ( other != i )
+							testPair(i, other, contacts_);
 					}
 				}
+			}
+			resolveContacts();
+			CacheContacts(bodies, halfScales);
+			UpdateIslands(bodies);
+			return;
+		}
 
-				if ( !backtrackingGltfFlag ) {
-					backtrackingScale /= 2;
-				}
+		pairs_.Resize(0);
+		if ( broadphase == eSWEEP_AND_PRUNE ) {
+			core::vector<Entity> entities;
+			entities.Reserve(bodiesNumber);
+			for ( unsigned int i = 0; i < bodiesNumber; ++i )
+				entities.Push(bodies[i].entity);
+
+			sweepAndPrune_.Update(entities.GetVectorContainer(), predictedBounds.GetVectorContainer(), bodiesNumber);
+			sweepAndPrune_.CollectPairs(pairs_);
+		} else {
+			spatialHash_.Build(predictedBounds.GetVectorContainer(), bodiesNumber);
+			spatialHash_.CollectPairs(pairs_);
+		}
+
+		// Each worker takes one contiguous range of pairs; appending the buffers in worker
+		// order gives the contacts in the same order as a single threaded pass.
+		unsigned int pairsNumber = pairs_.GetSize();
+		unsigned int workers = std::max(1u, std::min(workersNumber, pairsNumber / kMinPairsPerWorker));
+		if ( contactBuffers_.size() < workers )
+			contactBuffers_.resize(workers);
+
+		auto narrowphase = [&](unsigned int worker) {
+			core::vector<Contact>& contacts = contactBuffers_[worker];
+			contacts.Resize(0);
+			unsigned int begin = static_cast<unsigned int>(uint64_t(pairsNumber) * worker / workers);
+			unsigned int end = static_cast<unsigned int>(uint64_t(pairsNumber) * (worker + 1) / workers);
+			for ( unsigned int i = begin; i < end; ++i ) {
+				testPair(pairs_[i].first, pairs_[i].second, contacts);
+				testPair(pairs_[i].second, pairs_[i].first, contacts);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(workers - 1);
+		for ( unsigned int worker = 1; worker < workers; ++worker )
+			threads.emplace_back(narrowphase, worker);
+		narrowphase(0);
+		for ( std::thread& thread : threads )
+			thread.join();
+
+		unsigned int contactsNumber = 0;
+		for ( unsigned int worker = 0; worker < workers; ++worker )
+			contactsNumber += contactBuffers_[worker].GetSize();
+		contacts_.Reserve(contactsNumber);
+		for ( unsigned int worker = 0; worker < workers; ++worker ) {
+			const core::vector<Contact>& contacts = contactBuffers_[worker];
+			for ( unsigned int i = 0; i < contacts.GetSize(); ++i )
+				contacts_.Push(contacts[i]);
+		}
 
-				if ( !comparedGltfFlag ) {
-					comparedScale /= 2;
+		resolveContacts();
+		CacheContacts(bodies, halfScales);
+		UpdateIslands(bodies);
+	}
+
+	/*! Rigid bodies touching each other this step form an island. A contact from
+	 *  a moving body wakes the island a sleeping body went to sleep with; an
+	 *  island whose every body has been supported and still for timeToSleep
+	 *  goes to sleep as a whole, so a stack never loses its lower cubes while
+	 *  the upper ones still settle. Bodies with a controller never sleep. */
+	void CCollisionSystem::UpdateIslands(core::vector<CollisionQuery::Row>& bodies) {
+		namespace cm = GLVM::ecs::components;
+
+		unsigned int bodiesNumber = bodies.GetSize();
+		islands_.Reset(bodiesNumber);
+		wakingIslands_.Resize(0);
+		for ( unsigned int i = 0; i < contacts_.GetSize(); ++i ) {
+			const Contact& contact = contacts_[i];
+			cm::rigidBody* body = bodies[contact.body].Get<cm::rigidBody>();
+			cm::rigidBody* other = bodies[contact.other].Get<cm::rigidBody>();
+			// Projectiles have no rigid body but still wake what they hit.
+			if ( active_[contact.body] && other != nullptr && !other->bAwake_ )
+				core::PushGrowing(wakingIslands_, other->island_);
+			if ( body != nullptr && other != nullptr )
+				islands_.Union(contact.body, contact.other);
+		}
+
+		if ( wakingIslands_.GetSize() > 0 ) {
+			unsigned int* waking = wakingIslands_.GetVectorContainer();
+			std::sort(waking, waking + wakingIslands_.GetSize());
+			for ( unsigned int i = 0; i < bodiesNumber; ++i ) {
+				cm::rigidBody* body = bodies[i].Get<cm::rigidBody>();
+				if ( body != nullptr && !body->bAwake_ &&
+					 std::binary_search(waking, waking + wakingIslands_.GetSize(), body->island_) ) {
+					body->bAwake_ = true;
+					body->sleepTimer_ = 0.0f;
 				}
-				
-				bool boxColliderFlag;
-				bool upperActorCheckFlag = false;
-                boxColliderFlag = BoxCollider(backtrackingTransform,
-											  comparedTransform,
-											  backtrackingScale,
-											  comparedScale);
-				if ( boxColliderFlag ) {
-					upperActorCheckFlag = UpperActorCheck(backtrackingTransformUpper,
-														  comparedTransformUpper,
-														  backtrackingScale,
-														  comparedScale);
+			}
+		}
+
+		// Shortest still time per island, over the bodies that are awake now.
+		islandSleepTimers_.Resize(bodiesNumber);
+		for ( unsigned int i = 0; i < bodiesNumber; ++i )
+			islandSleepTimers_[i] = timeToSleep;
+		for ( unsigned int i = 0; i < bodiesNumber; ++i ) {
+			cm::rigidBody* body = bodies[i].Get<cm::rigidBody>();
+			if ( body == nullptr || !body->bAwake_ )
+				continue;
+
+			float timer = bodies[i].Get<cm::controller>() != nullptr ? 0.0f : body->sleepTimer_;
+			unsigned int root = islands_.Find(i);
+			islandSleepTimers_[root] = Min(islandSleepTimers_[root], timer);
+		}
+
+		awakeBodies_ = 0;
+		sleepingBodies_ = 0;
+		for ( unsigned int i = 0; i < bodiesNumber; ++i ) {
+			cm::rigidBody* body = bodies[i].Get<cm::rigidBody>();
+			if ( body == nullptr )
+				continue;
+
+			if ( body->bAwake_ ) {
+				unsigned int root = islands_.Find(i);
+				if ( islandSleepTimers_[root] >= timeToSleep ) {
+					body->bAwake_ = false;
+					body->island_ = bodies[root].entity;
 				}
-				
-				if(upperActorCheckFlag && boxColliderFlag) {
-                    componentManager->GetComponent<cm::collider>(backtrackingEntityRefCollider)->bGround_Collision_ = true;
-                    continue;
-                }
-                    
-                if(boxColliderFlag) {
-                    componentManager->GetComponent<cm::collider>(backtrackingEntityRefCollider)->bWall_Collision_ = true;
-                    continue;
-                }
 			}
+
+			if ( body->bAwake_ )
+				++awakeBodies_;
+			else
+				++sleepingBodies_;
 		}
 	}
 
@@ -12,6 +12,16 @@ namespace GLVM::ecs
 	CGUISystem::CGUISystem() {
 		_Shader_Program = new Shader("../GLshaders/GUI.vert", "../GLshaders/GUI.frag");
 		debugLines      = new Shader("../GLshaders/debugLines.vert", "../GLshaders/debugLines.frag");
+
+		pGLGen_Vertex_Arrays(1, &iVao_Crosshair_);
+		pGLBind_Vertex_Array(iVao_Crosshair_);
+		pGLEnable_Vertex_Attrib_Array(LAYOUT_0);
+		pGLBind_Vertex_Array(0);
+		vertexStream_ = std::make_unique<core::CStreamingBuffer>(GL_ARRAY_BUFFER, 1024, sizeof(float));
+	}
+
+	CGUISystem::~CGUISystem() {
+		pGLDelete_Vertex_Arrays(1, &iVao_Crosshair_);
 	}
 	
     void CGUISystem::Update()
@@ -25,12 +35,10 @@ namespace GLVM::ecs
 
         _Shader_Program->Use();
 		
-        unsigned int uiTransformt_Loc = pGLGet_Uniform_Location(_Shader_Program->iID, "modelMatrix");
-		pGLUniform_Matrix4fv(uiTransformt_Loc, NUMBER_OF_MATRICES, GL_FALSE, &tModel_Matrix[0][0]);
+        _Shader_Program->SetMat4("modelMatrix", tModel_Matrix);
 
 //		tProjection_Matrix = Perspective(Radians(90.0f), (float)1920 / (float)1080, 1.0f, 100.0f);
-		unsigned int transformLocationProjection = pGLGet_Uniform_Location(_Shader_Program->iID, "projectionMatrix");
-		pGLUniform_Matrix4fv(transformLocationProjection, NUMBER_OF_MATRICES, GL_FALSE, &tProjection_Matrix[0][0]);
+		_Shader_Program->SetMat4("projectionMatrix", tProjection_Matrix);
 						
         float aCrosshair_Vertices[] = {
 			-0.1, 0.5, -0.3,
@@ -47,20 +55,17 @@ namespace GLVM::ecs
 			0.5, -0.1, -0.3
         }; 
 
-        pGLGen_Vertex_Arrays(1, &iVao_Crosshair_);
-        pGLGen_Buffers(1, &iVbo_Crosshair_);
         // bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attributes(s).
         pGLBind_Vertex_Array(iVao_Crosshair_);
 
-        pGLBind_Buffer(GL_ARRAY_BUFFER, iVbo_Crosshair_);
-        pGLBuffer_Data(GL_ARRAY_BUFFER, sizeof(aCrosshair_Vertices), aCrosshair_Vertices, GL_DYNAMIC_DRAW);
-
-        pGLVertex_Attrib_Pointer(0, VERTEX_SIZE, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)VERTEX_OFFSET);
-        pGLEnable_Vertex_Attrib_Array(LAYOUT_0);
+        GLintptr verticesOffset = vertexStream_->Write(aCrosshair_Vertices, sizeof(aCrosshair_Vertices));
+        pGLBind_Buffer(GL_ARRAY_BUFFER, vertexStream_->GetBuffer());
+        pGLVertex_Attrib_Pointer(0, VERTEX_SIZE, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)(VERTEX_OFFSET + verticesOffset));
         
         glClear(GL_DEPTH_BUFFER_BIT);
         
         glDrawArrays(GL_TRIANGLES, 0, 12);
+        vertexStream_->NextFrame();
 
         // note that this is allowed, the call to glVertexAttribPointer registered VBO as the vertex attribute's bound vertex buffer object so afterwards we can safely unbind
         pGLBind_Buffer(GL_ARRAY_BUFFER, 0); 
@@ -21,6 +21,7 @@
 #include "Engine.hpp"
 #include "EntityManager.hpp"
 #include "Event.hpp"
+#include "FastMath.hpp"
 #include "ISoundEngine.hpp"
 #include "Vector.hpp"
 #include "VertexMath.hpp"
@@ -114,6 +115,9 @@ namespace GLVM::ecs
 //            ecs::transform& rTransform_Component = pComponent_Manager->GetComponent<ecs::transform>(iEntity_refRigidBody);
 			cm::transform* rTransform_Component = componentManager->GetComponent<cm::transform>(iEntity_refRigidBody);
 			cm::rigidBody* rigidBodyComponennt = componentManager->GetComponent<cm::rigidBody>(iEntity_refRigidBody);
+			if ( !rigidBodyComponennt->bAwake_ || !componentManager->IsEntityEnabled(iEntity_refRigidBody) )
+				continue;
+
 			componentManager->CreateComponent<cm::move>(iEntity_refRigidBody);
 			cm::move* moveComponent = componentManager->GetComponent<cm::move>(iEntity_refRigidBody);
 			rTransform_Component->GravityAccumulator += deltaFrameTime;
@@ -138,8 +142,8 @@ namespace GLVM::ecs
         // forward[0] = std::cos(Radians(event.mousePointerPosition.yaw * 2));
         // forward[2] = std::sin(Radians(event.mousePointerPosition.yaw * 2));
 
-		float sinYaw = std::sin(Radians(-event.mousePointerPosition.yaw / 2));
-		float cosYaw = std::cos(Radians(-event.mousePointerPosition.yaw / 2));
+		float sinYaw, cosYaw;
+		core::math::sincosDegrees(-event.mousePointerPosition.yaw / 2, sinYaw, cosYaw);
 		
 		Quaternion yawQuat;
 		yawQuat.w = cosYaw;
@@ -47,6 +47,9 @@ namespace GLVM::ecs
 					move->frameMovement = 0;
                     collider->bWall_Collision_ = false;
                 }
+				vec3 displacement = vec3(move->frameMovement[0] + move->gravity[0],
+										 move->frameMovement[1] + move->gravity[1],
+										 move->frameMovement[2] + move->gravity[2]);
 				transformComponent->tPosition += move->frameMovement;
 				transformComponent->tPosition += move->gravity;
 				move->gravity       = 0.0f;
@@ -58,7 +61,14 @@ namespace GLVM::ecs
 					rigidBody->jumpAccumulator -= deltaTime;
 					rigidBody->jump = vec3{ 0.0f, 5.0f, 0.0f } * deltaTime;
 					transformComponent->tPosition += rigidBody->jump;
+					displacement += rigidBody->jump;
 				}
+
+				// Only a supported body counts as still, a cube at the top of its arc moves slowly too.
+				if ( collider->bGround_Collision_ && displacement.Length() < sleepSpeed * fDelta_Time_ )
+					rigidBody->sleepTimer_ += fDelta_Time_;
+				else
+					rigidBody->sleepTimer_ = 0.0f;
         }
     }
 }
@@ -10,6 +10,7 @@
 #include "Components/ProjectileComponent.hpp"
 #include "Components/TransformComponent.hpp"
 #include "Components/VertexComponent.hpp"
+#include "Prefab.hpp"
 #include "Texture.hpp"
 #include <Systems/ProjectileSystem.hpp>
 
@@ -73,36 +74,94 @@ namespace GLVM::ecs
         for(unsigned int x = 0; x < linkedEntities.GetSize(); ++x) {
             unsigned int uiEntity_refProjectile = linkedEntities[x];
             cm::transform* rTransformProjectile = pComponent_Manager->GetComponent<cm::transform>(uiEntity_refProjectile);
-			rTransformProjectile->tPosition += rTransformProjectile->tForward * cameraSpeed;
+			vec3 direction = pComponent_Manager->GetComponent<cm::projectile>(uiEntity_refProjectile)->tDirection_;
+			rTransformProjectile->tPosition += direction * cameraSpeed;
+			pComponent_Manager->GetComponent<cm::collider>(uiEntity_refProjectile)->tSweep_ = direction * cameraSpeed;
 			cm::pointLight* pointLightComponent = pComponent_Manager->GetComponent<cm::pointLight>(uiEntity_refProjectile);
-			pointLightComponent->position += rTransformProjectile->tForward * cameraSpeed;
+			pointLightComponent->position += direction * cameraSpeed;
 		}
 
-        for(unsigned int i = 0; i < linkedEntities.GetSize(); ++i) {
-			
+		// Projectiles hit by the one unit ray along their flight direction are removed with
+		// the ones the collision system flagged, each entity once.
+		UpdateTargets(pComponent_Manager);
+		unsigned int projectilesNumber = linkedEntities.GetSize();
+		rays_.Resize(projectilesNumber);
+		hits_.Resize(projectilesNumber);
+		for ( unsigned int i = 0; i < projectilesNumber; ++i ) {
+			cm::transform* rTransformProjectile = pComponent_Manager->GetComponent<cm::transform>(linkedEntities[i]);
+			vec3 direction = pComponent_Manager->GetComponent<cm::projectile>(linkedEntities[i])->tDirection_;
+			rays_[i] = core::Ray{ .origin = rTransformProjectile->tPosition, .delta = direction * 1.0f };
+		}
+
+		targetTree_.RaycastBatch(rays_.GetVectorContainer(), projectilesNumber, hits_.GetVectorContainer());
+
+        for(unsigned int i = 0; i < projectilesNumber; ++i) {
             unsigned int uiEntity_refProjectile = linkedEntities[i];
-            if(pComponent_Manager->GetComponent<cm::collider>(uiEntity_refProjectile)->bWall_Collision_ ||
-               pComponent_Manager->GetComponent<cm::collider>(uiEntity_refProjectile)->bGround_Collision_) {
+			cm::collider* collider = pComponent_Manager->GetComponent<cm::collider>(uiEntity_refProjectile);
+            if(collider->bWall_Collision_ || collider->bGround_Collision_ || hits_[i].proxy != core::CDynamicAABBTree::kNullNode) {
                 pEntity_Manager->RemoveEntity(uiEntity_refProjectile, pComponent_Manager);
             }
-//			std::cout << "Size: " << linkedEntities.GetSize() << std::endl;
-//			pComponent_Manager->GetEntityContainer<cm::projectile>()->Print();
-//			std::cout << "Colliders container size: " << pComponent_Manager->GetEntityContainer<cm::collider>()->GetSize() << std::endl;
-//			std::cout << "Projectiles container size 1: " << linkedEntities.GetSize() << std::endl;
-//			std::cout << "Projectiles container size 2: " << uiVector_Projectile_Size << std::endl;
-//			std::cout << "entity: " << uiEntity_refProjectile << std::endl;
         }
     }
 
+	void CProjectileSystem::UpdateTargets(ComponentManager* componentManager) {
+		namespace cm = GLVM::ecs::components;
+
+		core::vector<Entity> targets = componentManager->collectUniqueLinkedEntities<cm::material,
+																					  cm::collider,
+																					  cm::mesh,
+																					  cm::transform>();
+
+		// Marks the current targets with -2 so the stale proxies can be told apart.
+		const int kCurrentTarget = -2;
+		for ( unsigned int i = 0; i < targets.GetSize(); ++i ) {
+			Entity entity = targets[i];
+			if ( entity >= targetProxies_.GetSize() ) {
+				unsigned int oldSize = targetProxies_.GetSize();
+				targetProxies_.Resize(entity + 1);
+				for ( unsigned int j = oldSize; j <= entity; ++j )
+					targetProxies_[j] = core::CDynamicAABBTree::kNullNode;
+			}
+		}
+
+		core::vector<int> currentProxies;
+		currentProxies.Reserve(targets.GetSize());
+		for ( unsigned int i = 0; i < targets.GetSize(); ++i ) {
+			currentProxies.Push(targetProxies_[targets[i]]);
+			targetProxies_[targets[i]] = kCurrentTarget;
+		}
+
+		for ( unsigned int i = 0; i < trackedTargets_.GetSize(); ++i ) {
+			Entity entity = trackedTargets_[i];
+			if ( targetProxies_[entity] == kCurrentTarget )
+				continue;
+
+			targetTree_.DestroyProxy(targetProxies_[entity]);
+			targetProxies_[entity] = core::CDynamicAABBTree::kNullNode;
+		}
+
+		for ( unsigned int i = 0; i < targets.GetSize(); ++i ) {
+			Entity entity = targets[i];
+			cm::transform* transform = componentManager->GetComponent<cm::transform>(entity);
+			AABB bounds = AABBFromCenter(transform->tPosition, transform->fScale * 0.5f);
+			int proxy = currentProxies[i];
+			if ( proxy == core::CDynamicAABBTree::kNullNode )
+				proxy = targetTree_.CreateProxy(bounds, entity);
+			else
+				targetTree_.MoveProxy(proxy, bounds);
+
+			targetProxies_[entity] = proxy;
+		}
+
+		trackedTargets_ = targets;
+	}
+
     void CProjectileSystem::CalculateProjectile(ecs::ComponentManager* componentManager,
 												unsigned int entityRefMove,
 												components::beholder& beholder) {
 		namespace cm = GLVM::ecs::components;
 
-        unsigned int uiEntity_Projectile = ecs::EntityManager::GetInstance()->CreateEntity();
-        ecs::ComponentManager::GetInstance()->CreateComponent<cm::mesh, cm::collider,
-															  cm::transform, cm::material,
-															  cm::projectile, cm::pointLight>(uiEntity_Projectile);
+        Entity uiEntity_Projectile = CPrefabRegistry::GetInstance()->Instantiate(*GetProjectilePrefab())[0];
 
         core::Sound::CSoundSample* pSound_Sample = new core::Sound::CSoundSample();
         pSound_Sample->kPath_to_File_ = "../laser2.wav";
@@ -110,34 +169,55 @@ namespace GLVM::ecs
         pSound_Sample->uiRate_ = 22050;
         soundEngine->GetSoundContainer().Push(pSound_Sample);
 
-		ecs::components::MeshHandle meshHandle{};
-		if ( meshHandlers.GetSize() > 0 )
-			meshHandle = meshHandlers[0];
-		componentManager->GetComponent<cm::mesh>(uiEntity_Projectile)->handle = meshHandle;
-		ecs::TextureHandle textureHandle{};
-		if ( textureHandlers.GetSize() > 0 )
-			textureHandle = textureHandlers[0];
-		cm::material* rTextureProjectile = componentManager->GetComponent<cm::material>(uiEntity_Projectile);
-		*rTextureProjectile = { .diffuseTextureID_ = textureHandle, .specularTextureID_ = textureHandle, .ambient = { 0.05f, 0.05f, 0.05f },
-		.shininess = 128.0f * 0.078125f };
         cm::transform* rTransformProjectile = componentManager->GetComponent<cm::transform>(uiEntity_Projectile);
-        rTransformProjectile->fScale = 0.1f;
+		if ( rTransformProjectile == nullptr ) {
+			// A prefab without transform could never move, nor leave through a hit.
+			ecs::EntityManager::GetInstance()->RemoveEntity(uiEntity_Projectile, componentManager);
+			return;
+		}
 		
 		cm::transform* transform = componentManager->GetComponent<cm::transform>(entityRefMove);
 		if ( transform != nullptr )
 			rTransformProjectile->tPosition = transform->tPosition;
 
-        rTransformProjectile->tForward   = GetDirectionVector(beholder);
-		rTransformProjectile->yaw        = fYaw;
-		rTransformProjectile->pitch      = fPitch;
-        rTransformProjectile->tPosition += rTransformProjectile->tForward * 2.0;
+		Quaternion direction = GetDirectionQuaternion();
+		beholder.forward = Normalize(rotateVector(direction, vec3(0.0f, 0.0f, -1.0f)));
+		// The model keeps the yaw and pitch it had from the Euler angles, the flight
+		// direction is stored apart since that rotation's forward is not the aim.
+		cm::SetRotation(*rTransformProjectile, cm::YawPitchRotation(fYaw, fPitch));
+		cm::projectile* projectile = componentManager->GetComponent<cm::projectile>(uiEntity_Projectile);
+		if ( projectile != nullptr )
+			projectile->tDirection_ = beholder.forward;
+        rTransformProjectile->tPosition += beholder.forward * 2.0;
 		
-		*(componentManager->GetComponent<cm::pointLight>(uiEntity_Projectile)) = { .position = rTransformProjectile->tPosition,
-			.ambient = { 0.1f, 0.1f, 0.1f }, .diffuse = { 0.5f, 0.5f, 0.5f }, .specular = { 1.1f, 1.2f, 1.3f },
-			.constant = 1.4f, .linear = 0.1f, .quadratic = 0.128f };
+		cm::pointLight* light = componentManager->GetComponent<cm::pointLight>(uiEntity_Projectile);
+		if ( light != nullptr )
+			light->position = rTransformProjectile->tPosition;
     }
 
-    Vector<float, 3> CProjectileSystem::GetDirectionVector(components::beholder& beholder)
+    CPrefab* CProjectileSystem::GetProjectilePrefab()
+    {
+		namespace cm = GLVM::ecs::components;
+
+		if ( projectilePrefab_ != nullptr )
+			return projectilePrefab_;
+
+		// Render handles only exist at runtime, the loaded prefab gets the first mesh and texture.
+		projectilePrefab_ = CPrefabRegistry::GetInstance()->Register("projectile");
+		cm::mesh* mesh = projectilePrefab_->Get<cm::mesh>();
+		if ( mesh != nullptr && meshHandlers.GetSize() > 0 )
+			mesh->handle = meshHandlers[0];
+
+		cm::material* material = projectilePrefab_->Get<cm::material>();
+		if ( material != nullptr && textureHandlers.GetSize() > 0 ) {
+			material->diffuseTextureID_ = textureHandlers[0];
+			material->specularTextureID_ = textureHandlers[0];
+		}
+
+		return projectilePrefab_;
+    }
+
+    Quaternion CProjectileSystem::GetDirectionQuaternion()
     {
         const float kSensitivity = 0.1f;
 
@@ -154,38 +234,15 @@ namespace GLVM::ecs
         if(fPitch < -89.0f)
             fPitch = -89.0f;
 
-		vec3 forward;
-		float sinPitch = std::sin(Radians(fPitch / 2));
-		float cosPitch = std::cos(Radians(fPitch / 2));
-		float sinYaw = std::sin(Radians(-fYaw / 2));
-		float cosYaw = std::cos(Radians(-fYaw / 2));
-		
-		Quaternion pitchQuat;
-		Quaternion yawQuat;
-		pitchQuat.w = cosPitch;
-		pitchQuat.x = sinPitch;
-		pitchQuat.y = 0.0f;
-		pitchQuat.z = 0.0f;
-
-		yawQuat.w = cosYaw;
-		yawQuat.x = 0.0f;
-		yawQuat.y = sinYaw;
-		yawQuat.z = 0.0f;
-
-		Quaternion result;
-		result = multiplyQuaternion(yawQuat, pitchQuat);
-
-		result = multiplyQuaternion(multiplyQuaternion(result, Quaternion{ .w = 0.0f, .x = 0.0f,
-					.y = 0.0f, .z = -1.0f }), inverseQuaternion(result));
-
-		forward[0] = result.x;
-		forward[1] = result.y;
-		forward[2] = result.z;
-		
-        // front[0] = std::cos(Radians(fYaw)) * std::cos(Radians(fPitch));
-        // front[1] = std::sin(Radians(fPitch));
-        // front[2] = std::sin(Radians(fYaw)) * std::cos(Radians(fPitch));
-        beholder.forward = Normalize(forward);
+		Quaternion pitchQuat = axisAngleQuaternion(vec3(1.0f, 0.0f, 0.0f), Radians(fPitch));
+		Quaternion yawQuat = axisAngleQuaternion(vec3(0.0f, 1.0f, 0.0f), Radians(-fYaw));
+
+		return multiplyQuaternion(yawQuat, pitchQuat);
+    }
+
+    Vector<float, 3> CProjectileSystem::GetDirectionVector(components::beholder& beholder)
+    {
+        beholder.forward = Normalize(rotateVector(GetDirectionQuaternion(), vec3(0.0f, 0.0f, -1.0f)));
 
         return beholder.forward;
     }
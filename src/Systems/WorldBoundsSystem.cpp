@@ -0,0 +1,28 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "Systems/WorldBoundsSystem.hpp"
+#include "ComponentManager.hpp"
+#include "Components/TransformComponent.hpp"
+
+namespace GLVM::ecs
+{
+	void CWorldBoundsSystem::Update() {
+		namespace cm = GLVM::ecs::components;
+
+		ComponentManager* componentManager = ComponentManager::GetInstance();
+		for ( unsigned int i = 0; i < pools_.GetSize(); ++i ) {
+			core::vector<Entity> active = pools_[i]->GetActive();
+			for ( unsigned int j = 0; j < active.GetSize(); ++j ) {
+				cm::transform* transform = componentManager->GetComponent<cm::transform>(active[j]);
+				if ( transform == nullptr || transform->tPosition[1] >= minHeight )
+					continue;
+
+				pools_[i]->Release(active[j]);
+				++despawned_;
+			}
+		}
+	}
+}
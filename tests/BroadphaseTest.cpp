@@ -0,0 +1,172 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "Broadphase.hpp"
+#include "ComponentsFullSet.hpp"
+#include "EntityManager.hpp"
+#include "EventsStack.hpp"
+#include "Systems/CollisionSystem.hpp"
+#include "Check.hpp"
+#include <algorithm>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	using namespace GLVM;
+	namespace cm = GLVM::ecs::components;
+
+	using PairSet = std::set<std::pair<unsigned int, unsigned int>>;
+
+	/// A few percent of oversized boxes, like the ground planes among the cubes.
+	std::vector<AABB> RandomBoxes(unsigned int _count, std::mt19937& _random) {
+		float side = std::cbrt(float(_count)) * 2.5f;
+		std::uniform_real_distribution<float> position(-side, side);
+		std::vector<AABB> boxes(_count);
+		for (unsigned int i = 0; i < _count; ++i) {
+			float halfExtent = i % 97 == 0 ? 10.2f : 0.5f + 0.5f * (i % 3);
+			boxes[i] = AABBFromCenter(vec3(position(_random), position(_random), position(_random)), halfExtent);
+		}
+		return boxes;
+	}
+
+	PairSet BruteForcePairs(const std::vector<AABB>& _boxes) {
+		PairSet pairs;
+		for (unsigned int i = 0; i < _boxes.size(); ++i)
+			for (unsigned int j = i + 1; j < _boxes.size(); ++j)
+				if (Overlaps(_boxes[i], _boxes[j]))
+					pairs.insert({ i, j });
+		return pairs;
+	}
+
+	/// Also fails on a pair reported twice, which the set alone would hide.
+	PairSet ToSet(const core::vector<core::BroadphasePair>& _pairs) {
+		PairSet set;
+		for (unsigned int i = 0; i < _pairs.GetSize(); ++i) {
+			CHECK(_pairs[i].first < _pairs[i].second);
+			set.insert({ _pairs[i].first, _pairs[i].second });
+		}
+		CHECK(set.size() == _pairs.GetSize());
+		return set;
+	}
+
+	void CheckSpatialHash(std::mt19937& _random) {
+		for (unsigned int count : { 1000u, 10000u }) {
+			std::vector<AABB> boxes = RandomBoxes(count, _random);
+			core::CSpatialHash hash;
+			core::vector<core::BroadphasePair> pairs;
+
+			auto start = std::chrono::steady_clock::now();
+			hash.Build(boxes.data(), count);
+			hash.CollectPairs(pairs);
+			double hashMs = test::ElapsedMs(start);
+
+			start = std::chrono::steady_clock::now();
+			PairSet reference = BruteForcePairs(boxes);
+			double bruteMs = test::ElapsedMs(start);
+
+			std::printf("spatial hash: %u boxes, %u pairs, %.2f ms, brute force %.2f ms\n", count, pairs.GetSize(), hashMs, bruteMs);
+			CHECK(ToSet(pairs) == reference);
+		}
+	}
+
+	/// Moving every box from a layout spread along x to one spread along y makes the sweep change axis.
+	void CheckSweepAndPrune(std::mt19937& _random) {
+		const unsigned int count = 5000;
+		std::vector<AABB> boxes(count);
+		std::vector<unsigned int> ids(count);
+		std::uniform_real_distribution<float> wide(0.0f, 300.0f), narrow(0.0f, 30.0f);
+		auto place = [&](bool alongX) {
+			for (unsigned int i = 0; i < count; ++i) {
+				vec3 min(alongX ? wide(_random) : narrow(_random), alongX ? narrow(_random) : wide(_random), narrow(_random));
+				boxes[i] = AABB{ .min = min, .max = min + vec3(1.0f, 1.0f, 1.0f) };
+			}
+		};
+		for (unsigned int i = 0; i < count; ++i)
+			ids[i] = i;
+
+		core::CSweepAndPrune sweep;
+		core::vector<core::BroadphasePair> pairs;
+		place(true);
+		sweep.Update(ids.data(), boxes.data(), count);
+		sweep.CollectPairs(pairs);
+		CHECK(sweep.GetAxis() == 0);
+		CHECK(ToSet(pairs) == BruteForcePairs(boxes));
+
+		place(false);
+		pairs.Resize(0);
+		auto start = std::chrono::steady_clock::now();
+		sweep.Update(ids.data(), boxes.data(), count);
+		double updateMs = test::ElapsedMs(start);
+		sweep.CollectPairs(pairs);
+		std::printf("sweep and prune: axis change over %u boxes %.2f ms, %u insertion shifts\n",
+					count, updateMs, sweep.GetInsertionShifts());
+		CHECK(sweep.GetAxis() == 1);
+		CHECK(ToSet(pairs) == BruteForcePairs(boxes));
+	}
+
+	/// The flags the narrowphase raises must not depend on the broadphase that found the pairs.
+	void CheckCollisionSystem(std::mt19937& _random) {
+		ecs::ComponentManager* componentManager = ecs::ComponentManager::GetInstance();
+		ecs::EntityManager* entityManager = ecs::EntityManager::GetInstance();
+		std::uniform_real_distribution<float> position(-15.0f, 15.0f);
+		std::vector<Entity> entities;
+
+		for (unsigned int i = 0; i < 3000; ++i) {
+			Entity entity = entityManager->CreateEntity();
+			componentManager->CreateComponent<cm::transform, cm::collider>(entity);
+			cm::transform* transform = componentManager->GetComponent<cm::transform>(entity);
+			transform->tPosition = vec3(position(_random), position(_random), position(_random));
+			transform->fScale = i % 200 == 0 ? 10.2f : 1.0f + i % 3;
+			transform->gltf = i % 2;
+			// Pairs where neither body moves are skipped, a quarter of the bodies move.
+			if (i % 4 == 0) {
+				componentManager->CreateComponent<cm::move>(entity);
+				cm::move* move = componentManager->GetComponent<cm::move>(entity);
+				move->frameMovement = vec3(1.0f, 0.0f, 0.0f);
+				move->gravity = vec3(0.0f, -0.1f, 0.0f);
+			}
+			entities.push_back(entity);
+		}
+
+		core::CStack stack;
+		ecs::CCollisionSystem collision(stack);
+		collision.fDelta_Time_ = 1.0f / 60.0f;
+		auto run = [&](ecs::CCollisionSystem::EBroadphase _broadphase) {
+			collision.broadphase = _broadphase;
+			for (Entity entity : entities)
+				componentManager->GetComponent<cm::collider>(entity)->bWall_Collision_ = false;
+			collision.Update();
+
+			std::vector<int> flags;
+			for (Entity entity : entities) {
+				cm::collider* collider = componentManager->GetComponent<cm::collider>(entity);
+				flags.push_back(collider->bGround_Collision_ * 2 + collider->bWall_Collision_);
+			}
+			return flags;
+		};
+
+		std::vector<int> reference = run(ecs::CCollisionSystem::eBRUTE_FORCE);
+		CHECK(std::count(reference.begin(), reference.end(), 0) < int(reference.size()));
+		CHECK(run(ecs::CCollisionSystem::eSPATIAL_HASH) == reference);
+		CHECK(run(ecs::CCollisionSystem::eSWEEP_AND_PRUNE) == reference);
+
+		for (Entity entity : entities)
+			entityManager->RemoveEntity(entity, componentManager);
+	}
+}
+
+int main()
+{
+	std::mt19937 random(7);
+
+	CheckSpatialHash(random);
+	CheckSweepAndPrune(random);
+	CheckCollisionSystem(random);
+
+	return GLVM::test::failures;
+}
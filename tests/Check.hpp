@@ -0,0 +1,35 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef TESTS_CHECK
+#define TESTS_CHECK
+
+#include <chrono>
+#include <cstdio>
+
+/*! Each test is a plain program run by `make -f MakefileLin test`: CHECK
+ *  prints the failed condition and counts it, main() returns the count so
+ *  the run stops at the first failing program. Timings are printed only,
+ *  they depend on the machine and never fail a test. */
+namespace GLVM::test
+{
+	inline int failures = 0;
+
+	///< Milliseconds since _start.
+	inline double ElapsedMs(std::chrono::steady_clock::time_point _start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+	}
+}
+
+#define CHECK(condition)                                                                   \
+	do {                                                                                   \
+		if (!(condition)) {                                                                \
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);    \
+			++GLVM::test::failures;                                                        \
+		}                                                                                  \
+	} while (0)
+
+#endif
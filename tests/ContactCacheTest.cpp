@@ -0,0 +1,140 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "ComponentsFullSet.hpp"
+#include "ContactCache.hpp"
+#include "EntityManager.hpp"
+#include "Event.hpp"
+#include "EventsStack.hpp"
+#include "Systems/CollisionSystem.hpp"
+#include "Systems/MovementSystem.hpp"
+#include "Systems/PhysicsSystem.hpp"
+#include "Check.hpp"
+#include <vector>
+
+GLVM::core::CEvent g_eEvent;
+
+namespace
+{
+	using namespace GLVM;
+	namespace cm = GLVM::ecs::components;
+
+	unsigned int CountEvents(const ecs::CContactCache& _cache, ecs::EContactEvent _type) {
+		unsigned int count = 0;
+		for (unsigned int i = 0; i < _cache.GetEvents().GetSize(); ++i)
+			count += _cache.GetEvents()[i].type == _type;
+		return count;
+	}
+
+	void CheckEvents() {
+		ecs::CContactCache cache;
+		core::vector<unsigned char> resting;
+		resting.Resize(8);
+		for (unsigned int i = 0; i < 8; ++i)
+			resting[i] = 0;
+
+		cache.Begin();
+		cache.Add(2, 1, vec3(0.0f, 1.0f, 0.0f), 0.25f);
+		cache.Add(3, 4, vec3(1.0f, 0.0f, 0.0f), 0.5f);
+		cache.Add(5, 6, vec3(0.0f, 0.0f, 1.0f), 0.5f);
+		cache.End(resting);
+		CHECK(CountEvents(cache, ecs::eCONTACT_BEGIN) == 3);
+		const ecs::ContactManifold* manifold = cache.Find(2, 1);
+		CHECK(manifold != nullptr && manifold->first == 1 && manifold->normal[1] == -1.0f && manifold->age == 0);
+
+		// Tested again persists, untested between resting bodies is carried over, anything else ends.
+		resting[3] = resting[4] = 1;
+		cache.Begin();
+		cache.Add(1, 2, vec3(0.0f, -1.0f, 0.0f), 0.2f);
+		cache.End(resting);
+		CHECK(CountEvents(cache, ecs::eCONTACT_PERSIST) == 2);
+		CHECK(CountEvents(cache, ecs::eCONTACT_END) == 1);
+		manifold = cache.Find(1, 2);
+		CHECK(manifold != nullptr && manifold->depth == 0.2f && manifold->age == 1);
+		manifold = cache.Find(4, 3);
+		CHECK(manifold != nullptr && manifold->depth == 0.5f && manifold->age == 1);
+		CHECK(cache.Find(5, 6) == nullptr);
+
+		resting[3] = 0;
+		cache.Begin();
+		cache.End(resting);
+		CHECK(CountEvents(cache, ecs::eCONTACT_END) == 2);
+		CHECK(cache.GetManifolds().GetSize() == 0);
+	}
+
+	/// Stacks of four cubes settling on a ground plane, the scene the cache keeps unchanged once asleep.
+	void CheckRestingStacks(ecs::CCollisionSystem::EBroadphase _broadphase) {
+		ecs::ComponentManager* componentManager = ecs::ComponentManager::GetInstance();
+		ecs::EntityManager* entityManager = ecs::EntityManager::GetInstance();
+
+		Entity ground = entityManager->CreateEntity();
+		componentManager->CreateComponent<cm::transform, cm::collider>(ground);
+		cm::transform* groundTransform = componentManager->GetComponent<cm::transform>(ground);
+		groundTransform->tPosition = vec3(0.0f, -100.0f, 0.0f);
+		groundTransform->fScale = 100.0f;
+
+		const unsigned int side = 40, height = 4;
+		std::vector<Entity> cubes;
+		for (unsigned int x = 0; x < side; ++x) {
+			for (unsigned int z = 0; z < side; ++z) {
+				for (unsigned int y = 0; y < height; ++y) {
+					Entity cube = entityManager->CreateEntity();
+					componentManager->CreateComponent<cm::transform, cm::collider, cm::rigidBody>(cube);
+					cm::transform* transform = componentManager->GetComponent<cm::transform>(cube);
+					transform->tPosition = vec3(-90.0f + x * 2.0f, 0.5f + y * 0.999f, -90.0f + z * 2.0f);
+					transform->fScale = 0.5f;
+					componentManager->GetComponent<cm::rigidBody>(cube)->fMass_ = 0.1f;
+					cubes.push_back(cube);
+				}
+			}
+		}
+
+		core::CStack stack;
+		float gravity = 0.0f;
+		ecs::CMovementSystem movement(stack);
+		ecs::CCollisionSystem collision(stack);
+		ecs::CPhysicsSystem physics(gravity, stack);
+		collision.broadphase = _broadphase;
+		float step = 1.0f / 60.0f;
+		movement.deltaFrameTime = step;
+		collision.fDelta_Time_ = step;
+		physics.fDelta_Time_ = step;
+
+		const ecs::CContactCache& contacts = collision.GetContacts();
+		for (unsigned int round = 0; round < 4; ++round) {
+			auto start = std::chrono::steady_clock::now();
+			for (unsigned int i = 0; i < 100; ++i) {
+				movement.Update();
+				collision.Update();
+				physics.Update();
+			}
+			std::printf("broadphase %d, steps %3u-%3u: %.2f ms/step, %u awake, %u asleep, %u manifolds, %u begin, %u end\n",
+						int(_broadphase), round * 100, round * 100 + 99, test::ElapsedMs(start) / 100.0, collision.GetAwakeBodies(),
+						collision.GetSleepingBodies(), contacts.GetManifolds().GetSize(),
+						CountEvents(contacts, ecs::eCONTACT_BEGIN), CountEvents(contacts, ecs::eCONTACT_END));
+		}
+
+		// Asleep, every stacked pair is still held, none begins or ends, and the ages keep counting.
+		CHECK(collision.GetSleepingBodies() == cubes.size());
+		CHECK(contacts.GetManifolds().GetSize() >= side * side * height);
+		CHECK(CountEvents(contacts, ecs::eCONTACT_BEGIN) == 0);
+		CHECK(CountEvents(contacts, ecs::eCONTACT_END) == 0);
+		const ecs::ContactManifold* stacked = contacts.Find(cubes[1], cubes[0]);
+		CHECK(stacked != nullptr && stacked->normal[1] == 1.0f && stacked->age >= 300);
+
+		for (Entity cube : cubes)
+			entityManager->RemoveEntity(cube, componentManager);
+		entityManager->RemoveEntity(ground, componentManager);
+	}
+}
+
+int main()
+{
+	CheckEvents();
+	CheckRestingStacks(ecs::CCollisionSystem::eSPATIAL_HASH);
+	CheckRestingStacks(ecs::CCollisionSystem::eSWEEP_AND_PRUNE);
+
+	return test::failures;
+}
@@ -0,0 +1,101 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "ComponentsFullSet.hpp"
+#include "EntityManager.hpp"
+#include "Event.hpp"
+#include "EventsStack.hpp"
+#include "Systems/CollisionSystem.hpp"
+#include "Systems/ProjectileSystem.hpp"
+#include "Check.hpp"
+
+GLVM::core::CEvent g_eEvent;
+
+namespace
+{
+	using namespace GLVM;
+	namespace cm = GLVM::ecs::components;
+
+	struct Hit
+	{
+		int target = 0;          ///< 1 the thin cube, 2 the large one behind it, 0 none.
+		float impactZ = 0.0f;
+	};
+
+	/// Fires a projectile down -z at a 0.04 wide cube standing in front of a large one.
+	Hit Fire(double _framesPerSecond, bool _bullet) {
+		ecs::ComponentManager* componentManager = ecs::ComponentManager::GetInstance();
+		ecs::EntityManager* entityManager = ecs::EntityManager::GetInstance();
+
+		Entity thin = entityManager->CreateEntity();
+		componentManager->CreateComponent<cm::transform, cm::collider>(thin);
+		componentManager->GetComponent<cm::transform>(thin)->tPosition = vec3(0.0f, 0.0f, -3.0f);
+		componentManager->GetComponent<cm::transform>(thin)->fScale = 0.02f;
+
+		Entity large = entityManager->CreateEntity();
+		componentManager->CreateComponent<cm::transform, cm::collider>(large);
+		componentManager->GetComponent<cm::transform>(large)->tPosition = vec3(0.0f, 0.0f, -8.0f);
+
+		Entity projectile = entityManager->CreateEntity();
+		componentManager->CreateComponent<cm::projectile, cm::transform, cm::material, cm::mesh, cm::collider, cm::pointLight>(projectile);
+		cm::transform* transform = componentManager->GetComponent<cm::transform>(projectile);
+		transform->fScale = 0.1f;
+		componentManager->GetComponent<cm::collider>(projectile)->bBullet_ = _bullet;
+
+		core::CStack stack;
+		ecs::CProjectileSystem projectiles(stack);
+		ecs::CCollisionSystem collision(stack);
+		collision.broadphase = ecs::CCollisionSystem::eSWEEP_AND_PRUNE;
+		projectiles.deltaFrameTime = float(1.0 / _framesPerSecond);
+		collision.fDelta_Time_ = float(1.0 / _framesPerSecond);
+
+		auto touched = [&](Entity _entity) {
+			cm::collider* collider = componentManager->GetComponent<cm::collider>(_entity);
+			return collider->bWall_Collision_ || collider->bGround_Collision_;
+		};
+
+		Hit hit;
+		for (int step = 0; step < int(4 * _framesPerSecond); ++step) {
+			projectiles.Update();
+			// A projectile that hit something is removed by the system on its next update.
+			if (componentManager->GetComponent<cm::projectile>(projectile) == nullptr)
+				break;
+			collision.Update();
+
+			cm::collider* collider = componentManager->GetComponent<cm::collider>(projectile);
+			if (hit.target == 0 && touched(projectile)) {
+				hit.target = touched(thin) ? 1 : 2;
+				float startZ = transform->tPosition[2] - collider->tSweep_[2];
+				hit.impactZ = startZ + collider->tSweep_[2] * collider->fTimeOfImpact_;
+			}
+		}
+
+		if (componentManager->GetComponent<cm::projectile>(projectile) != nullptr)
+			entityManager->RemoveEntity(projectile, componentManager);
+		entityManager->RemoveEntity(thin, componentManager);
+		entityManager->RemoveEntity(large, componentManager);
+		return hit;
+	}
+}
+
+int main()
+{
+	// Without the sweep a long step jumps over the thin cube, which is what bullets fix.
+	Hit tunnelled = Fire(10.0, false);
+	std::printf("no bullet at 10 FPS: target %d\n", tunnelled.target);
+	CHECK(tunnelled.target == 2);
+
+	Hit reference = Fire(1000.0, true);
+	for (double framesPerSecond : { 10.0, 60.0, 1000.0 }) {
+		Hit hit = Fire(framesPerSecond, true);
+		std::printf("bullet at %4.0f FPS: target %d, impact z %.5f\n", framesPerSecond, hit.target, hit.impactZ);
+		CHECK(hit.target == 1);
+		CHECK(std::fabs(hit.impactZ - reference.impactZ) < 1e-4f);
+	}
+	// The thin cube's front face, less the projectile's half size.
+	CHECK(std::fabs(reference.impactZ - -2.88f) < 1e-4f);
+
+	return test::failures;
+}
@@ -0,0 +1,161 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "VertexMath.hpp"
+#include "Check.hpp"
+#include <random>
+#include <vector>
+
+namespace
+{
+	/// Instances the way BuildInstanceBatches() lays them out: model matrices and world boxes in SoA form.
+	struct Scene
+	{
+		AABB meshBounds{ .min = vec3(-1.0f, -1.0f, -1.0f), .max = vec3(1.0f, 1.0f, 1.0f) };
+		std::vector<mat4> models;
+		std::vector<float> centerX, centerY, centerZ, extentX, extentY, extentZ;
+
+		AABBStream Stream() const {
+			return AABBStream{ centerX.data(), centerY.data(), centerZ.data(), extentX.data(), extentY.data(), extentZ.data() };
+		}
+	};
+
+	/// 20k rotated cubes of varying scale on a 200 x 100 grid around the origin.
+	Scene BuildScene(std::mt19937& _random) {
+		std::uniform_real_distribution<float> component(-1.0f, 1.0f), scale(0.2f, 0.8f);
+		Scene scene;
+		for (int x = -100; x < 100; ++x) {
+			for (int z = -50; z < 50; ++z) {
+				// Scale, rotation and translation folded as SetModelMatrix() does.
+				mat4 model = unitQuaternionToMatrix(normalizeQuaternion(Quaternion{ component(_random), component(_random),
+																					 component(_random), component(_random) }));
+				float uniformScale = scale(_random);
+				for (int row = 0; row < 3; ++row)
+					for (int column = 0; column < 3; ++column)
+						model[row][column] *= uniformScale;
+				model[3][0] = x * 2.0f;
+				model[3][1] = 0.0f;
+				model[3][2] = z * 2.0f;
+				scene.models.push_back(model);
+
+				AABB bounds = TransformAABB(scene.meshBounds, model);
+				vec3 center = Center(bounds), extents = Extents(bounds);
+				scene.centerX.push_back(center[0]);
+				scene.centerY.push_back(center[1]);
+				scene.centerZ.push_back(center[2]);
+				scene.extentX.push_back(extents[0]);
+				scene.extentY.push_back(extents[1]);
+				scene.extentZ.push_back(extents[2]);
+			}
+		}
+		return scene;
+	}
+
+	/*! Culled must mean invisible: the eight mesh corners in clip space all
+	 *  lie beyond one and the same side of the clip volume. Checked without
+	 *  the frustum planes, from the matrix the shaders use. */
+	unsigned int CountWronglyCulled(const Scene& _scene, const mat4& _viewProjection, const std::vector<unsigned char>& _visible,
+									bool _farPlane) {
+		unsigned int wrong = 0;
+		for (size_t i = 0; i < _visible.size(); ++i) {
+			if (_visible[i] != 0)
+				continue;
+
+			unsigned int outside = 0x3f;    // -x, +x, -y, +y, -z, +z, cleared by any corner not beyond them.
+			for (int corner = 0; corner < 8; ++corner) {
+				float local[4] = { corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, corner & 4 ? 1.0f : -1.0f, 1.0f };
+				float world[4] = {}, clip[4] = {};
+				for (int column = 0; column < 4; ++column)
+					for (int row = 0; row < 4; ++row)
+						world[column] += local[row] * _scene.models[i][row][column];
+				for (int column = 0; column < 4; ++column)
+					for (int row = 0; row < 4; ++row)
+						clip[column] += world[row] * _viewProjection[row][column];
+
+				unsigned int beyond = 0;
+				for (int axis = 0; axis < 3; ++axis) {
+					beyond |= unsigned(clip[axis] < -clip[3]) << (axis * 2);
+					beyond |= unsigned(clip[axis] > clip[3]) << (axis * 2 + 1);
+				}
+				outside &= beyond;
+			}
+			if (!_farPlane)
+				outside &= ~0x20u;
+			wrong += outside == 0;
+		}
+		return wrong;
+	}
+
+	unsigned int CountVisible(const std::vector<unsigned char>& _visible) {
+		unsigned int visibleNumber = 0;
+		for (unsigned char visible : _visible)
+			visibleNumber += visible;
+		return visibleNumber;
+	}
+
+	void CheckFrustumPass(const Scene& _scene, const char* _name, const mat4& _viewProjection, bool _farPlane) {
+		std::vector<unsigned char> visible(_scene.models.size());
+		auto start = std::chrono::steady_clock::now();
+		CullAABBs(Frustum::FromViewProjection(_viewProjection), _scene.Stream(), visible.size(), visible.data());
+		double cullMs = GLVM::test::ElapsedMs(start);
+
+		unsigned int visibleNumber = CountVisible(visible);
+		unsigned int wrong = CountWronglyCulled(_scene, _viewProjection, visible, _farPlane);
+		std::printf("%-11s drawn %5u, culled %5u in %.3f ms, %u culled but visible\n", _name, visibleNumber,
+					unsigned(visible.size()) - visibleNumber, cullMs, wrong);
+		CHECK(visibleNumber > 0 && visibleNumber < visible.size());
+		CHECK(wrong == 0);
+	}
+
+	/// The point light range against the exact box to center distance, in double.
+	void CheckRangePass(const Scene& _scene, const Sphere& _range) {
+		std::vector<unsigned char> visible(_scene.models.size());
+		auto start = std::chrono::steady_clock::now();
+		CullAABBs(_range, _scene.Stream(), visible.size(), visible.data());
+		double cullMs = GLVM::test::ElapsedMs(start);
+
+		unsigned int mismatches = 0;
+		for (size_t i = 0; i < visible.size(); ++i) {
+			double dx = std::max(std::fabs(double(_scene.centerX[i]) - _range.center[0]) - _scene.extentX[i], 0.0);
+			double dy = std::max(std::fabs(double(_scene.centerY[i]) - _range.center[1]) - _scene.extentY[i], 0.0);
+			double dz = std::max(std::fabs(double(_scene.centerZ[i]) - _range.center[2]) - _scene.extentZ[i], 0.0);
+			double distanceSquared = dx * dx + dy * dy + dz * dz, radiusSquared = double(_range.radius) * _range.radius;
+			// Boxes within rounding of the boundary may go either way.
+			if (std::fabs(distanceSquared - radiusSquared) > 1e-3 * radiusSquared)
+				mismatches += (visible[i] != 0) != (distanceSquared <= radiusSquared);
+		}
+
+		unsigned int visibleNumber = CountVisible(visible);
+		std::printf("%-11s drawn %5u, culled %5u in %.3f ms, %u mismatches\n", "point", visibleNumber,
+					unsigned(visible.size()) - visibleNumber, cullMs, mismatches);
+		CHECK(visibleNumber > 0 && visibleNumber < visible.size());
+		CHECK(mismatches == 0);
+	}
+}
+
+/*! The CPU side of the per-pass culling: instance bounds from bind-pose
+ *  bounds and model matrices, then the camera, shadow and point light
+ *  volumes. Packing the survivors and drawing them needs a GL context. */
+int main()
+{
+	std::mt19937 random(11);
+	Scene scene = BuildScene(random);
+
+	mat4 cameraView = LookAtMain(vec3(0.0f, 2.0f, 0.0f), vec3(0.0f, 2.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f));
+	mat4 cameraProjection = Perspective<float>(Radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+	CheckFrustumPass(scene, "camera", cameraView * cameraProjection, false);
+
+	mat4 directionalView = LookAtMain(vec3(-20.0f, 30.0f, -20.0f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+	mat4 directionalProjection = ortho<float>(-20.0f, 20.0f, -20.0f, 20.0f, 1.0f, 80.0f);
+	CheckFrustumPass(scene, "directional", directionalView * directionalProjection, true);
+
+	mat4 spotView = LookAtMain(vec3(10.0f, 15.0f, 10.0f), vec3(10.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+	mat4 spotProjection = Perspective<float>(Radians(60.0f), 1.0f, 0.1f, 50.0f);
+	CheckFrustumPass(scene, "spot", spotView * spotProjection, false);
+
+	CheckRangePass(scene, Sphere{ .center = vec3(5.0f, 3.0f, 5.0f), .radius = 25.0f });
+
+	return GLVM::test::failures;
+}
@@ -0,0 +1,168 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "DynamicAABBTree.hpp"
+#include "Check.hpp"
+#include <random>
+#include <set>
+#include <vector>
+
+namespace
+{
+	using namespace GLVM;
+
+	/// Boxes by user data, proxy -1 for the ones destroyed.
+	struct Population
+	{
+		std::vector<AABB> boxes;
+		std::vector<int> proxies;
+	};
+
+	/// Closest exact box along the segment, the per-ray loop the tree replaced.
+	core::RaycastHit BruteForceRaycast(const Population& _population, const core::Ray& _ray) {
+		core::RaycastHit hit;
+		for (unsigned int i = 0; i < _population.boxes.size(); ++i) {
+			float tEnter;
+			if (_population.proxies[i] >= 0 && IntersectSegmentAABB(_ray.origin, _ray.delta, _population.boxes[i], tEnter) &&
+				(hit.proxy < 0 || tEnter < hit.t)) {
+				hit.proxy = _population.proxies[i];
+				hit.t = tEnter;
+				hit.userData = i;
+			}
+		}
+		return hit;
+	}
+
+	void CheckAgainstBruteForce(const core::CDynamicAABBTree& _tree, const Population& _population, std::mt19937& _random) {
+		std::uniform_real_distribution<float> position(-50.0f, 50.0f), direction(-1.0f, 1.0f);
+
+		unsigned int queryMismatches = 0;
+		for (unsigned int q = 0; q < 200; ++q) {
+			AABB query = AABBFromCenter(vec3(position(_random), position(_random), position(_random)), 5.0f);
+			core::vector<int> found;
+			_tree.QueryAABB(query, found);
+
+			std::set<unsigned int> treeSet, bruteSet;
+			for (unsigned int i = 0; i < found.GetSize(); ++i)
+				treeSet.insert(_tree.GetUserData(found[i]));
+			for (unsigned int i = 0; i < _population.boxes.size(); ++i)
+				if (_population.proxies[i] >= 0 && Overlaps(_population.boxes[i], query))
+					bruteSet.insert(i);
+			queryMismatches += treeSet != bruteSet || treeSet.size() != found.GetSize();
+		}
+
+		std::vector<core::Ray> rays;
+		for (unsigned int r = 0; r < 2000; ++r)
+			rays.push_back(core::Ray{ .origin = vec3(position(_random), position(_random), position(_random)),
+									  .delta = vec3(direction(_random), direction(_random), direction(_random)) * 20.0f });
+		std::vector<core::RaycastHit> hits(rays.size());
+		_tree.RaycastBatch(rays.data(), rays.size(), hits.data());
+
+		// Equal entry times may pick either box, the closest distance has to agree.
+		unsigned int rayMismatches = 0;
+		for (unsigned int r = 0; r < rays.size(); ++r) {
+			core::RaycastHit reference = BruteForceRaycast(_population, rays[r]);
+			rayMismatches += (hits[r].proxy >= 0) != (reference.proxy >= 0) || hits[r].t != reference.t;
+		}
+
+		std::printf("queries: %u mismatches, rays: %u mismatches\n", queryMismatches, rayMismatches);
+		CHECK(queryMismatches == 0);
+		CHECK(rayMismatches == 0);
+	}
+
+	/// Random create, move and destroy, the tree valid after every single one.
+	void CheckRandomOperations(std::mt19937& _random) {
+		std::uniform_real_distribution<float> position(-50.0f, 50.0f), extent(0.2f, 3.0f), step(-1.0f, 1.0f);
+		core::CDynamicAABBTree tree(0.2f);
+		Population population;
+
+		unsigned int invalidAfter = 0, operations = 0;
+		for (unsigned int i = 0; i < 1000; ++i) {
+			population.boxes.push_back(AABBFromCenter(vec3(position(_random), position(_random), position(_random)), extent(_random)));
+			population.proxies.push_back(tree.CreateProxy(population.boxes.back(), i));
+			invalidAfter += !tree.Validate();
+			++operations;
+		}
+
+		for (unsigned int k = 0; k < 20000; ++k) {
+			unsigned int i = _random() % population.boxes.size();
+			if (population.proxies[i] < 0) {
+				population.proxies[i] = tree.CreateProxy(population.boxes[i], i);
+			} else if (k % 10 == 0) {
+				tree.DestroyProxy(population.proxies[i]);
+				population.proxies[i] = -1;
+			} else {
+				vec3 center = Center(population.boxes[i]) + vec3(step(_random), step(_random), step(_random)) * (k % 7 == 0 ? 10.0f : 1.0f);
+				population.boxes[i] = AABBFromCenter(center, Extents(population.boxes[i])[0]);
+				tree.MoveProxy(population.proxies[i], population.boxes[i]);
+			}
+			invalidAfter += !tree.Validate();
+			++operations;
+		}
+
+		int alive = 0;
+		for (int proxy : population.proxies)
+			alive += proxy >= 0;
+
+		std::printf("tree: %u operations, %u left it invalid, %d proxies, height %d\n", operations, invalidAfter,
+					tree.GetProxiesNumber(), tree.GetHeight());
+		CHECK(invalidAfter == 0);
+		CHECK(tree.GetProxiesNumber() == alive);
+		// Balanced, far below the 1000 of a degenerate chain.
+		CHECK(tree.GetHeight() < 40);
+
+		CheckAgainstBruteForce(tree, population, _random);
+
+		for (int& proxy : population.proxies) {
+			if (proxy >= 0)
+				tree.DestroyProxy(proxy);
+			proxy = -1;
+		}
+		CHECK(tree.GetProxiesNumber() == 0 && tree.Validate());
+	}
+
+	/// A frame of projectile rays through the tree against every ray testing every box.
+	void Benchmark(std::mt19937& _random) {
+		std::uniform_real_distribution<float> position(-150.0f, 150.0f), direction(-1.0f, 1.0f);
+		core::CDynamicAABBTree tree;
+		Population population;
+		for (unsigned int i = 0; i < 20000; ++i) {
+			population.boxes.push_back(AABBFromCenter(vec3(position(_random), position(_random) * 0.2f, position(_random)), 0.5f));
+			population.proxies.push_back(tree.CreateProxy(population.boxes.back(), i));
+		}
+
+		std::vector<core::Ray> rays;
+		for (unsigned int r = 0; r < 500; ++r)
+			rays.push_back(core::Ray{ .origin = vec3(position(_random), position(_random) * 0.2f, position(_random)),
+									  .delta = Normalize(vec3(direction(_random), direction(_random), direction(_random))) });
+		std::vector<core::RaycastHit> hits(rays.size()), reference(rays.size());
+
+		auto start = std::chrono::steady_clock::now();
+		tree.RaycastBatch(rays.data(), rays.size(), hits.data());
+		double treeMs = GLVM::test::ElapsedMs(start);
+
+		start = std::chrono::steady_clock::now();
+		for (unsigned int r = 0; r < rays.size(); ++r)
+			reference[r] = BruteForceRaycast(population, rays[r]);
+		double loopMs = GLVM::test::ElapsedMs(start);
+
+		unsigned int mismatches = 0;
+		for (unsigned int r = 0; r < rays.size(); ++r)
+			mismatches += (hits[r].proxy >= 0) != (reference[r].proxy >= 0) || hits[r].t != reference[r].t;
+
+		std::printf("%zu rays against %zu boxes: tree %.3f ms, per-ray loop %.3f ms\n", rays.size(), population.boxes.size(), treeMs, loopMs);
+		CHECK(mismatches == 0);
+	}
+}
+
+int main()
+{
+	std::mt19937 random(7);
+
+	CheckRandomOperations(random);
+	Benchmark(random);
+
+	return GLVM::test::failures;
+}
@@ -0,0 +1,276 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#ifndef TESTS_FAKE_GL
+#define TESTS_FAKE_GL
+
+// The loader pointers are defined here, so a test links the GL wrappers without GLPointer.c and libGL.
+#define INIT_EXT
+#include "GLPointer.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*! In-memory stand-in for the driver behind the loader pointers, enough
+ *  for the GL wrappers to run headless. Install() points only the entry
+ *  points faked here, any other stays null and crashes the test at once
+ *  rather than pass unnoticed. Include it in one test source only. */
+namespace GLVM::test::gl
+{
+	/// An active uniform as glGetActiveUniform() lists it, block members carry their block index.
+	struct Uniform
+	{
+		std::string name;
+		GLint size = 1;
+		GLint block = -1;
+	};
+
+	inline std::vector<Uniform> programUniforms;       ///< Reported by every program linked next.
+	inline std::vector<std::string> shaderSources;     ///< Source of every shader created, by id - 1.
+	inline unsigned int locationQueries = 0;
+	inline std::vector<std::pair<GLint, GLint>> intUploads;   ///< Location and value of every glUniform1i().
+
+	/// Location the driver gives a name: 100 apart per active uniform, plus the element of a plain array.
+	inline GLint LocationOf(const std::string& name) {
+		for ( GLint i = 0; i < (GLint)programUniforms.size(); ++i ) {
+			const Uniform& uniform = programUniforms[i];
+			if ( uniform.block != -1 )
+				continue;
+			if ( name == uniform.name )
+				return 100 * i;
+			if ( uniform.name.size() < 3 || uniform.name.compare(uniform.name.size() - 3, 3, "[0]") != 0 )
+				continue;
+			std::string base = uniform.name.substr(0, uniform.name.size() - 3);
+			if ( name == base )
+				return 100 * i;
+			for ( GLint element = 1; element < uniform.size; ++element )
+				if ( name == base + "[" + std::to_string(element) + "]" )
+					return 100 * i + element;
+		}
+		return -1;
+	}
+
+	inline GLuint CreateShader(GLenum) {
+		shaderSources.emplace_back();
+		return shaderSources.size();
+	}
+
+	inline void ShaderSource(GLuint shader, GLsizei count, const GLchar** strings, const GLint*) {
+		shaderSources[shader - 1].clear();
+		for ( GLsizei i = 0; i < count; ++i )
+			shaderSources[shader - 1] += strings[i];
+	}
+
+	inline GLuint CreateProgram() { return 1; }
+	inline void NoShaderCall(GLuint) {}
+	inline void AttachShader(GLuint, GLuint) {}
+
+	inline void GetShaderiv(GLuint, GLenum, GLint* params) { *params = GL_TRUE; }
+
+	inline void GetProgramiv(GLuint, GLenum pname, GLint* params) {
+		switch ( pname ) {
+		case GL_ACTIVE_UNIFORMS:
+			*params = programUniforms.size();
+			break;
+		case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+			*params = 1;
+			for ( const Uniform& uniform : programUniforms )
+				*params = std::max<GLint>(*params, uniform.name.size() + 1);
+			break;
+		default:
+			*params = GL_TRUE;
+		}
+	}
+
+	inline void GetActiveUniformsiv(GLuint, GLsizei count, const GLuint* indices, GLenum, GLint* params) {
+		for ( GLsizei i = 0; i < count; ++i )
+			params[i] = programUniforms[indices[i]].block;
+	}
+
+	inline void GetActiveUniform(GLuint, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type,
+								 GLchar* name) {
+		const Uniform& uniform = programUniforms[index];
+		*length = std::min<GLsizei>(uniform.name.size(), bufSize - 1);
+		std::memcpy(name, uniform.name.data(), *length);
+		name[*length] = '\0';
+		*size = uniform.size;
+		*type = GL_FLOAT;
+	}
+
+	inline GLint GetUniformLocation(GLuint, const GLchar* name) {
+		++locationQueries;
+		return LocationOf(name);
+	}
+
+	inline void Uniform1i(GLint location, GLint value) {
+		intUploads.emplace_back(location, value);
+	}
+
+	/// Storage of a buffer object, mapped ranges point straight into it.
+	struct Buffer
+	{
+		std::vector<unsigned char> data;
+		bool mapped = false;
+	};
+
+	/// A fence signals once the GPU is done with the frame before it; waiting with a timeout lets it catch up.
+	struct Fence
+	{
+		bool signaled = false;
+		bool deleted = false;
+	};
+
+	inline std::map<GLuint, Buffer> buffers;
+	inline std::map<GLenum, GLuint> boundBuffers;
+	inline GLuint nextBuffer = 1;
+	inline std::map<GLuint, GLuint> vertexArrays;       ///< Element array buffer each vertex array records.
+	inline GLuint boundVertexArray = 0;
+	inline unsigned long copiedBytes = 0;
+	inline std::vector<Fence> fences;
+	/// Fences the GPU trails the CPU by: the fence made on frame n signals when the one of frame n + gpuFramesBehind is made.
+	inline unsigned int gpuFramesBehind = 0;
+
+	inline Buffer& Bound(GLenum target) { return buffers.at(boundBuffers[target]); }
+
+	inline void GenBuffers(GLsizei count, GLuint* ids) {
+		for ( GLsizei i = 0; i < count; ++i ) {
+			ids[i] = nextBuffer++;
+			buffers[ids[i]];
+		}
+	}
+
+	inline void DeleteBuffers(GLsizei count, const GLuint* ids) {
+		for ( GLsizei i = 0; i < count; ++i )
+			buffers.erase(ids[i]);
+	}
+
+	inline void BindBuffer(GLenum target, GLuint buffer) {
+		boundBuffers[target] = buffer;
+		if ( target == GL_ELEMENT_ARRAY_BUFFER && boundVertexArray != 0 )
+			vertexArrays[boundVertexArray] = buffer;
+	}
+
+	inline void GenVertexArrays(GLsizei count, GLuint* ids) {
+		for ( GLsizei i = 0; i < count; ++i ) {
+			ids[i] = nextBuffer++;
+			vertexArrays[ids[i]] = 0;
+		}
+	}
+
+	inline void DeleteVertexArrays(GLsizei count, const GLuint* ids) {
+		for ( GLsizei i = 0; i < count; ++i )
+			vertexArrays.erase(ids[i]);
+	}
+
+	inline void BindVertexArray(GLuint vertexArray) {
+		boundVertexArray = vertexArray;
+		boundBuffers[GL_ELEMENT_ARRAY_BUFFER] = vertexArray != 0 ? vertexArrays.at(vertexArray) : 0;
+	}
+
+	inline void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data) {
+		std::vector<unsigned char>& storage = Bound(target).data;
+		if ( offset + size <= (GLintptr)storage.size() )
+			std::memcpy(storage.data() + offset, data, size);
+		else
+			storage.clear();                // Out of range is GL_INVALID_VALUE, the lost storage fails the test.
+	}
+
+	inline void CopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset,
+								  GLsizeiptr size) {
+		std::vector<unsigned char>& destination = Bound(writeTarget).data;
+		const std::vector<unsigned char>& source = Bound(readTarget).data;
+		if ( readOffset + size > (GLintptr)source.size() || writeOffset + size > (GLintptr)destination.size() ) {
+			destination.clear();
+			return;
+		}
+		std::memcpy(destination.data() + writeOffset, source.data() + readOffset, size);
+		copiedBytes += size;
+	}
+
+	inline void BufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum) {
+		Bound(target).data.assign(size, 0);
+		if ( data != nullptr )
+			std::memcpy(Bound(target).data.data(), data, size);
+	}
+
+	inline void BufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield) {
+		BufferData(target, size, data, 0);
+	}
+
+	inline void* MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr, GLbitfield) {
+		Bound(target).mapped = true;
+		return Bound(target).data.data() + offset;
+	}
+
+	inline GLboolean UnmapBuffer(GLenum target) {
+		Bound(target).mapped = false;
+		return GL_TRUE;
+	}
+
+	inline GLsync FenceSync(GLenum, GLbitfield) {
+		fences.emplace_back();
+		for ( unsigned int i = 0; i + gpuFramesBehind < fences.size(); ++i )
+			fences[i].signaled = true;
+		return reinterpret_cast<GLsync>(uintptr_t(fences.size()));
+	}
+
+	inline Fence& FenceOf(GLsync sync) { return fences[reinterpret_cast<uintptr_t>(sync) - 1]; }
+
+	inline GLenum ClientWaitSync(GLsync sync, GLbitfield, GLuint64 timeout) {
+		Fence& fence = FenceOf(sync);
+		if ( fence.signaled )
+			return GL_ALREADY_SIGNALED;
+		if ( timeout == 0 )
+			return GL_TIMEOUT_EXPIRED;
+		fence.signaled = true;
+		return GL_CONDITION_SATISFIED;
+	}
+
+	inline void DeleteSync(GLsync sync) { FenceOf(sync).deleted = true; }
+
+	inline void Install() {
+		pGLCreate_Shader = CreateShader;
+		pGLShader_Source = ShaderSource;
+		pGLCompile_Shader = NoShaderCall;
+		pGLDelete_Shader = NoShaderCall;
+		pGLUse_Program = NoShaderCall;
+		pGLLink_Program = NoShaderCall;
+		pGLCreate_Program = CreateProgram;
+		pGLAttach_Shader = AttachShader;
+		pGLGet_Shaderiv = GetShaderiv;
+		pGLGet_Programiv = GetProgramiv;
+		pGLGet_Active_Uniformsiv = GetActiveUniformsiv;
+		pGLGet_Active_Uniform = GetActiveUniform;
+		pGLGet_Uniform_Location = GetUniformLocation;
+		pGLUniform1i = Uniform1i;
+		pGLGen_Buffers = GenBuffers;
+		pGLDelete_Buffers = DeleteBuffers;
+		pGLBind_Buffer = BindBuffer;
+		pGLBuffer_Data = BufferData;
+		pGLBuffer_Storage = BufferStorage;
+		pGLMap_Buffer_Range = MapBufferRange;
+		pGLUnmap_Buffer = UnmapBuffer;
+		pGLFence_Sync = FenceSync;
+		pGLClient_Wait_Sync = ClientWaitSync;
+		pGLDelete_Sync = DeleteSync;
+		pGLGen_Vertex_Arrays = GenVertexArrays;
+		pGLDelete_Vertex_Arrays = DeleteVertexArrays;
+		pGLBind_Vertex_Array = BindVertexArray;
+		pGLBuffer_Sub_Data = BufferSubData;
+		pGLCopy_Buffer_Sub_Data = CopyBufferSubData;
+	}
+}
+
+/// Whatever the test asks the context for, it has it.
+EXTERN_C int GLSupports(int, int, const char*)
+{
+	return 1;
+}
+
+#endif
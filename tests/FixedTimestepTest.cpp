@@ -0,0 +1,107 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "ComponentsFullSet.hpp"
+#include "EntityManager.hpp"
+#include "Event.hpp"
+#include "EventsStack.hpp"
+#include "FixedTimestep.hpp"
+#include "Systems/CollisionSystem.hpp"
+#include "Systems/MovementSystem.hpp"
+#include "Systems/PhysicsSystem.hpp"
+#include "Check.hpp"
+#include <algorithm>
+#include <vector>
+
+GLVM::core::CEvent g_eEvent;
+
+namespace
+{
+	using namespace GLVM;
+	namespace cm = GLVM::ecs::components;
+
+	void CheckAccumulator() {
+		core::CFixedTimestep timestep(0.01, 5);
+
+		CHECK(timestep.Advance(0.025) == 2);
+		CHECK(std::fabs(timestep.GetAlpha() - 0.5f) < 1e-4f);
+		CHECK(timestep.Advance(0.004) == 0);
+		CHECK(timestep.Advance(0.002) == 1);
+
+		// A stall runs the substep limit once and drops the rest instead of catching up.
+		CHECK(timestep.Advance(1.0) == 5);
+		CHECK(timestep.GetAlpha() < 1.0f);
+		CHECK(timestep.Advance(0.0) == 0);
+	}
+
+	/// Heights of a rigid body dropped on a ground plane, one per simulated step.
+	std::vector<float> DropTrajectory(double _framesPerSecond) {
+		ecs::ComponentManager* componentManager = ecs::ComponentManager::GetInstance();
+		ecs::EntityManager* entityManager = ecs::EntityManager::GetInstance();
+
+		Entity ground = entityManager->CreateEntity();
+		componentManager->CreateComponent<cm::transform, cm::collider>(ground);
+		cm::transform* groundTransform = componentManager->GetComponent<cm::transform>(ground);
+		groundTransform->tPosition = vec3(0.0f, -5.0f, 0.0f);
+		groundTransform->fScale = 4.0f;
+
+		Entity body = entityManager->CreateEntity();
+		componentManager->CreateComponent<cm::transform, cm::collider, cm::rigidBody>(body);
+		cm::transform* bodyTransform = componentManager->GetComponent<cm::transform>(body);
+		bodyTransform->tPosition = vec3(0.0f, 5.0f, 0.0f);
+		bodyTransform->fScale = 0.5f;
+		componentManager->GetComponent<cm::rigidBody>(body)->fMass_ = 1.0f;
+
+		core::CStack stack;
+		float gravity = 0.0f;
+		ecs::CMovementSystem movement(stack);
+		ecs::CCollisionSystem collision(stack);
+		ecs::CPhysicsSystem physics(gravity, stack);
+		core::CFixedTimestep timestep;
+		std::vector<float> heights;
+
+		for (double time = 0.0; time < 3.0; time += 1.0 / _framesPerSecond) {
+			unsigned int steps = timestep.Advance(1.0 / _framesPerSecond);
+			for (unsigned int i = 0; i < steps; ++i) {
+				float step = timestep.GetStep();
+				movement.deltaFrameTime = step;
+				collision.fDelta_Time_ = step;
+				physics.fDelta_Time_ = step;
+				movement.Update();
+				collision.Update();
+				physics.Update();
+				heights.push_back(componentManager->GetComponent<cm::transform>(body)->tPosition[1]);
+			}
+		}
+
+		entityManager->RemoveEntity(body, componentManager);
+		entityManager->RemoveEntity(ground, componentManager);
+		return heights;
+	}
+
+	/// The same steps have to come out whatever the frame rate cuts them into.
+	void CheckFrameRateIndependence() {
+		std::vector<float> slow = DropTrajectory(30.0), medium = DropTrajectory(144.0), fast = DropTrajectory(1000.0);
+		size_t compared = std::min({ slow.size(), medium.size(), fast.size() });
+
+		unsigned int differences = 0;
+		for (size_t i = 0; i < compared; ++i)
+			differences += slow[i] != medium[i] || slow[i] != fast[i];
+
+		std::printf("fixed timestep: %zu/%zu/%zu steps at 30/144/1000 FPS, %u differences, final height %f\n",
+					slow.size(), medium.size(), fast.size(), differences, compared > 0 ? slow[compared - 1] : 0.0f);
+		CHECK(compared >= 170);
+		CHECK(differences == 0);
+		CHECK(compared > 0 && slow[compared - 1] < 5.0f);
+	}
+}
+
+int main()
+{
+	CheckAccumulator();
+	CheckFrameRateIndependence();
+
+	return GLVM::test::failures;
+}
@@ -0,0 +1,147 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "VertexMath.hpp"
+#include "Check.hpp"
+#include <random>
+#include <vector>
+
+namespace
+{
+	/// Boxes in SoA form, the layout CullAABBs reads.
+	struct BoxStream
+	{
+		std::vector<float> centerX, centerY, centerZ, extentX, extentY, extentZ;
+
+		explicit BoxStream(unsigned int _count, std::mt19937& _random)
+			: centerX(_count), centerY(_count), centerZ(_count), extentX(_count), extentY(_count), extentZ(_count) {
+			std::uniform_real_distribution<float> position(-100.0f, 100.0f), extent(0.1f, 5.0f);
+			for (unsigned int i = 0; i < _count; ++i) {
+				centerX[i] = position(_random);
+				centerY[i] = position(_random);
+				centerZ[i] = position(_random);
+				extentX[i] = extent(_random);
+				extentY[i] = extent(_random);
+				extentZ[i] = extent(_random);
+			}
+		}
+
+		AABBStream Stream() const {
+			return AABBStream{ centerX.data(), centerY.data(), centerZ.data(), extentX.data(), extentY.data(), extentZ.data() };
+		}
+
+		AABB Box(unsigned int _index) const {
+			return AABB{ .min = vec3(centerX[_index] - extentX[_index], centerY[_index] - extentY[_index], centerZ[_index] - extentZ[_index]),
+						 .max = vec3(centerX[_index] + extentX[_index], centerY[_index] + extentY[_index], centerZ[_index] + extentZ[_index]) };
+		}
+	};
+
+	void CheckKnownPlanes() {
+		mat4 view = LookAtMain(vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f));
+
+		// The perspective has an infinite far plane, which must never cull.
+		mat4 projection = Perspective<float>(Radians(60.0f), 1.0f, 0.1f, 100.0f);
+		Frustum perspective = Frustum::FromViewProjection(view * projection);
+		CHECK(perspective.Intersects(AABBFromCenter(vec3(0.0f, 0.0f, -10.0f), 0.5f)));
+		CHECK(!perspective.Intersects(AABBFromCenter(vec3(0.0f, 0.0f, 10.0f), 0.5f)));
+		CHECK(perspective.Intersects(AABBFromCenter(vec3(0.0f, 0.0f, -200.0f), 0.5f)));
+		CHECK(!perspective.Intersects(AABBFromCenter(vec3(50.0f, 0.0f, -10.0f), 0.5f)));
+
+		projection = ortho<float>(-10.0f, 10.0f, -10.0f, 10.0f, 0.1f, 50.0f);
+		Frustum orthographic = Frustum::FromViewProjection(view * projection);
+		CHECK(orthographic.Intersects(AABBFromCenter(vec3(0.0f, 0.0f, -10.0f), 0.5f)));
+		CHECK(!orthographic.Intersects(AABBFromCenter(vec3(0.0f, 0.0f, -60.0f), 0.5f)));
+		CHECK(!orthographic.Intersects(AABBFromCenter(vec3(12.0f, 0.0f, -10.0f), 0.5f)));
+		CHECK(orthographic.Intersects(Sphere{ .center = vec3(10.4f, 0.0f, -10.0f), .radius = 0.5f }));
+
+		float tEnter = 0.0f;
+		CHECK(IntersectSegmentAABB(vec3(0.0f, 0.0f, 5.0f), vec3(0.0f, 0.0f, -10.0f), AABBFromCenter(vec3(0.0f, 0.0f, 0.0f), 1.0f), tEnter));
+		CHECK(std::fabs(tEnter - 0.4f) < 1e-6f);
+		CHECK(!IntersectSegmentAABB(vec3(0.0f, 0.0f, 5.0f), vec3(0.0f, 0.0f, -1.0f), AABBFromCenter(vec3(0.0f, 0.0f, 0.0f), 1.0f), tEnter));
+	}
+
+	/// Arvo's bounds have to equal the bounds of the eight transformed corners.
+	void CheckTransformAABB(std::mt19937& _random) {
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f), extent(0.1f, 5.0f);
+		float maxError = 0.0f;
+
+		for (int k = 0; k < 1000; ++k) {
+			Quaternion rotation = normalizeQuaternion(Quaternion{ position(_random), position(_random), position(_random), position(_random) });
+			mat4 model = unitQuaternionToMatrix(rotation);
+			for (int row = 0; row < 3; ++row)
+				for (int column = 0; column < 3; ++column)
+					model[row][column] *= extent(_random);
+			model[3][0] = position(_random);
+			model[3][1] = position(_random);
+			model[3][2] = position(_random);
+
+			AABB local{ .min = vec3(-extent(_random), -extent(_random), -extent(_random)),
+						.max = vec3(extent(_random), extent(_random), extent(_random)) };
+			AABB world = TransformAABB(local, model);
+
+			float cornersMin[3] = { 1e9f, 1e9f, 1e9f }, cornersMax[3] = { -1e9f, -1e9f, -1e9f };
+			for (int corner = 0; corner < 8; ++corner) {
+				float point[3] = { corner & 1 ? local.max[0] : local.min[0], corner & 2 ? local.max[1] : local.min[1],
+								   corner & 4 ? local.max[2] : local.min[2] };
+				for (int column = 0; column < 3; ++column) {
+					float value = model[3][column];
+					for (int row = 0; row < 3; ++row)
+						value += point[row] * model[row][column];
+					cornersMin[column] = std::min(cornersMin[column], value);
+					cornersMax[column] = std::max(cornersMax[column], value);
+				}
+			}
+			for (int column = 0; column < 3; ++column) {
+				maxError = std::max(maxError, std::fabs(cornersMin[column] - world.min[column]));
+				maxError = std::max(maxError, std::fabs(cornersMax[column] - world.max[column]));
+			}
+		}
+
+		std::printf("TransformAABB: max error against corners %g\n", maxError);
+		CHECK(maxError < 1e-3f);
+	}
+
+	/// The wide kernels must agree with the scalar plane test on every box, tail included.
+	void CheckWideCulling(std::mt19937& _random) {
+		mat4 view = LookAtMain(vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 1.0f, 0.0f));
+		mat4 projection = Perspective<float>(Radians(60.0f), 1.0f, 0.1f, 100.0f);
+		Frustum frustum = Frustum::FromViewProjection(view * projection);
+
+		const unsigned int count = 1000003;
+		BoxStream boxes(count, _random);
+		std::vector<unsigned char> visible(count), scalarVisible(count);
+
+		auto start = std::chrono::steady_clock::now();
+		CullAABBs(frustum, boxes.Stream(), count, visible.data());
+		double wideMs = GLVM::test::ElapsedMs(start);
+
+		start = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < count; ++i)
+			scalarVisible[i] = frustum.Intersects(boxes.Box(i)) ? 1 : 0;
+		double scalarMs = GLVM::test::ElapsedMs(start);
+
+		unsigned int mismatches = 0, visibleNumber = 0;
+		for (unsigned int i = 0; i < count; ++i) {
+			mismatches += visible[i] != scalarVisible[i];
+			visibleNumber += visible[i];
+		}
+
+		std::printf("CullAABBs: %u boxes, %u visible, %u mismatches, wide %.2f ms, scalar %.2f ms\n",
+					count, visibleNumber, mismatches, wideMs, scalarMs);
+		CHECK(mismatches == 0);
+		CHECK(visibleNumber > 0 && visibleNumber < count);
+	}
+}
+
+int main()
+{
+	std::mt19937 random(1);
+
+	CheckKnownPlanes();
+	CheckTransformAABB(random);
+	CheckWideCulling(random);
+
+	return GLVM::test::failures;
+}
@@ -0,0 +1,133 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "InstanceBatch.hpp"
+#include "RenderQueue.hpp"
+#include "Check.hpp"
+#include <random>
+#include <set>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+	using namespace GLVM;
+
+	struct Draw
+	{
+		bool skinned;
+		unsigned int mesh, diffuse, specular, depth;
+	};
+
+	/// The renderer's frame setup: keys pushed and sorted, then the batches built in queue order.
+	void Batch(const std::vector<Draw>& _draws, core::CRenderQueue& _queue, std::vector<core::InstanceBatch>& _batches) {
+		_queue.Clear();
+		for ( unsigned int i = 0; i < _draws.size(); ++i ) {
+			const Draw& draw = _draws[i];
+			_queue.Push(core::CRenderQueue::MakeKey(draw.skinned ? core::eSKINNED_MESH_SHADER : core::eSTATIC_MESH_SHADER,
+													draw.diffuse, draw.specular, draw.mesh, draw.depth), i);
+		}
+		_queue.Sort();
+
+		_batches.clear();
+		for ( unsigned int i = 0; i < _queue.GetSize(); ++i ) {
+			const Draw& draw = _draws[_queue[i].value];
+			if ( core::AddToBatches(_batches, i, draw.mesh, draw.diffuse, draw.specular, draw.skinned) && draw.skinned )
+				_batches.back().skinPalette = 0;
+		}
+	}
+
+	/// Counts the batches that break a rule; with _merged every static mesh and texture set makes a single batch.
+	unsigned int BrokenBatches(const std::vector<Draw>& _draws, const core::CRenderQueue& _queue,
+							   const std::vector<core::InstanceBatch>& _batches, bool _merged) {
+		unsigned int broken = 0, next = 0, skinned = 0;
+		bool skinnedSeen = false;
+		std::set<std::tuple<unsigned int, unsigned int, unsigned int>> staticGroups;
+		for ( const core::InstanceBatch& batch : _batches ) {
+			broken += batch.firstInstance != next || batch.instancesNumber == 0;
+			next = batch.firstInstance + batch.instancesNumber;
+			bool batchSkinned = batch.skinPalette >= 0;
+			broken += batchSkinned && batch.instancesNumber != 1;
+			broken += skinnedSeen && !batchSkinned;
+			skinnedSeen |= batchSkinned;
+			skinned += batchSkinned;
+			if ( !batchSkinned )
+				staticGroups.insert({ batch.meshID, batch.diffuseTextureID, batch.specularTextureID });
+
+			unsigned int previousDepth = 0;
+			for ( unsigned int i = batch.firstInstance; i < next && i < _queue.GetSize(); ++i ) {
+				const Draw& draw = _draws[_queue[i].value];
+				broken += draw.skinned != batchSkinned || draw.mesh != batch.meshID || draw.diffuse != batch.diffuseTextureID ||
+					draw.specular != batch.specularTextureID;
+				// Front to back inside a batch.
+				broken += _merged && draw.depth < previousDepth;
+				previousDepth = draw.depth;
+			}
+		}
+		broken += next != _draws.size();
+		broken += _merged && staticGroups.size() + skinned != _batches.size();
+		return broken;
+	}
+
+	void CheckBatches() {
+		std::mt19937 random(43);
+		std::bernoulli_distribution skinned(0.05);
+		core::CRenderQueue queue;
+		std::vector<core::InstanceBatch> batches;
+		unsigned int broken = 0, aliasedBroken = 0;
+		for ( unsigned int trial = 0; trial < 200; ++trial ) {
+			std::uniform_int_distribution<unsigned int> mesh(0, 1 + trial % 40), texture(0, 1 + trial % 7), depth(0, 0xFFFF);
+			std::vector<Draw> draws(1 + trial * 10);
+			for ( Draw& draw : draws )
+				draw = Draw{ skinned(random), mesh(random), texture(random), texture(random), depth(random) };
+			Batch(draws, queue, batches);
+			broken += BrokenBatches(draws, queue, batches, true);
+
+			// Ids past the key fields alias others: the order may interleave them, but no batch may mix them.
+			for ( Draw& draw : draws ) {
+				draw.mesh += (draw.mesh & 1) << 20;
+				draw.diffuse += (draw.diffuse & 2) << 11;
+			}
+			Batch(draws, queue, batches);
+			aliasedBroken += BrokenBatches(draws, queue, batches, false);
+		}
+		CHECK(broken == 0);
+		CHECK(aliasedBroken == 0);
+
+		// One mesh, one texture set: the whole crowd in one batch, a skinned instance splits nothing else.
+		std::vector<Draw> crowd(10000, Draw{ false, 3, 1, 2, 0 });
+		crowd[5000].skinned = true;
+		Batch(crowd, queue, batches);
+		CHECK(batches.size() == 2 && batches[0].instancesNumber == 9999 && batches[1].skinPalette == 0);
+	}
+
+	/// Batches of the renderer's frames, with the draws the per entity loop issued before.
+	void Benchmark() {
+		std::mt19937 random(44);
+		std::uniform_int_distribution<unsigned int> mesh(0, 3), texture(0, 3), depth(0, 0xFFFF);
+		std::vector<Draw> draws(100000);
+		for ( Draw& draw : draws )
+			draw = Draw{ false, mesh(random), texture(random), texture(random), depth(random) };
+		core::CRenderQueue queue;
+		std::vector<core::InstanceBatch> batches;
+		double bestMs = 1e9;
+		for ( unsigned int round = 0; round < 5; ++round ) {
+			auto start = std::chrono::steady_clock::now();
+			Batch(draws, queue, batches);
+			bestMs = std::min(bestMs, test::ElapsedMs(start));
+		}
+		std::printf("%zu draws over 4 meshes and 4 textures: %zu batches, keyed, sorted and batched in %.3f ms\n",
+					draws.size(), batches.size(), bestMs);
+		CHECK(batches.size() <= 4 * 4 * 4);
+	}
+}
+
+int main()
+{
+	CheckBatches();
+	Benchmark();
+
+	return test::failures;
+}
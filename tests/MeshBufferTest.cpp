@@ -0,0 +1,176 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "FakeGL.hpp"
+#include "MeshBuffer.hpp"
+#include "InstanceBatch.hpp"
+#include "RenderQueue.hpp"
+#include "Check.hpp"
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace
+{
+	using namespace GLVM;
+
+	constexpr unsigned int kVertexFloats = 16;        ///< kMeshVertexStride of the renderer, in floats.
+
+	struct Mesh
+	{
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		core::MeshRange range;
+	};
+
+	/// Vertex the GPU fetches for index i of the mesh: through the VAO's element buffer, then base vertex.
+	bool DrawsLikeSource(const Mesh& _mesh, const core::CMeshBuffer& _buffer) {
+		const std::vector<unsigned char>& indexData = test::gl::buffers[test::gl::vertexArrays[_buffer.GetVertexArray()]].data;
+		const std::vector<unsigned char>& vertexData = test::gl::buffers[_buffer.GetVertexBuffer()].data;
+		for ( unsigned int i = 0; i < _mesh.range.indicesNumber; ++i ) {
+			unsigned int index;
+			size_t indexOffset = (_mesh.range.firstIndex + i) * sizeof(unsigned int);
+			if ( indexOffset + sizeof(index) > indexData.size() )
+				return false;
+			std::memcpy(&index, indexData.data() + indexOffset, sizeof(index));
+
+			size_t vertexOffset = (index + _mesh.range.baseVertex) * kVertexFloats * sizeof(float);
+			if ( vertexOffset + kVertexFloats * sizeof(float) > vertexData.size() ||
+				 std::memcmp(vertexData.data() + vertexOffset, &_mesh.vertices[_mesh.indices[i] * kVertexFloats],
+							 kVertexFloats * sizeof(float)) != 0 )
+				return false;
+		}
+		return true;
+	}
+
+	void CheckBaseVertex() {
+		std::mt19937 random(50);
+		std::uniform_int_distribution<unsigned int> verticesNumber(1, 200), triangles(1, 300);
+		std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+		std::vector<Mesh> meshes(300);
+		unsigned int wrongRanges = 0, wrongDraws = 0;
+		std::set<GLuint> vertexBuffers;
+		{
+			// Small buffers, so loading the meshes grows both several times.
+			core::CMeshBuffer buffer(kVertexFloats * sizeof(float), 4096, 1024);
+			GLuint firstIndex = 0;
+			GLint baseVertex = 0;
+			for ( unsigned int m = 0; m < meshes.size(); ++m ) {
+				Mesh& mesh = meshes[m];
+				mesh.vertices.resize(verticesNumber(random) * kVertexFloats);
+				for ( float& component : mesh.vertices )
+					component = value(random);
+				// Indices count from the mesh's own first vertex, as the parsers give them.
+				std::uniform_int_distribution<unsigned int> index(0, mesh.vertices.size() / kVertexFloats - 1);
+				mesh.indices.resize(3 * triangles(random));
+				for ( unsigned int& i : mesh.indices )
+					i = index(random);
+
+				mesh.range = buffer.Add(mesh.vertices.data(), mesh.vertices.size() * sizeof(float), mesh.indices.data(),
+										mesh.indices.size());
+				wrongRanges += mesh.range.firstIndex != firstIndex || mesh.range.baseVertex != baseVertex ||
+					mesh.range.indicesNumber != mesh.indices.size();
+				firstIndex += mesh.indices.size();
+				baseVertex += mesh.vertices.size() / kVertexFloats;
+				vertexBuffers.insert(buffer.GetVertexBuffer());
+
+				// Meshes added before keep drawing right, whatever the growth moved.
+				if ( m % 50 == 49 )
+					for ( unsigned int earlier = 0; earlier <= m; ++earlier )
+						wrongDraws += !DrawsLikeSource(meshes[earlier], buffer);
+			}
+			for ( const Mesh& mesh : meshes )
+				wrongDraws += !DrawsLikeSource(mesh, buffer);
+
+			// The vertex and index buffers, nothing left of the storage growth replaced.
+			CHECK(test::gl::buffers.size() == 2);
+			std::printf("%zu meshes, %d vertices, %u indices: %zu vertex buffers, %lu bytes copied on growth\n",
+						meshes.size(), baseVertex, firstIndex, vertexBuffers.size(), test::gl::copiedBytes);
+		}
+		CHECK(wrongRanges == 0);
+		CHECK(wrongDraws == 0);
+		CHECK(test::gl::copiedBytes > 0);
+		// Doubling: 300 meshes of about 6 KiB from a 4 KiB start take a handful of buffers.
+		CHECK(vertexBuffers.size() > 1 && vertexBuffers.size() <= 12);
+		CHECK(test::gl::buffers.empty() && test::gl::vertexArrays.empty());
+	}
+
+	/// Multi draw runs as RenderScene() cuts them, checked against the binds its state filter makes between batches.
+	void CheckDrawRuns() {
+		std::mt19937 random(51);
+		std::bernoulli_distribution skinned(0.02);
+		unsigned int mixedRuns = 0, needlessSplits = 0, frames = 0;
+		unsigned long totalBatches = 0, totalRuns = 0;
+		for ( unsigned int trial = 0; trial < 300; ++trial ) {
+			std::uniform_int_distribution<unsigned int> mesh(0, 999), texture(0, trial % 6), depth(0, 0xFFFF);
+			core::CRenderQueue queue;
+			struct Draw { unsigned int mesh, diffuse, specular; bool skinned; };
+			std::vector<Draw> draws(1 + trial * 13);
+			for ( unsigned int i = 0; i < draws.size(); ++i ) {
+				draws[i] = Draw{ mesh(random), texture(random), texture(random), skinned(random) };
+				queue.Push(core::CRenderQueue::MakeKey(draws[i].skinned ? core::eSKINNED_MESH_SHADER : core::eSTATIC_MESH_SHADER,
+													   draws[i].diffuse, draws[i].specular, draws[i].mesh, depth(random)), i);
+			}
+			queue.Sort();
+			std::vector<core::InstanceBatch> batches;
+			int palettes = 0;
+			for ( unsigned int i = 0; i < queue.GetSize(); ++i ) {
+				const Draw& draw = draws[queue[i].value];
+				if ( core::AddToBatches(batches, i, draw.mesh, draw.diffuse, draw.specular, draw.skinned) && draw.skinned )
+					batches.back().skinPalette = palettes++;
+			}
+
+			// The state RenderScene() keeps bound, and what it binds before each batch.
+			unsigned int usedVariant = core::eBATCH_SHADERS_NUMBER, boundDiffuse = UINT32_MAX, boundSpecular = UINT32_MAX;
+			unsigned int runs = 1;
+			for ( unsigned int b = 0; b < batches.size(); ++b ) {
+				const core::InstanceBatch& batch = batches[b];
+				unsigned int variant = batch.skinPalette >= 0 ? core::eSKINNED_MESH_SHADER : core::eSTATIC_MESH_SHADER;
+				bool binds = variant != usedVariant || batch.skinPalette >= 0 || batch.diffuseTextureID != boundDiffuse ||
+					batch.specularTextureID != boundSpecular;
+				usedVariant = variant;
+				boundDiffuse = batch.diffuseTextureID;
+				boundSpecular = batch.specularTextureID;
+				if ( b == 0 )
+					continue;
+				bool breaks = core::BreaksDrawRun(batch, batches[b - 1]);
+				mixedRuns += binds && !breaks;
+				needlessSplits += breaks && !binds;
+				runs += breaks;
+			}
+			totalBatches += batches.size();
+			totalRuns += runs;
+			++frames;
+		}
+		std::printf("%u frames, %lu batches in %lu multi draws\n", frames, totalBatches, totalRuns);
+		CHECK(mixedRuns == 0);
+		CHECK(needlessSplits == 0);
+
+		// 4000 cubes over 1000 meshes and one texture set: one multi draw, a skinned batch in the middle makes three.
+		std::vector<core::InstanceBatch> batches;
+		for ( unsigned int i = 0; i < 4000; ++i )
+			core::AddToBatches(batches, i, i / 4, 0, 0, false);
+		unsigned int runs = 1;
+		for ( unsigned int b = 1; b < batches.size(); ++b )
+			runs += core::BreaksDrawRun(batches[b], batches[b - 1]);
+		CHECK(batches.size() == 1000 && runs == 1);
+		batches[500].skinPalette = 0;
+		runs = 1;
+		for ( unsigned int b = 1; b < batches.size(); ++b )
+			runs += core::BreaksDrawRun(batches[b], batches[b - 1]);
+		CHECK(runs == 3);
+	}
+}
+
+int main()
+{
+	test::gl::Install();
+	CheckBaseVertex();
+	CheckDrawRuns();
+
+	return test::failures;
+}
@@ -0,0 +1,74 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "ComponentsFullSet.hpp"
+#include "EntityManager.hpp"
+#include "EventsStack.hpp"
+#include "Systems/CollisionSystem.hpp"
+#include "Check.hpp"
+#include <random>
+#include <vector>
+
+/// The collider flags must come out the same whatever the number of narrowphase workers.
+int main()
+{
+	using namespace GLVM;
+	namespace cm = GLVM::ecs::components;
+
+	ecs::ComponentManager* componentManager = ecs::ComponentManager::GetInstance();
+	ecs::EntityManager* entityManager = ecs::EntityManager::GetInstance();
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> position(0.0f, 60.0f);
+	std::vector<Entity> entities;
+
+	// Dense enough that every worker count splits the pairs instead of falling back to the inline pass.
+	for (unsigned int i = 0; i < 50000; ++i) {
+		Entity entity = entityManager->CreateEntity();
+		componentManager->CreateComponent<cm::transform, cm::collider>(entity);
+		cm::transform* transform = componentManager->GetComponent<cm::transform>(entity);
+		transform->tPosition = vec3(position(random), position(random) * 0.5f, position(random));
+		transform->fScale = 0.6f;
+		if (i % 4 == 0) {
+			componentManager->CreateComponent<cm::move>(entity);
+			componentManager->GetComponent<cm::move>(entity)->frameMovement = vec3(0.1f, 0.0f, 0.0f);
+		}
+		entities.push_back(entity);
+	}
+
+	core::CStack stack;
+	ecs::CCollisionSystem collision(stack);
+	collision.fDelta_Time_ = 1.0f / 60.0f;
+	std::vector<int> reference;
+
+	for (ecs::CCollisionSystem::EBroadphase broadphase : { ecs::CCollisionSystem::eSPATIAL_HASH, ecs::CCollisionSystem::eSWEEP_AND_PRUNE }) {
+		collision.broadphase = broadphase;
+		for (unsigned int workers : { 1u, 2u, 4u, 8u, 16u }) {
+			collision.workersNumber = workers;
+			for (Entity entity : entities)
+				componentManager->GetComponent<cm::collider>(entity)->bWall_Collision_ = false;
+
+			auto start = std::chrono::steady_clock::now();
+			collision.Update();
+			double updateMs = test::ElapsedMs(start);
+
+			std::vector<int> flags;
+			unsigned int ground = 0, wall = 0;
+			for (Entity entity : entities) {
+				cm::collider* collider = componentManager->GetComponent<cm::collider>(entity);
+				flags.push_back(collider->bGround_Collision_ * 2 + collider->bWall_Collision_);
+				ground += collider->bGround_Collision_;
+				wall += collider->bWall_Collision_;
+			}
+			if (reference.empty())
+				reference = flags;
+
+			std::printf("narrowphase: broadphase %d, %2u workers, %.2f ms, %u ground, %u wall\n", int(broadphase), workers, updateMs, ground, wall);
+			CHECK(ground + wall > 0);
+			CHECK(flags == reference);
+		}
+	}
+
+	return test::failures;
+}
@@ -0,0 +1,233 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "ComponentsFullSet.hpp"
+#include "Components/ProjectileComponent.hpp"
+#include "EntityManager.hpp"
+#include "JsonParser.hpp"
+#include "Prefab.hpp"
+#include "Check.hpp"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace
+{
+	using namespace GLVM;
+	namespace cm = GLVM::ecs::components;
+
+	/// Writes _text to a file of the temporary directory and returns its path.
+	std::string WriteFile(const char* _name, const char* _text) {
+		std::string path = (std::filesystem::temp_directory_path() / _name).string();
+		std::ofstream(path) << _text;
+		return path;
+	}
+
+	bool Near(float a, float b) { return std::fabs(a - b) < 1e-6f; }
+
+	/*! Before the fix a '}' or ']' right after a scalar was skipped together
+	 *  with the scalar, so an array of objects lost every object after the
+	 *  first, and an object lost every key after a nested one. */
+	void CheckJsonParser() {
+		std::string path = WriteFile("glvm_parser_test.json",
+									 "{ \"list\": [{\"a\": 1}, {\"b\": true}, {\"c\": \"x\"}, {\"d\": [1.5, -2]}],\n"
+									 "  \"nested\": {\"inner\": {\"value\": null}, \"after\": false},\n"
+									 "  \"last\": 2.5 }");
+		Core::CJsonParser parser;
+		parser.ReadFile(path.c_str());
+		parser.Parse();
+		Core::JsonValue* root = parser.GetRoot();
+		CHECK(root != nullptr && root->isObject());
+		if (root == nullptr || !root->isObject())
+			return;
+
+		Core::JsonValue& list = (*root)["list"];
+		CHECK(list.isArray() && list.value.array->GetSize() == 4);
+		if (list.isArray() && list.value.array->GetSize() == 4) {
+			CHECK(list[0]["a"].isInterger() && list[0]["a"].value.iNumber == 1);
+			CHECK(list[1]["b"].isBoolean() && list[1]["b"].value.boolean);
+			CHECK(list[2]["c"].isString() && *list[2]["c"].value.string == "x");
+			Core::JsonValue& numbers = list[3]["d"];
+			CHECK(numbers.isArray() && numbers.value.array->GetSize() == 2);
+			CHECK(numbers[0].isFloat() && numbers[0].value.fNumber == 1.5);
+			CHECK(numbers[1].isInterger() && numbers[1].value.iNumber == -2);
+		}
+		CHECK(root->value.object->Contain("nested") && (*root)["nested"].value.object->Contain("after"));
+		CHECK((*root)["nested"]["inner"]["value"].isNull());
+		CHECK((*root)["nested"]["after"].isBoolean() && !(*root)["nested"]["after"].value.boolean);
+		CHECK(root->value.object->Contain("last") && (*root)["last"].isFloat() && (*root)["last"].value.fNumber == 2.5);
+		std::filesystem::remove(path);
+	}
+
+	void CheckLoadFromFile() {
+		ecs::CPrefabRegistry* registry = ecs::CPrefabRegistry::GetInstance();
+		CHECK(!registry->LoadFromFile("prefabs/missing.json"));
+		std::string empty = WriteFile("glvm_prefab_empty.json", "{ \"entities\": [] }");
+		CHECK(!registry->LoadFromFile(empty.c_str()));
+		std::filesystem::remove(empty);
+
+		std::string path = WriteFile("glvm_prefab_test.json",
+									 "{ \"prefabs\": [\n"
+									 "  { \"name\": \"crate\", \"components\": {\n"
+									 "      \"transform\": { \"position\": [1, 2.5, -3], \"yaw\": 30.0, \"pitch\": 90, \"scale\": 2, \"gltf\": false },\n"
+									 "      \"rigidBody\": { \"mass\": 0.5, \"gravity\": true, \"jump\": [0, 4, 0] },\n"
+									 "      \"collider\": {} } },\n"
+									 "  { \"components\": { \"collider\": {} } },\n"
+									 "  { \"name\": \"lamp\", \"components\": {\n"
+									 "      \"pointLight\": { \"diffuse\": [0.5, 0.25, 1], \"linear\": 0.2 },\n"
+									 "      \"collider\": { \"bullet\": true },\n"
+									 "      \"projectile\": { \"speed\": 40 } } },\n"
+									 "  { \"name\": \"bare\" }\n"
+									 "] }");
+		CHECK(registry->LoadFromFile(path.c_str()));
+		std::filesystem::remove(path);
+
+		ecs::CPrefab* crate = registry->Get("crate");
+		CHECK(crate != nullptr && crate->GetComponentsNumber() == 3);
+		if (crate != nullptr) {
+			cm::transform* transform = crate->Get<cm::transform>();
+			CHECK(transform != nullptr && transform->tPosition[0] == 1.0f && transform->tPosition[1] == 2.5f &&
+				  transform->tPosition[2] == -3.0f && transform->fScale == 2.0f && !transform->gltf);
+			if (transform != nullptr) {
+				Quaternion expected = cm::YawPitchRotation(30.0f, 90.0f);
+				CHECK(Near(std::fabs(dotQuaternion(transform->rotation, expected)), 1.0f));
+			}
+			cm::rigidBody* rigidBody = crate->Get<cm::rigidBody>();
+			CHECK(rigidBody != nullptr && rigidBody->fMass_ == 0.5f && rigidBody->bGravity_ && rigidBody->jump[1] == 4.0f);
+			// Fields the file leaves out keep the component defaults.
+			CHECK(rigidBody != nullptr && rigidBody->gravityTime == cm::rigidBody{}.gravityTime);
+			CHECK(crate->Get<cm::collider>() != nullptr && !crate->Get<cm::collider>()->bBullet_);
+			CHECK(crate->Get<cm::material>() == nullptr);
+		}
+
+		// An entry without a name is skipped, the ones after it still load.
+		ecs::CPrefab* lamp = registry->Get("lamp");
+		CHECK(lamp != nullptr && lamp->GetComponentsNumber() == 3);
+		if (lamp != nullptr) {
+			cm::pointLight* light = lamp->Get<cm::pointLight>();
+			CHECK(light != nullptr && light->diffuse[1] == 0.25f && Near(light->linear, 0.2f) &&
+				  light->constant == cm::pointLight{}.constant);
+			CHECK(lamp->Get<cm::collider>() != nullptr && lamp->Get<cm::collider>()->bBullet_);
+			CHECK(lamp->Get<cm::projectile>() != nullptr && lamp->Get<cm::projectile>()->fSpeed_ == 40.0f);
+			CHECK(lamp->Get<cm::transform>() == nullptr);
+		}
+		CHECK(registry->Get("bare") != nullptr && registry->Get("bare")->GetComponentsNumber() == 0);
+
+		// The shipped file defines what EngineMain.cpp and the projectile system look up.
+		CHECK(registry->LoadFromFile("prefabs/prefabs.json"));
+		ecs::CPrefab* cube = registry->Get("fallingCube");
+		CHECK(registry->Get("groundPlane") != nullptr && cube != nullptr && registry->Get("projectile") != nullptr);
+		CHECK(cube != nullptr && cube->GetComponentsNumber() == 5 && cube->Get<cm::rigidBody>() != nullptr);
+		CHECK(registry->Get("projectile") != nullptr && registry->Get("projectile")->Get<cm::pointLight>() != nullptr);
+	}
+
+	/// Components are told apart by type: each one found once, an overwrite keeps a single record, copies are deep.
+	void CheckComponents() {
+		ecs::CPrefab prefab("components");
+		cm::transform* transform = prefab.Add<cm::transform>();
+		CHECK(prefab.Get<cm::transform>() == transform);
+		CHECK(prefab.Get<cm::collider>() == nullptr);
+		prefab.Add<cm::collider>(cm::collider{ .bBullet_ = true });
+		prefab.Add<cm::transform>(cm::transform{ .fScale = 3.0f });
+		CHECK(prefab.GetComponentsNumber() == 2);
+		CHECK(prefab.Get<cm::transform>() == transform && transform->fScale == 3.0f);
+		CHECK(prefab.Get<cm::collider>()->bBullet_);
+
+		ecs::CPrefab copy(prefab);
+		copy.Get<cm::transform>()->fScale = 4.0f;
+		CHECK(copy.GetComponentsNumber() == 2 && prefab.Get<cm::transform>()->fScale == 3.0f);
+	}
+
+	void CheckInstantiate() {
+		ecs::ComponentManager* componentManager = ecs::ComponentManager::GetInstance();
+		ecs::EntityManager* entityManager = ecs::EntityManager::GetInstance();
+		ecs::CPrefabRegistry* registry = ecs::CPrefabRegistry::GetInstance();
+		ecs::CPrefab* cube = registry->Get("fallingCube");
+		if (cube == nullptr)
+			return;
+
+		core::vector<Entity> entities = registry->Instantiate(*cube, 100);
+		CHECK(entities.GetSize() == 100);
+		unsigned int complete = 0;
+		for (unsigned int i = 0; i < entities.GetSize(); ++i) {
+			complete += componentManager->GetComponent<cm::transform>(entities[i])->fScale == 1.0f &&
+				componentManager->GetComponent<cm::rigidBody>(entities[i])->fMass_ == 0.1f &&
+				componentManager->GetComponent<cm::material>(entities[i]) != nullptr &&
+				componentManager->GetComponent<cm::mesh>(entities[i]) != nullptr &&
+				componentManager->GetComponent<cm::collider>(entities[i]) != nullptr;
+		}
+		CHECK(complete == 100);
+
+		// Reset writes the prefab values back over what the game changed.
+		componentManager->GetComponent<cm::transform>(entities[7])->fScale = 9.0f;
+		registry->Reset(*cube, &entities[7], 1);
+		CHECK(componentManager->GetComponent<cm::transform>(entities[7])->fScale == 1.0f);
+
+		for (unsigned int i = 0; i < entities.GetSize(); ++i)
+			entityManager->RemoveEntity(entities[i], componentManager);
+	}
+
+	/*! A wave of falling cubes the way CreateFallingCube() built them before
+	 *  prefabs, against the component pass of Instantiate(). Both write the
+	 *  same entities into containers a first wave already grew: step by step
+	 *  growth happens once per game and would drown the per-entity cost. */
+	void Benchmark() {
+		ecs::ComponentManager* componentManager = ecs::ComponentManager::GetInstance();
+		ecs::EntityManager* entityManager = ecs::EntityManager::GetInstance();
+		ecs::CPrefab* cube = ecs::CPrefabRegistry::GetInstance()->Get("fallingCube");
+		if (cube == nullptr)
+			return;
+		const unsigned int count = 10000;
+
+		core::vector<Entity> entities;
+		for (unsigned int i = 0; i < count; ++i)
+			entities.Push(entityManager->CreateEntity());
+		for (unsigned int i = 0; i < cube->GetComponentsNumber(); ++i)
+			cube->GetComponentRecord(i)->Instantiate(componentManager, entities.GetVectorContainer(), count);
+		for (unsigned int i = 0; i < count; ++i)
+			componentManager->RemoveAllComponents(entities[i]);
+
+		for (unsigned int round = 0; round < 3; ++round) {
+			auto start = std::chrono::steady_clock::now();
+			for (unsigned int i = 0; i < count; ++i) {
+				Entity entity = entities[i];
+				componentManager->CreateComponent<cm::mesh, cm::material, cm::transform, cm::rigidBody, cm::collider>(entity);
+				*componentManager->GetComponent<cm::transform>(entity) = { .fScale = 1.0f, .gltf = true };
+				cm::SetRotation(*componentManager->GetComponent<cm::transform>(entity), cm::YawPitchRotation(0.0f, 90.0f));
+				*componentManager->GetComponent<cm::rigidBody>(entity) = { .fMass_ = 0.1f, .bGravity_ = true };
+				componentManager->GetComponent<cm::mesh>(entity)->handle.id = 0;
+				*componentManager->GetComponent<cm::material>(entity) = { .ambient = vec3(1.0f, 1.0f, 1.0f), .shininess = 1.0f };
+			}
+			double perEntityMs = test::ElapsedMs(start);
+			for (unsigned int i = 0; i < count; ++i)
+				componentManager->RemoveAllComponents(entities[i]);
+
+			start = std::chrono::steady_clock::now();
+			for (unsigned int i = 0; i < cube->GetComponentsNumber(); ++i)
+				cube->GetComponentRecord(i)->Instantiate(componentManager, entities.GetVectorContainer(), count);
+			double prefabMs = test::ElapsedMs(start);
+			CHECK(componentManager->GetEntityContainer<cm::rigidBody>()->GetSize() == count);
+			for (unsigned int i = 0; i < count; ++i)
+				componentManager->RemoveAllComponents(entities[i]);
+
+			std::printf("spawn %u cubes, round %u: per entity %.2f ms, prefab %.2f ms\n", count, round, perEntityMs, prefabMs);
+		}
+
+		for (unsigned int i = 0; i < count; ++i)
+			entityManager->RemoveEntity(entities[i], componentManager);
+	}
+}
+
+int main()
+{
+	CheckJsonParser();
+	CheckLoadFromFile();
+	CheckComponents();
+	CheckInstantiate();
+	Benchmark();
+
+	return test::failures;
+}
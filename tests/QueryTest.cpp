@@ -0,0 +1,206 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "ComponentsFullSet.hpp"
+#include "EntityManager.hpp"
+#include "Query.hpp"
+#include "Check.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using namespace GLVM;
+	namespace cm = GLVM::ecs::components;
+
+	/// Entities of a collision scene: every one has a collider and a transform, some move, some carry a material.
+	struct Scene
+	{
+		std::vector<Entity> entities;
+		std::vector<bool> moving, textured;
+
+		void Build(unsigned int _count, std::mt19937& _random) {
+			ecs::ComponentManager* componentManager = ecs::ComponentManager::GetInstance();
+			ecs::EntityManager* entityManager = ecs::EntityManager::GetInstance();
+			std::bernoulli_distribution coin(0.5);
+			for (unsigned int i = 0; i < _count; ++i) {
+				Entity entity = entityManager->CreateEntity();
+				componentManager->CreateComponent<cm::transform, cm::collider>(entity);
+				componentManager->GetComponent<cm::transform>(entity)->tPosition = vec3(float(i), 0.0f, 0.0f);
+				bool move = coin(_random), material = coin(_random);
+				if (move)
+					componentManager->CreateComponent<cm::move>(entity);
+				if (material)
+					componentManager->CreateComponent<cm::material>(entity);
+				entities.push_back(entity);
+				moving.push_back(move);
+				textured.push_back(material);
+			}
+		}
+
+		void Destroy() {
+			for (Entity entity : entities)
+				ecs::EntityManager::GetInstance()->RemoveEntity(entity, ecs::ComponentManager::GetInstance());
+		}
+
+		/// Position in the scene of an entity, the transform holds it as x.
+		static unsigned int Index(const cm::transform* _transform) { return (unsigned int)_transform->tPosition[0]; }
+	};
+
+	void CheckMatching() {
+		ecs::ComponentManager* componentManager = ecs::ComponentManager::GetInstance();
+		std::mt19937 random(30);
+		Scene scene;
+		scene.Build(500, random);
+
+		// Include only: every entity of the scene, each exactly once and with its own components.
+		std::vector<unsigned int> seen(scene.entities.size(), 0);
+		ecs::Query<ecs::Include<cm::collider, cm::transform>> colliders;
+		colliders.ForEach([&](Entity _entity, cm::collider* _collider, cm::transform* _transform) {
+			unsigned int index = Scene::Index(_transform);
+			CHECK(scene.entities[index] == _entity);
+			CHECK(componentManager->GetComponent<cm::collider>(_entity) == _collider);
+			++seen[index];
+		});
+		CHECK(std::all_of(seen.begin(), seen.end(), [](unsigned int _count) { return _count == 1; }));
+
+		// Include a component only some own: exactly the moving entities.
+		unsigned int moving = 0, movingMatched = 0;
+		for (bool move : scene.moving)
+			moving += move;
+		ecs::Query<ecs::Include<cm::move, cm::transform>> movers;
+		movers.ForEach([&](Entity, cm::move*, cm::transform* _transform) {
+			CHECK(scene.moving[Scene::Index(_transform)]);
+			++movingMatched;
+		});
+		CHECK(movingMatched == moving);
+
+		// Exclude: no entity with a material, every entity without one.
+		unsigned int plain = 0, plainMatched = 0;
+		for (bool material : scene.textured)
+			plain += !material;
+		ecs::Query<ecs::Include<cm::collider, cm::transform>, ecs::Exclude<cm::material>> untextured;
+		untextured.ForEach([&](Entity _entity, cm::collider*, cm::transform* _transform) {
+			CHECK(!scene.textured[Scene::Index(_transform)]);
+			CHECK(untextured.Matches(_entity));
+			++plainMatched;
+		});
+		CHECK(plainMatched == plain);
+
+		// Optional: the component when owned, nullptr when not, and the entity is matched either way.
+		ecs::Query<ecs::Include<cm::transform>, ecs::Exclude<>, ecs::Optional<cm::move>> optional;
+		unsigned int optionalMatched = 0;
+		optional.ForEach([&](Entity _entity, cm::transform* _transform, cm::move* _move) {
+			unsigned int index = Scene::Index(_transform);
+			CHECK((_move != nullptr) == scene.moving[index]);
+			if (_move != nullptr)
+				CHECK(_move == componentManager->GetComponent<cm::move>(_entity));
+			++optionalMatched;
+		});
+		CHECK(optionalMatched == scene.entities.size());
+
+		// A removed component drops out of the mask at once.
+		Entity first = scene.entities[0];
+		if (!scene.moving[0])
+			componentManager->CreateComponent<cm::move>(first);
+		componentManager->RemoveComponent<cm::move>(first);
+		scene.moving[0] = false;
+		CHECK(!movers.Matches(first));
+
+		// Disabled entities keep their components but no query sees them, enabled they come back.
+		std::vector<Entity> disabled;
+		for (unsigned int i = 0; i < scene.entities.size(); i += 3) {
+			componentManager->DisableEntity(scene.entities[i]);
+			disabled.push_back(scene.entities[i]);
+		}
+		unsigned int enabledMatched = 0;
+		colliders.ForEach([&](Entity _entity, cm::collider*, cm::transform* _transform) {
+			CHECK(Scene::Index(_transform) % 3 != 0);
+			CHECK(componentManager->IsEntityEnabled(_entity));
+			++enabledMatched;
+		});
+		CHECK(enabledMatched == scene.entities.size() - disabled.size());
+		CHECK(!colliders.Matches(disabled[0]) && !optional.Matches(disabled[0]));
+		for (Entity entity : disabled)
+			componentManager->EnableEntity(entity);
+		CHECK(colliders.Collect().GetSize() == scene.entities.size());
+
+		// Collect() holds the same rows, in the same order, as ForEach() visits them.
+		core::vector<ecs::Query<ecs::Include<cm::transform>, ecs::Exclude<>, ecs::Optional<cm::move>>::Row> rows = optional.Collect();
+		unsigned int row = 0, rowMismatches = 0;
+		optional.ForEach([&](Entity _entity, cm::transform* _transform, cm::move* _move) {
+			if (row >= rows.GetSize() || rows[row].entity != _entity || rows[row].Get<cm::transform>() != _transform ||
+				rows[row].Get<cm::move>() != _move)
+				++rowMismatches;
+			++row;
+		});
+		CHECK(row == rows.GetSize());
+		CHECK(rowMismatches == 0);
+
+		scene.Destroy();
+	}
+
+	/*! The pair loop CCollisionSystem::Update() had before queries: both
+	 *  bodies of every pair looked up in a second entity list to learn
+	 *  whether they move, against the optional column of one query. */
+	void Benchmark() {
+		ecs::ComponentManager* componentManager = ecs::ComponentManager::GetInstance();
+		std::mt19937 random(31);
+		Scene scene;
+		scene.Build(600, random);
+
+		auto start = std::chrono::steady_clock::now();
+		core::vector<Entity> linkedEntities = componentManager->collectLinkedEntities<cm::collider, cm::transform>();
+		core::vector<Entity> linkedEntitiesWithMove = componentManager->collectLinkedEntities<cm::collider, cm::transform, cm::move>();
+		float listSum = 0.0f;
+		for (unsigned int i = 0; i < linkedEntities.GetSize(); ++i) {
+			for (unsigned int j = 0; j < linkedEntities.GetSize(); ++j) {
+				if (i == j)
+					continue;
+				for (unsigned int m = 0; m < linkedEntitiesWithMove.GetSize(); ++m) {
+					if (linkedEntities[i] == linkedEntitiesWithMove[m])
+						listSum += componentManager->GetComponent<cm::move>(linkedEntities[i])->gravity[1] + 1.0f;
+				}
+				for (unsigned int n = 0; n < linkedEntitiesWithMove.GetSize(); ++n) {
+					if (linkedEntities[j] == linkedEntitiesWithMove[n])
+						listSum += componentManager->GetComponent<cm::move>(linkedEntities[j])->gravity[1] + 1.0f;
+				}
+			}
+		}
+		double listMs = test::ElapsedMs(start);
+
+		start = std::chrono::steady_clock::now();
+		ecs::Query<ecs::Include<cm::collider, cm::transform>, ecs::Exclude<>, ecs::Optional<cm::move>> bodies;
+		auto rows = bodies.Collect();
+		float querySum = 0.0f;
+		for (unsigned int i = 0; i < rows.GetSize(); ++i) {
+			for (unsigned int j = 0; j < rows.GetSize(); ++j) {
+				if (i == j)
+					continue;
+				if (cm::move* move = rows[i].Get<cm::move>())
+					querySum += move->gravity[1] + 1.0f;
+				if (cm::move* move = rows[j].Get<cm::move>())
+					querySum += move->gravity[1] + 1.0f;
+			}
+		}
+		double queryMs = test::ElapsedMs(start);
+
+		CHECK(linkedEntities.GetSize() == rows.GetSize());
+		CHECK(listSum == querySum);
+		std::printf("%u bodies, %u moving: list lookup %.2f ms, query %.2f ms\n", rows.GetSize(),
+					linkedEntitiesWithMove.GetSize(), listMs, queryMs);
+
+		scene.Destroy();
+	}
+}
+
+int main()
+{
+	CheckMatching();
+	Benchmark();
+
+	return test::failures;
+}
@@ -0,0 +1,183 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "RenderQueue.hpp"
+#include "Check.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using namespace GLVM;
+
+	/// Fields in key order, for comparing with the packed key.
+	struct Draw
+	{
+		unsigned int shader, diffuse, specular, mesh, depth;
+
+		bool operator<(const Draw& _other) const {
+			if (shader != _other.shader) return shader < _other.shader;
+			if (diffuse != _other.diffuse) return diffuse < _other.diffuse;
+			if (specular != _other.specular) return specular < _other.specular;
+			if (mesh != _other.mesh) return mesh < _other.mesh;
+			return depth < _other.depth;
+		}
+	};
+
+	void CheckKeys() {
+		std::mt19937 random(44);
+		std::uniform_int_distribution<unsigned int> shader(0, 15), texture(0, 4095), mesh(0, 0xFFFFF), depth(0, 0xFFFF);
+		unsigned int orderMismatches = 0;
+		for (unsigned int i = 0; i < 100000; ++i) {
+			Draw a{ shader(random), texture(random), texture(random), mesh(random), depth(random) };
+			Draw b = a;
+			// Differ in one field only, so the order hangs on that field's place in the key.
+			switch (i % 5) {
+			case 0: b.shader = shader(random); break;
+			case 1: b.diffuse = texture(random); break;
+			case 2: b.specular = texture(random); break;
+			case 3: b.mesh = mesh(random); break;
+			default: b.depth = depth(random); break;
+			}
+			uint64_t keyA = core::CRenderQueue::MakeKey(a.shader, a.diffuse, a.specular, a.mesh, a.depth);
+			uint64_t keyB = core::CRenderQueue::MakeKey(b.shader, b.diffuse, b.specular, b.mesh, b.depth);
+			orderMismatches += (keyA < keyB) != (a < b) || core::CRenderQueue::ShaderOf(keyA) != a.shader;
+		}
+		CHECK(orderMismatches == 0);
+
+		// Every field is masked to its width, a wide id cannot spill into the field above.
+		CHECK(core::CRenderQueue::MakeKey(0, 0, 0, 0x100000, 0x10000) == 0);
+		CHECK(core::CRenderQueue::MakeKey(0x1F, 0x1FFF, 0x1FFF, 0x1FFFFF, 0x1FFFF) == ~uint64_t(0));
+		CHECK(core::CRenderQueue::MakeKey(1, 0, 0, 0, 0) == uint64_t(1) << 60);
+		CHECK(core::CRenderQueue::MakeKey(0, 0, 0, 1, 0) == uint64_t(1) << core::CRenderQueue::kDepthBits);
+	}
+
+	/// Sorts the keys through the queue and checks the order std::stable_sort gives, values included.
+	bool SortsLikeStableSort(core::CRenderQueue& _queue, const std::vector<uint64_t>& _keys, double* _sortMs = nullptr) {
+		_queue.Clear();
+		std::vector<core::RenderItem> expected;
+		expected.reserve(_keys.size());
+		for (unsigned int i = 0; i < _keys.size(); ++i) {
+			_queue.Push(_keys[i], i);
+			expected.push_back(core::RenderItem{ _keys[i], i });
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		_queue.Sort();
+		if (_sortMs != nullptr)
+			*_sortMs = test::ElapsedMs(start);
+		std::stable_sort(expected.begin(), expected.end(),
+						 [](const core::RenderItem& a, const core::RenderItem& b) { return a.key < b.key; });
+
+		if (_queue.GetSize() != expected.size())
+			return false;
+		for (unsigned int i = 0; i < expected.size(); ++i)
+			if (_queue[i].key != expected[i].key || _queue[i].value != expected[i].value)
+				return false;
+		return true;
+	}
+
+	/// Frames of draws the renderer pushes: few shaders and textures, many meshes and depths, and many equal keys.
+	std::vector<uint64_t> FrameKeys(std::mt19937& _random, unsigned int _count) {
+		std::uniform_int_distribution<unsigned int> shader(0, 1), texture(0, 7), mesh(0, 31), depth(0, 2047);
+		std::vector<uint64_t> keys(_count);
+		for (uint64_t& key : keys)
+			key = core::CRenderQueue::MakeKey(shader(_random), texture(_random), texture(_random), mesh(_random), depth(_random));
+		return keys;
+	}
+
+	void CheckSort() {
+		std::mt19937 random(45);
+		std::uniform_int_distribution<uint64_t> any;
+		core::CRenderQueue queue;
+		unsigned int failed = 0;
+
+		// Degenerate sizes.
+		failed += !SortsLikeStableSort(queue, {});
+		failed += !SortsLikeStableSort(queue, { 7 });
+		failed += !SortsLikeStableSort(queue, { 9, 3 });
+
+		for (unsigned int count : { 10u, 257u, 5000u }) {
+			std::vector<uint64_t> keys(count);
+			// Every byte random.
+			for (uint64_t& key : keys)
+				key = any(random);
+			failed += !SortsLikeStableSort(queue, keys);
+
+			// Constant high and middle bytes: the skipped passes must not disturb the ones that run.
+			for (uint64_t& key : keys)
+				key = 0xAB00CD0000000000ull | (any(random) & 0x00FF00FFFFFFull);
+			failed += !SortsLikeStableSort(queue, keys);
+
+			// Only the top byte varies, after seven skipped passes the single one lands in the scratch buffer.
+			for (uint64_t& key : keys)
+				key = (any(random) & 0xFF00000000000000ull) | 0x0123456789ABCDull;
+			failed += !SortsLikeStableSort(queue, keys);
+
+			// A handful of distinct keys, where stability decides the whole order.
+			std::uniform_int_distribution<unsigned int> pick(0, 3);
+			const uint64_t few[] = { 0x8000000000000001ull, 0x1ull, 0x8000000000000000ull, 0x100ull };
+			for (uint64_t& key : keys)
+				key = few[pick(random)];
+			failed += !SortsLikeStableSort(queue, keys);
+
+			// All equal: every pass is skipped and the push order stays.
+			std::fill(keys.begin(), keys.end(), 0x0102030405060708ull);
+			failed += !SortsLikeStableSort(queue, keys);
+
+			failed += !SortsLikeStableSort(queue, FrameKeys(random, count));
+		}
+		CHECK(failed == 0);
+
+		// Clear keeps the storage, a second frame of another size sorts from scratch.
+		failed = !SortsLikeStableSort(queue, FrameKeys(random, 300)) + !SortsLikeStableSort(queue, FrameKeys(random, 40));
+		CHECK(failed == 0);
+		CHECK(queue.GetSize() == 40);
+	}
+
+	/// 100k draws of a frame, the queue against the comparison sorts on the same items.
+	void Benchmark() {
+		std::mt19937 random(46);
+		const unsigned int count = 100000;
+		std::vector<uint64_t> keys = FrameKeys(random, count);
+		core::CRenderQueue queue;
+
+		double radixMs = 0.0, bestRadixMs = 1e9;
+		for (unsigned int round = 0; round < 5; ++round) {
+			CHECK(SortsLikeStableSort(queue, keys, &radixMs));
+			bestRadixMs = std::min(bestRadixMs, radixMs);
+		}
+
+		std::vector<core::RenderItem> items(count);
+		auto byKey = [](const core::RenderItem& a, const core::RenderItem& b) { return a.key < b.key; };
+		double bestStableMs = 1e9, bestSortMs = 1e9;
+		for (unsigned int round = 0; round < 5; ++round) {
+			for (unsigned int i = 0; i < count; ++i)
+				items[i] = core::RenderItem{ keys[i], i };
+			auto start = std::chrono::steady_clock::now();
+			std::stable_sort(items.begin(), items.end(), byKey);
+			bestStableMs = std::min(bestStableMs, test::ElapsedMs(start));
+
+			for (unsigned int i = 0; i < count; ++i)
+				items[i] = core::RenderItem{ keys[i], i };
+			start = std::chrono::steady_clock::now();
+			std::sort(items.begin(), items.end(), byKey);
+			bestSortMs = std::min(bestSortMs, test::ElapsedMs(start));
+		}
+
+		std::printf("%u draws: radix sort %.3f ms, std::stable_sort %.3f ms, std::sort %.3f ms\n", count, bestRadixMs,
+					bestStableMs, bestSortMs);
+	}
+}
+
+int main()
+{
+	CheckKeys();
+	CheckSort();
+	Benchmark();
+
+	return test::failures;
+}
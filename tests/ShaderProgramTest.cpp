@@ -0,0 +1,146 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "FakeGL.hpp"
+#include "ShaderProgram.hpp"
+#include "Check.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using namespace GLVM;
+
+	std::string ReadFile(const char* _path) {
+		std::ifstream file(_path);
+		std::stringstream stream;
+		stream << file.rdbuf();
+		return stream.str();
+	}
+
+	/// Writes _text to a file of the temporary directory and returns its path.
+	std::string WriteFile(const char* _name, const char* _text) {
+		std::string path = (std::filesystem::temp_directory_path() / _name).string();
+		std::ofstream(path) << _text;
+		return path;
+	}
+
+	/// Sources the driver got for each stage of the program built from the files, in vertex, fragment, geometry order.
+	std::vector<std::string> Compile(const char* _vertex, const char* _fragment, const char* _geometry, const char* _defines) {
+		unsigned int first = test::gl::shaderSources.size();
+		Shader shader(_vertex, _fragment, _geometry, _defines);
+		return std::vector<std::string>(test::gl::shaderSources.begin() + first, test::gl::shaderSources.end());
+	}
+
+	/// _source is _file with _defines on a line of their own right after #version.
+	bool DefinedAfterVersion(const std::string& _source, const std::string& _file, const std::string& _defines) {
+		std::size_t versionEnd = _file.find('\n') + 1;
+		return _file.compare(0, 8, "#version") == 0 &&
+			_source == _file.substr(0, versionEnd) + _defines + "\n" + _file.substr(versionEnd);
+	}
+
+	void CheckDefines() {
+		test::gl::programUniforms.clear();
+
+		// The shipped shaders: the renderer's variants differ by the define only.
+		std::string vertex = ReadFile("GLshaders/CoreShader.vert"), fragment = ReadFile("GLshaders/CoreShader.frag");
+		std::vector<std::string> plain = Compile("GLshaders/CoreShader.vert", "GLshaders/CoreShader.frag", nullptr, nullptr);
+		CHECK(plain.size() == 2 && plain[0] == vertex && plain[1] == fragment);
+		std::vector<std::string> skinned = Compile("GLshaders/CoreShader.vert", "GLshaders/CoreShader.frag", nullptr,
+												   "#define SKINNED");
+		CHECK(skinned.size() == 2 && DefinedAfterVersion(skinned[0], vertex, "#define SKINNED") &&
+			  DefinedAfterVersion(skinned[1], fragment, "#define SKINNED"));
+
+		// Every stage gets them, a geometry shader included, several lines at once.
+		const char* defines = "#define SKINNED\n#define MAX_POINT_LIGHTS 64";
+		std::vector<std::string> cube = Compile("GLshaders/CubeShadowMap.vert", "GLshaders/CubeShadowMap.frag",
+												"GLshaders/CubeShadowMap.geom", defines);
+		CHECK(cube.size() == 3 && DefinedAfterVersion(cube[0], ReadFile("GLshaders/CubeShadowMap.vert"), defines) &&
+			  DefinedAfterVersion(cube[1], ReadFile("GLshaders/CubeShadowMap.frag"), defines) &&
+			  DefinedAfterVersion(cube[2], ReadFile("GLshaders/CubeShadowMap.geom"), defines));
+
+		// Without #version the defines lead; a lone #version line keeps its place; CRLF files keep their line end.
+		std::string noVersion = WriteFile("glvm_shader_no_version.vert", "void main() {}\n");
+		std::string versionOnly = WriteFile("glvm_shader_version_only.frag", "#version 410 core");
+		std::string crlf = WriteFile("glvm_shader_crlf.vert", "#version 410 core\r\nvoid main() {}\r\n");
+		std::string empty = WriteFile("glvm_shader_empty.frag", "");
+		std::vector<std::string> edges = Compile(noVersion.c_str(), versionOnly.c_str(), nullptr, "#define A");
+		CHECK(edges.size() == 2 && edges[0] == "#define A\nvoid main() {}\n" && edges[1] == "#version 410 core\n#define A\n");
+		edges = Compile(crlf.c_str(), empty.c_str(), nullptr, "#define A");
+		CHECK(edges.size() == 2 && edges[0] == "#version 410 core\r\n#define A\nvoid main() {}\r\n" && edges[1].empty());
+		for ( const std::string& path : { noVersion, versionOnly, crlf, empty } )
+			std::filesystem::remove(path);
+	}
+
+	/// Active uniforms of a program as a driver lists them: arrays of plain type once as "name[0]", arrays of
+	/// structs member by member, block members with their block.
+	std::vector<test::gl::Uniform> CoreProgramUniforms() {
+		std::vector<test::gl::Uniform> uniforms = {
+			{ "material.diffuse" }, { "material.specular" }, { "viewPosition" }, { "time" },
+			{ "shadowMatrices[0]", 6 }, { "sampledDirectionalShadows[0]", 4 }, { "layerBase[0]", 1 },
+			{ "lights[0].position" }, { "lights[0].color" }, { "lights[1].position" }, { "lights[1].color" },
+			{ "directionalLights[0].direction", 1, 0 }, { "jointMatrices[0]", 18, 1 }, { "bones[0]", 18 } };
+		// Enough names that a weak hash would collide among them.
+		for ( unsigned int i = 0; i < 64; ++i )
+			for ( const char* field : { ".position", ".constant", ".linear", ".quadratic" } )
+				uniforms.push_back({ "pointLights[" + std::to_string(i) + "]" + field });
+		return uniforms;
+	}
+
+	void CheckUniformTable() {
+		test::gl::programUniforms = CoreProgramUniforms();
+		unsigned int expectedQueries = 0;
+		for ( const test::gl::Uniform& uniform : test::gl::programUniforms )
+			if ( uniform.block == -1 )
+				expectedQueries += uniform.name.find("[0]") == uniform.name.size() - 3 ? uniform.size : 1;
+
+		test::gl::locationQueries = 0;
+		Shader::callStats = UniformCallStats{};
+		Shader shader("GLshaders/CoreShader.vert", "GLshaders/CoreShader.frag");
+		// One query per active uniform and array element, all at link time.
+		CHECK(test::gl::locationQueries == expectedQueries);
+		CHECK(Shader::callStats.locationQueries == expectedQueries);
+
+		// Every name glGetUniformLocation answers, and the ones it refuses, including block members.
+		std::vector<std::string> names = { "shadowMatrices", "shadowMatrices[5]", "shadowMatrices[6]", "shadowMatrices[00]",
+										   "sampledDirectionalShadows", "layerBase", "bones", "bones[17]", "bones[18]",
+										   "lights", "lights[0]", "lights[2].position", "material", "viewposition", "",
+										   "directionalLights[0].direction", "jointMatrices", "jointMatrices[3]" };
+		for ( const test::gl::Uniform& uniform : test::gl::programUniforms )
+			names.push_back(uniform.name);
+		for ( unsigned int element = 0; element < 6; ++element )
+			names.push_back("shadowMatrices[" + std::to_string(element) + "]");
+		unsigned int mismatches = 0, found = 0;
+		for ( const std::string& name : names ) {
+			GLint location = shader.GetUniform(name).location;
+			mismatches += location != test::gl::LocationOf(name);
+			found += location >= 0;
+		}
+		CHECK(mismatches == 0);
+		CHECK(found > 256);
+		CHECK(test::gl::locationQueries == expectedQueries);
+
+		// A uniform the program does not use costs no driver call, one it uses costs exactly one.
+		test::gl::intUploads.clear();
+		shader.SetInt("lights[2].position", 1);
+		shader.SetInt(shader.GetUniform("jointMatrices[0]"), 2);
+		shader.SetInt("shadowMatrices[3]", 3);
+		CHECK(test::gl::intUploads.size() == 1 && test::gl::intUploads[0].first == test::gl::LocationOf("shadowMatrices[3]") &&
+			  test::gl::intUploads[0].second == 3);
+		CHECK(Shader::callStats.uploads == 1 && test::gl::locationQueries == expectedQueries);
+	}
+}
+
+int main()
+{
+	test::gl::Install();
+	CheckDefines();
+	CheckUniformTable();
+
+	return test::failures;
+}
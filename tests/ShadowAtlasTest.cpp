@@ -0,0 +1,134 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "ShadowAtlas.hpp"
+#include "Check.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using namespace GLVM;
+
+	bool Overlap(const core::ShadowTile& a, const core::ShadowTile& b) {
+		return a.x < b.x + b.size && b.x < a.x + a.size && a.y < b.y + b.size && b.y < a.y + a.size;
+	}
+
+	/// Allocates until the atlas is full or the requests run out, counting every broken rule.
+	struct Frame
+	{
+		std::vector<core::ShadowTile> tiles;
+		unsigned int outside = 0, misaligned = 0, overlapping = 0, oversized = 0, growing = 0;
+		unsigned long long area = 0;
+		bool full = false;
+
+		void Run(core::CShadowAtlas& _atlas, unsigned int _minTile, const std::vector<unsigned int>& _requests) {
+			for (unsigned int request : _requests) {
+				core::ShadowTile tile;
+				if (!_atlas.Allocate(request, tile)) {
+					full = true;
+					outside += tile.size != 0;
+					break;
+				}
+				unsigned int side = tile.size;
+				outside += tile.x + side > _atlas.GetSize() || tile.y + side > _atlas.GetSize();
+				misaligned += (side & (side - 1)) != 0 || side < _minTile || tile.x % side != 0 || tile.y % side != 0;
+				oversized += side > request && side != _minTile;
+				growing += !tiles.empty() && side > tiles.back().size;
+				for (const core::ShadowTile& other : tiles)
+					overlapping += Overlap(tile, other);
+				tiles.push_back(tile);
+				area += (unsigned long long)side * side;
+			}
+		}
+	};
+
+	void CheckRandomFrames() {
+		std::mt19937 random(47);
+		unsigned int broken = 0, fullButGaps = 0, frames = 0, fullFrames = 0;
+		for (unsigned int atlasSize : { 1024u, 2048u, 4096u }) {
+			for (unsigned int minTile : { 64u, 128u, 256u }) {
+				std::uniform_int_distribution<unsigned int> request(1, atlasSize * 2);
+				std::uniform_int_distribution<unsigned int> count(1, 80);
+				for (unsigned int trial = 0; trial < 200; ++trial) {
+					core::CShadowAtlas atlas(atlasSize, minTile);
+					std::vector<unsigned int> requests(count(random));
+					for (unsigned int& size : requests)
+						size = request(random);
+					// Half the frames ask in non increasing size as the renderer does, half in any order.
+					if (trial % 2 == 0)
+						std::sort(requests.rbegin(), requests.rend());
+
+					Frame frame;
+					frame.Run(atlas, minTile, requests);
+					broken += frame.outside + frame.misaligned + frame.overlapping + frame.oversized + frame.growing;
+					// A refusal means the atlas is covered edge to edge.
+					fullButGaps += frame.full && frame.area != (unsigned long long)atlasSize * atlasSize;
+					fullFrames += frame.full;
+					++frames;
+				}
+			}
+		}
+		std::printf("%u frames, %u filled the atlas: %u broken tiles, %u refusals with space left\n", frames, fullFrames,
+					broken, fullButGaps);
+		CHECK(broken == 0);
+		CHECK(fullButGaps == 0);
+		CHECK(fullFrames > 0);
+	}
+
+	/// Z order: four equal tiles fill the quadrants, then the smaller ones fill the next quadrant.
+	void CheckLayout() {
+		core::CShadowAtlas atlas(1024, 128);
+		core::ShadowTile tile;
+		const unsigned int expected[][3] = { { 0, 0, 512 }, { 512, 0, 256 }, { 768, 0, 256 }, { 512, 256, 256 },
+											 { 768, 256, 128 }, { 896, 256, 128 }, { 768, 384, 128 } };
+		const unsigned int requests[] = { 512, 256, 300, 256, 128, 1024, 200 };
+		unsigned int mismatches = 0;
+		for (unsigned int i = 0; i < 7; ++i) {
+			atlas.Allocate(requests[i], tile);
+			mismatches += tile.x != expected[i][0] || tile.y != expected[i][1] || tile.size != expected[i][2];
+		}
+		CHECK(mismatches == 0);
+
+		// Requests below the smallest tile still get one.
+		CHECK(atlas.Allocate(1, tile) && tile.size == 128 && tile.x == 896 && tile.y == 384);
+	}
+
+	/// Reset() hands the whole atlas back: a full atlas takes tiles again, and a repeated frame gets the same ones.
+	void CheckReuse() {
+		core::CShadowAtlas atlas(2048, 256);
+		std::vector<unsigned int> requests = { 1024, 1024, 512, 512, 512, 512, 256, 256, 256, 256, 256, 256, 256, 256,
+											   256, 256, 256, 256, 256, 256, 256, 256 };
+		Frame first;
+		first.Run(atlas, 256, requests);
+		core::ShadowTile tile;
+		CHECK(first.tiles.size() == requests.size() && first.area == 2048ull * 2048ull);
+		CHECK(!atlas.Allocate(256, tile) && tile.size == 0);
+
+		atlas.Reset();
+		CHECK(atlas.Allocate(2048, tile) && tile.x == 0 && tile.y == 0 && tile.size == 2048);
+		CHECK(!atlas.Allocate(256, tile));
+
+		atlas.Reset();
+		Frame second;
+		second.Run(atlas, 256, requests);
+		unsigned int moved = second.tiles.size() != first.tiles.size();
+		for (unsigned int i = 0; i < second.tiles.size() && i < first.tiles.size(); ++i)
+			moved += second.tiles[i].x != first.tiles[i].x || second.tiles[i].y != first.tiles[i].y ||
+				second.tiles[i].size != first.tiles[i].size;
+		CHECK(moved == 0);
+		CHECK(second.outside + second.misaligned + second.overlapping == 0);
+	}
+}
+
+int main()
+{
+	CheckRandomFrames();
+	CheckLayout();
+	CheckReuse();
+
+	return test::failures;
+}
@@ -0,0 +1,184 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "InstanceBatch.hpp"
+#include "VertexMath.hpp"
+#include "Check.hpp"
+#include <algorithm>
+#include <bit>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace
+{
+	using namespace GLVM;
+
+	/// What a depth pass reads of an entity, as BuildInstanceBatches() hashes it.
+	struct Caster
+	{
+		unsigned int entity;
+		unsigned int mesh;
+		mat4 model;
+		mat4 palette[4];
+		bool skinned;
+		bool visible;
+	};
+
+	/// The renderer's per frame state for _casters drawn in _order: batches, visibility and instance hashes.
+	struct Frame
+	{
+		std::vector<core::InstanceBatch> batches;
+		std::vector<unsigned char> visible;
+		std::vector<uint64_t> hashes;
+
+		uint64_t Signature(const std::vector<Caster>& _casters, const std::vector<unsigned int>& _order) {
+			batches.clear();
+			visible.clear();
+			hashes.clear();
+			for ( unsigned int index : _order ) {
+				const Caster& caster = _casters[index];
+				if ( core::AddToBatches(batches, visible.size(), caster.mesh, 0, 0, caster.skinned) && caster.skinned )
+					batches.back().skinPalette = 0;
+				uint64_t hash = core::HashWords(&caster.model, sizeof(mat4), uint64_t(caster.entity) << 32 | caster.mesh);
+				if ( caster.skinned )
+					hash = core::HashWords(caster.palette, sizeof(caster.palette), hash);
+				visible.push_back(caster.visible);
+				hashes.push_back(hash);
+			}
+			return core::SumVisibleHashes(batches, visible.data(), hashes.data());
+		}
+	};
+
+	mat4 RandomMatrix(std::mt19937& _random) {
+		std::uniform_real_distribution<float> value(-50.0f, 50.0f);
+		mat4 matrix(1.0f);
+		for ( int row = 0; row < 4; ++row )
+			for ( int column = 0; column < 3; ++column )
+				matrix[row][column] = value(_random);
+		return matrix;
+	}
+
+	/// Every single bit flip of a matrix gives a hash of its own, flipping about half of its bits.
+	void CheckHashWords() {
+		std::mt19937 random(46);
+		unsigned int collisions = 0;
+		double flippedBits = 0.0;
+		unsigned int flips = 0;
+		for ( unsigned int trial = 0; trial < 100; ++trial ) {
+			mat4 matrix = RandomMatrix(random);
+			uint64_t original = core::HashWords(&matrix, sizeof(mat4), trial);
+			std::set<uint64_t> seen = { original };
+			for ( unsigned int bit = 0; bit < sizeof(mat4) * 8; ++bit ) {
+				mat4 flipped = matrix;
+				reinterpret_cast<unsigned char*>(&flipped)[bit / 8] ^= 1u << (bit % 8);
+				uint64_t hash = core::HashWords(&flipped, sizeof(mat4), trial);
+				collisions += !seen.insert(hash).second;
+				flippedBits += std::popcount(hash ^ original);
+				++flips;
+			}
+			// The seed carries the entity and mesh, another one gives another hash.
+			collisions += core::HashWords(&matrix, sizeof(mat4), trial + 1) == original;
+		}
+		double averageFlipped = flippedBits / flips;
+		std::printf("%u single bit flips: %u collisions, %.2f of 64 hash bits flipped on average\n", flips, collisions,
+					averageFlipped);
+		CHECK(collisions == 0);
+		CHECK(averageFlipped > 30.0 && averageFlipped < 34.0);
+	}
+
+	void CheckSignature() {
+		std::mt19937 random(47);
+		std::uniform_int_distribution<unsigned int> mesh(0, 7);
+		std::bernoulli_distribution skinned(0.05), visible(0.3);
+		std::vector<Caster> casters(2000);
+		for ( unsigned int i = 0; i < casters.size(); ++i ) {
+			Caster& caster = casters[i];
+			caster.entity = i + 1;
+			caster.mesh = mesh(random);
+			caster.model = RandomMatrix(random);
+			for ( mat4& joint : caster.palette )
+				joint = RandomMatrix(random);
+			caster.skinned = skinned(random);
+			caster.visible = visible(random);
+		}
+		// Static instances by mesh, skinned ones last, as the render queue orders them.
+		std::vector<unsigned int> order(casters.size());
+		for ( unsigned int i = 0; i < order.size(); ++i )
+			order[i] = i;
+		auto byState = [&](unsigned int a, unsigned int b) {
+			return casters[a].skinned != casters[b].skinned ? casters[b].skinned : casters[a].mesh < casters[b].mesh;
+		};
+		std::stable_sort(order.begin(), order.end(), byState);
+
+		Frame frame;
+		uint64_t still = frame.Signature(casters, order);
+
+		// The camera turning reorders the instances inside every batch, the casters stay the same.
+		std::vector<unsigned int> turned = order;
+		std::shuffle(turned.begin(), turned.end(), random);
+		std::stable_sort(turned.begin(), turned.end(), byState);
+		CHECK(frame.Signature(casters, turned) == still);
+
+		auto first = [&](bool _skinned, bool _visible) {
+			return std::find_if(casters.begin(), casters.end(), [&](const Caster& _caster) {
+				return _caster.skinned == _skinned && _caster.visible == _visible;
+			}) - casters.begin();
+		};
+		auto changed = [&](unsigned int _index, auto _change) {
+			Caster saved = casters[_index];
+			_change(casters[_index]);
+			uint64_t signature = frame.Signature(casters, order);
+			casters[_index] = saved;
+			return signature != still;
+		};
+		auto move = [](Caster& _caster) { _caster.model[3][0] += 0.001f; };
+
+		// A cube moving outside the light volume keeps the map, one inside it does not.
+		CHECK(!changed(first(false, false), move));
+		CHECK(changed(first(false, true), move));
+		// Skinned casters always count, their palette as much as their place.
+		CHECK(changed(first(true, false), move));
+		CHECK(changed(first(true, true), [](Caster& _caster) { _caster.palette[2][1][1] += 0.001f; }));
+		// Entering or leaving the volume.
+		CHECK(changed(first(false, false), [](Caster& _caster) { _caster.visible = true; }));
+		CHECK(changed(first(false, true), [](Caster& _caster) { _caster.visible = false; }));
+		// Another mesh at the same place.
+		CHECK(changed(first(false, true), [](Caster& _caster) { _caster.mesh = 8; }));
+
+		// Two visible casters of one mesh trading places: the same matrices, but not on the same entities.
+		unsigned int a = first(false, true), b = a + 1;
+		while ( casters[b].skinned || !casters[b].visible || casters[b].mesh != casters[a].mesh )
+			++b;
+		std::swap(casters[a].model, casters[b].model);
+		CHECK(frame.Signature(casters, order) != still);
+		std::swap(casters[a].model, casters[b].model);
+
+		// Small moves of any visible caster never land on the old signature.
+		unsigned int collisions = 0, moves = 0;
+		std::uniform_int_distribution<unsigned int> pick(0, casters.size() - 1);
+		std::uniform_real_distribution<float> nudge(-0.01f, 0.01f);
+		for ( unsigned int trial = 0; trial < 2000; ++trial ) {
+			unsigned int index = pick(random);
+			if ( !casters[index].visible && !casters[index].skinned )
+				continue;
+			float offset = nudge(random);
+			if ( offset == 0.0f )
+				continue;
+			collisions += !changed(index, [&](Caster& _caster) { _caster.model[3][trial % 3] += offset; });
+			++moves;
+		}
+		CHECK(moves > 500);
+		CHECK(collisions == 0);
+	}
+}
+
+int main()
+{
+	CheckHashWords();
+	CheckSignature();
+
+	return test::failures;
+}
@@ -0,0 +1,110 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "Broadphase.hpp"
+#include "SimdBounds.hpp"
+#include "Check.hpp"
+#include <bit>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using namespace GLVM;
+
+	/// Half of the boxes sit on a unit grid, so touching faces test the strict comparison.
+	std::vector<AABB> RandomBoxes(unsigned int _count, float _side, std::mt19937& _random) {
+		std::uniform_real_distribution<float> position(0.0f, _side), extent(0.2f, 1.5f);
+		std::uniform_int_distribution<int> cell(0, int(_side / 4.0f));
+		std::vector<AABB> boxes(_count);
+		for (unsigned int i = 0; i < _count; ++i) {
+			if (i % 2 == 0)
+				boxes[i] = AABBFromCenter(vec3(position(_random), position(_random) * 0.3f, position(_random)), extent(_random));
+			else
+				boxes[i] = AABBFromCenter(vec3(float(cell(_random)), 0.5f, float(cell(_random))), 0.5f);
+		}
+		return boxes;
+	}
+
+	/// Every lane of every block against the scalar Overlaps(), lanes past the end included.
+	void CheckMasks(const std::vector<AABB>& _boxes, const core::CBoundsSoA& _bounds) {
+		unsigned int count = _boxes.size(), mismatches = 0;
+		for (unsigned int i = 0; i < count; ++i) {
+			for (unsigned int first = 0; first < count; first += core::CBoundsSoA::kLanes) {
+				unsigned int expected = 0;
+				for (unsigned int lane = 0; lane < core::CBoundsSoA::kLanes && first + lane < count; ++lane)
+					expected |= unsigned(Overlaps(_boxes[i], _boxes[first + lane])) << lane;
+				mismatches += core::OverlapMask8(_boxes[i], _bounds, first) != expected;
+			}
+		}
+		std::printf("OverlapMask8 level %d: %u mismatched blocks\n", int(core::GetSimdLevel()), mismatches);
+		CHECK(mismatches == 0);
+	}
+
+	size_t BruteForcePairs(const std::vector<AABB>& _boxes) {
+		size_t pairs = 0;
+		for (unsigned int i = 0; i < _boxes.size(); ++i)
+			for (unsigned int j = i + 1; j < _boxes.size(); ++j)
+				pairs += Overlaps(_boxes[i], _boxes[j]);
+		return pairs;
+	}
+
+	/// All pairs through the kernel against the AoS loop, and the sweep that uses the kernel.
+	void Benchmark(const std::vector<AABB>& _boxes, const core::CBoundsSoA& _bounds, size_t _reference) {
+		unsigned int count = _boxes.size();
+		std::vector<unsigned int> ids(count);
+		for (unsigned int i = 0; i < count; ++i)
+			ids[i] = i;
+
+		auto start = std::chrono::steady_clock::now();
+		size_t kernelPairs = 0;
+		for (unsigned int i = 0; i < count; ++i)
+			for (unsigned int first = i + 1; first < count; first += core::CBoundsSoA::kLanes)
+				kernelPairs += std::popcount(core::OverlapMask8(_boxes[i], _bounds, first));
+		double kernelMs = test::ElapsedMs(start);
+
+		core::CSweepAndPrune sweep;
+		core::vector<core::BroadphasePair> pairs;
+		start = std::chrono::steady_clock::now();
+		sweep.Update(ids.data(), _boxes.data(), count);
+		sweep.CollectPairs(pairs);
+		double sweepMs = test::ElapsedMs(start);
+
+		std::printf("level %d: all pairs %.1f ms, sweep and prune %.2f ms\n", int(core::GetSimdLevel()), kernelMs, sweepMs);
+		CHECK(kernelPairs == _reference);
+		CHECK(pairs.GetSize() == _reference);
+	}
+}
+
+int main()
+{
+	std::mt19937 random(3);
+
+	std::vector<AABB> boxes = RandomBoxes(2003, 40.0f, random);
+	core::CBoundsSoA bounds;
+	bounds.Resize(boxes.size());
+	for (unsigned int i = 0; i < boxes.size(); ++i)
+		bounds.Set(i, boxes[i]);
+
+	std::vector<AABB> large = RandomBoxes(12000, 100.0f, random);
+	core::CBoundsSoA largeBounds;
+	largeBounds.Resize(large.size());
+	for (unsigned int i = 0; i < large.size(); ++i)
+		largeBounds.Set(i, large[i]);
+
+	auto start = std::chrono::steady_clock::now();
+	size_t reference = BruteForcePairs(large);
+	std::printf("detected level %d, %zu boxes: AoS scalar all pairs %.1f ms, %zu pairs\n",
+				int(core::GetSimdLevel()), large.size(), test::ElapsedMs(start), reference);
+
+	// Levels above the detected one are lowered to it, running it again costs little.
+	for (core::ESimdLevel level : { core::eSIMD_AVX2, core::eSIMD_SSE, core::eSIMD_SCALAR }) {
+		core::SetSimdLevel(level);
+		CheckMasks(boxes, bounds);
+		Benchmark(large, largeBounds, reference);
+	}
+
+	return test::failures;
+}
@@ -0,0 +1,80 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "FastMath.hpp"
+#include "Check.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	/// Float bits mapped to integers that count representable values, so ULP distance is a difference.
+	int64_t Ordered(float _value)
+	{
+		int32_t bits;
+		std::memcpy(&bits, &_value, sizeof(bits));
+		return bits < 0 ? int64_t(INT32_MIN) - bits : bits;
+	}
+}
+
+/// Sweeps |x| <= 8192 against long double and holds sincos to the bounds FastMath.hpp documents.
+int main()
+{
+	using namespace GLVM::core::math;
+
+	constexpr uint32_t kLimitBits = 0x46000000u;   // 8192.0f
+	constexpr uint32_t kStride = 997;
+
+	int64_t sinUlp = 0, cosUlp = 0;
+	long double sinAbs = 0.0L, cosAbs = 0.0L;
+	unsigned int wideMismatches = 0;
+	float angles[8], wideSin[8], wideCos[8];
+	unsigned int lane = 0;
+
+	for (uint32_t bits = 0; bits < kLimitBits; bits += kStride) {
+		for (uint32_t sign : { 0u, 0x80000000u }) {
+			float x;
+			uint32_t signedBits = bits | sign;
+			std::memcpy(&x, &signedBits, sizeof(x));
+
+			float s, c;
+			sincos(x, s, c);
+			long double referenceSin = sinl(x), referenceCos = cosl(x);
+			// ULP only where the result is away from a zero, there the absolute error is what counts.
+			if (std::fabs(float(referenceSin)) > 1e-3f)
+				sinUlp = std::max<int64_t>(sinUlp, std::llabs(Ordered(s) - Ordered(float(referenceSin))));
+			if (std::fabs(float(referenceCos)) > 1e-3f)
+				cosUlp = std::max<int64_t>(cosUlp, std::llabs(Ordered(c) - Ordered(float(referenceCos))));
+			sinAbs = std::max(sinAbs, fabsl(s - referenceSin));
+			cosAbs = std::max(cosAbs, fabsl(c - referenceCos));
+
+			angles[lane++] = x;
+			if (lane == 8) {
+				sincos8(angles, wideSin, wideCos);
+				for (unsigned int i = 0; i < 8; ++i) {
+					sincos(angles[i], s, c);
+					wideMismatches += s != wideSin[i] || c != wideCos[i];
+				}
+				lane = 0;
+			}
+		}
+	}
+
+	std::printf("sincos: sin %lld ULP %.3Lg abs, cos %lld ULP %.3Lg abs, %u wide mismatches\n",
+				(long long)sinUlp, sinAbs, (long long)cosUlp, cosAbs, wideMismatches);
+	CHECK(sinUlp <= 2);
+	CHECK(cosUlp <= 2);
+	CHECK(sinAbs < 1e-7L);
+	CHECK(cosAbs < 1e-7L);
+	CHECK(wideMismatches == 0);
+
+	float s, c;
+	sincosDegrees(90.0f, s, c);
+	CHECK(std::fabs(s - 1.0f) < 1e-7f && std::fabs(c) < 1e-7f);
+
+	return GLVM::test::failures;
+}
@@ -0,0 +1,65 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "InstanceBatch.hpp"
+#include "VertexMath.hpp"
+#include "Check.hpp"
+
+namespace
+{
+	using namespace GLVM;
+
+	constexpr unsigned int kJointsNumber = 18;         ///< MAX_JOINTS_NUMBER of the renderer.
+
+	/// The stride the renderer used first: the palette bytes rounded up to the alignment, then to whole matrices.
+	unsigned int RoundedStride(unsigned int _joints, size_t _alignment) {
+		size_t bytes = (_joints * sizeof(mat4) + _alignment - 1) / _alignment * _alignment;
+		return (bytes + sizeof(mat4) - 1) / sizeof(mat4);
+	}
+
+	/*! Every GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT up to 1024 and every palette
+	 *  size: each palette of a frame starts aligned, holds all its joints
+	 *  and ends before the next one, with no more padding than alignment
+	 *  needs. Drivers report powers of two, the spec only asks for a value. */
+	void CheckAlignment() {
+		unsigned int misaligned = 0, short_ = 0, overlapping = 0, padded = 0, roundedMisaligned = 0;
+		for ( size_t alignment = 1; alignment <= 1024; ++alignment ) {
+			for ( unsigned int joints = 1; joints <= 64; ++joints ) {
+				unsigned int stride = core::PaletteStride(joints, sizeof(mat4), alignment);
+				short_ += stride < joints;
+				padded += stride > joints && (stride - 1) * sizeof(mat4) % alignment == 0;
+				// The frame's palettes follow a write the streaming buffer aligned.
+				size_t palettesOffset = 7 * alignment;
+				for ( int palette = 0; palette < 16; ++palette ) {
+					size_t offset = core::PaletteOffset(palettesOffset, palette, stride, sizeof(mat4));
+					misaligned += offset % alignment != 0;
+					overlapping += offset + joints * sizeof(mat4) > core::PaletteOffset(palettesOffset, palette + 1, stride,
+																						  sizeof(mat4));
+				}
+				roundedMisaligned += RoundedStride(joints, alignment) * sizeof(mat4) % alignment != 0;
+			}
+		}
+		std::printf("palette strides: %u misaligned, %u short, %u overlapping, %u over padded (rounding bytes first: %u "
+					"misaligned)\n", misaligned, short_, overlapping, padded, roundedMisaligned);
+		CHECK(misaligned == 0);
+		CHECK(short_ == 0);
+		CHECK(overlapping == 0);
+		CHECK(padded == 0);
+		CHECK(roundedMisaligned > 0);
+
+		// The alignments drivers report: 18 matrices are 1152 bytes, padded to the next multiple.
+		CHECK(core::PaletteStride(kJointsNumber, sizeof(mat4), 16) == 18);
+		CHECK(core::PaletteStride(kJointsNumber, sizeof(mat4), 256) == 20);
+		CHECK(core::PaletteStride(kJointsNumber, sizeof(mat4), 1024) == 32);
+		CHECK(core::PaletteOffset(512, 3, 20, sizeof(mat4)) == 512 + 3 * 1280);
+	}
+}
+
+int main()
+{
+	CheckAlignment();
+
+	return test::failures;
+}
@@ -0,0 +1,162 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "FakeGL.hpp"
+#include "StreamingBuffer.hpp"
+#include "Check.hpp"
+#include <random>
+#include <vector>
+
+namespace
+{
+	using namespace GLVM;
+
+	/// A write of a frame, as the GPU will read it until the frame's fence signals.
+	struct Written
+	{
+		GLuint buffer;
+		GLintptr offset;
+		GLsizeiptr used;
+		unsigned int frame;
+		int fence = -1;                  ///< Index into test::gl::fences once the frame is fenced.
+		std::vector<unsigned char> bytes;
+	};
+
+	struct Run
+	{
+		unsigned int overwrites = 0;     ///< Writes into a range a frame still in flight reads.
+		unsigned int misplaced = 0;      ///< Offsets off the alignment or past the storage.
+		unsigned int corrupted = 0;      ///< Bytes the storage did not hold at the end of their frame.
+		unsigned int writes = 0;
+		unsigned long stalls = 0;
+		unsigned int allocations = 0;
+		bool leaked = false;             ///< Fences or buffers left behind by the destroyed stream.
+	};
+
+	/// Streams random frames through a buffer while the GPU trails the CPU by _gpuFramesBehind frames.
+	Run Stream(unsigned int _gpuFramesBehind, GLsizeiptr _alignment, unsigned int _seed) {
+		test::gl::gpuFramesBehind = _gpuFramesBehind;
+		core::CStreamingBuffer::stats = core::StreamingBufferStats{};
+		unsigned int firstFence = test::gl::fences.size();
+		std::mt19937 random(_seed);
+		std::uniform_int_distribution<unsigned int> writesPerFrame(0, 6), size(0, 300), span(0, 3);
+		std::bernoulli_distribution large(0.01);
+		Run run;
+		{
+			core::CStreamingBuffer stream(GL_UNIFORM_BUFFER, 1000, _alignment);
+			std::vector<Written> inFlight;
+			for ( unsigned int frame = 0; frame < 600; ++frame ) {
+				unsigned int writes = writesPerFrame(random);
+				GLsizeiptr frameBytes = 0;
+				for ( unsigned int w = 0; w < writes; ++w ) {
+					GLsizeiptr bytes = large(random) ? 5000 : size(random);
+					// Now and then a range bound wider than its data, as the light blocks are.
+					GLsizeiptr used = span(random) == 0 ? bytes + 64 : bytes;
+					std::vector<unsigned char> data(bytes);
+					for ( unsigned char& byte : data )
+						byte = (unsigned char)random();
+
+					unsigned int allocations = stream.GetAllocations();
+					GLintptr offset = stream.Write(data.data(), bytes, used);
+					GLuint buffer = stream.GetBuffer();
+					// New storage leaves the old one to the draws that read it.
+					if ( allocations != stream.GetAllocations() )
+						inFlight.clear();
+
+					run.misplaced += offset % _alignment != 0 ||
+						offset + used > (GLintptr)test::gl::buffers[buffer].data.size();
+					for ( const Written& earlier : inFlight ) {
+						bool reading = earlier.fence < 0 || !test::gl::fences[earlier.fence].signaled;
+						run.overwrites += reading && earlier.buffer == buffer && offset < earlier.offset + earlier.used &&
+							earlier.offset < offset + used;
+					}
+					inFlight.push_back(Written{ buffer, offset, used, frame, -1, std::move(data) });
+					frameBytes += used;
+					++run.writes;
+				}
+
+				// Every write of the frame is in place when the frame is submitted.
+				for ( const Written& written : inFlight )
+					if ( written.frame == frame )
+						run.corrupted += !std::equal(written.bytes.begin(), written.bytes.end(),
+													 test::gl::buffers[written.buffer].data.begin() + written.offset);
+
+				unsigned int fencesBefore = test::gl::fences.size();
+				stream.NextFrame();
+				// A frame that wrote nothing has nothing to fence.
+				CHECK(test::gl::fences.size() == fencesBefore + (frameBytes > 0));
+				for ( Written& written : inFlight )
+					if ( written.frame == frame && test::gl::fences.size() > fencesBefore )
+						written.fence = fencesBefore;
+				std::erase_if(inFlight, [](const Written& _written) {
+					return _written.fence >= 0 && test::gl::fences[_written.fence].signaled;
+				});
+			}
+			run.allocations = stream.GetAllocations();
+		}
+		run.stalls = core::CStreamingBuffer::stats.stalls;
+		for ( unsigned int i = firstFence; i < test::gl::fences.size(); ++i )
+			run.leaked |= !test::gl::fences[i].deleted;
+		run.leaked |= !test::gl::buffers.empty();
+		return run;
+	}
+
+	void CheckRing() {
+		for ( GLsizeiptr alignment : { 1, 4, 16, 256 } ) {
+			for ( unsigned int behind = 0; behind <= 4; ++behind ) {
+				Run run = Stream(behind, alignment, 49 + behind);
+				std::printf("alignment %3ld, GPU %u frames behind: %u writes, %u allocations, %lu stalls, %u overwrites, "
+							"%u misplaced, %u corrupted\n", (long)alignment, behind, run.writes, run.allocations, run.stalls,
+							run.overwrites, run.misplaced, run.corrupted);
+				CHECK(run.overwrites == 0);
+				CHECK(run.misplaced == 0);
+				CHECK(run.corrupted == 0);
+				CHECK(!run.leaked);
+				CHECK(run.allocations > 1);
+				// Three regions hide two frames of latency, a third makes every frame wait.
+				CHECK(behind < 3 ? run.stalls == 0 : run.stalls > 0);
+			}
+		}
+	}
+
+	/// The regions in turn, an empty frame keeping its region, spans and growth.
+	void CheckOffsets() {
+		test::gl::gpuFramesBehind = 0;
+		unsigned char data[64] = {};
+		{
+			core::CStreamingBuffer stream(GL_ARRAY_BUFFER, 1000, 256);
+			// 1000 bytes rounded up to the alignment: regions start at 0, 1024 and 2048.
+			CHECK(stream.Write(data, 16) == 0);
+			CHECK(stream.Write(data, 16) == 256);
+			stream.NextFrame();
+			stream.NextFrame();
+			CHECK(stream.Write(data, 16, 512) == 1024);
+			CHECK(stream.Write(data, 16) == 1024 + 512);
+			stream.NextFrame();
+			CHECK(stream.Write(data, 64) == 2048);
+			stream.NextFrame();
+			CHECK(stream.Write(data, 64) == 0);
+			CHECK(stream.IsPersistent());
+
+			// A write past the region doubles it at least, into new storage starting over at region 0.
+			GLuint buffer = stream.GetBuffer();
+			CHECK(stream.Write(data, 64, 1500) == 0);
+			CHECK(stream.GetAllocations() == 2 && stream.GetBuffer() != buffer && test::gl::buffers.count(buffer) == 0);
+			CHECK(test::gl::buffers[stream.GetBuffer()].data.size() == 3 * 2048);
+			stream.NextFrame();
+			CHECK(stream.Write(data, 64) == 2048);
+		}
+		CHECK(test::gl::buffers.empty());
+	}
+}
+
+int main()
+{
+	test::gl::Install();
+	CheckRing();
+	CheckOffsets();
+
+	return test::failures;
+}
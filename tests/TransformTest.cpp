@@ -0,0 +1,188 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "Components/TransformComponent.hpp"
+#include "Check.hpp"
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using namespace GLVM;
+	namespace cm = GLVM::ecs::components;
+
+	/// The model rotation SetModelMatrix() built from transform::yaw and transform::pitch every draw.
+	mat4 YawPitchMatrix(float _yaw, float _pitch) {
+		Quaternion pitchQuat{ .w = std::cos(Radians(-_pitch / 2)), .x = 0.0f, .y = 0.0f, .z = std::sin(Radians(-_pitch / 2)) };
+		Quaternion yawQuat{ .w = std::cos(Radians(-_yaw / 2)), .x = 0.0f, .y = std::sin(Radians(-_yaw / 2)), .z = 0.0f };
+
+		return rotateQuaternion<float, 4>(multiplyQuaternion(pitchQuat, yawQuat));
+	}
+
+	/// The aim CProjectileSystem::GetDirectionVector() built with two quaternion products.
+	vec3 YawPitchDirection(float _yaw, float _pitch) {
+		Quaternion pitchQuat{ .w = std::cos(Radians(_pitch / 2)), .x = std::sin(Radians(_pitch / 2)), .y = 0.0f, .z = 0.0f };
+		Quaternion yawQuat{ .w = std::cos(Radians(-_yaw / 2)), .x = 0.0f, .y = std::sin(Radians(-_yaw / 2)), .z = 0.0f };
+		Quaternion rotation = multiplyQuaternion(yawQuat, pitchQuat);
+		Quaternion result = multiplyQuaternion(multiplyQuaternion(rotation, Quaternion{ .w = 0.0f, .x = 0.0f, .y = 0.0f, .z = -1.0f }),
+											   inverseQuaternion(rotation));
+
+		return vec3(result.x, result.y, result.z);
+	}
+
+	/// Angle in radians between the orientations, whichever sign the quaternions carry. The
+	/// half-angle comes from the chord lengths, acos of the dot product loses it near zero.
+	float Angle(const Quaternion& a, Quaternion b) {
+		if (dotQuaternion(a, b) < 0.0f)
+			b = Quaternion{ .w = -b.w, .x = -b.x, .y = -b.y, .z = -b.z };
+		float dw = a.w - b.w, dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+		float sw = a.w + b.w, sx = a.x + b.x, sy = a.y + b.y, sz = a.z + b.z;
+
+		return 2.0f * std::atan2(std::sqrt(dw * dw + dx * dx + dy * dy + dz * dz), std::sqrt(sw * sw + sx * sx + sy * sy + sz * sz));
+	}
+
+	Quaternion RandomRotation(std::mt19937& _random) {
+		std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+		return normalizeQuaternion(Quaternion{ component(_random), component(_random), component(_random), component(_random) });
+	}
+
+	void CheckYawPitch() {
+		float matrixError = 0.0f, directionError = 0.0f;
+		for (float yaw = -360.0f; yaw <= 360.0f; yaw += 7.5f) {
+			for (float pitch = -89.0f; pitch <= 89.0f; pitch += 4.45f) {
+				cm::transform transform;
+				cm::SetRotation(transform, cm::YawPitchRotation(yaw, pitch));
+				mat4 stored = unitQuaternionToMatrix(transform.rotation);
+				mat4 old = YawPitchMatrix(yaw, pitch);
+				for (int row = 0; row < 3; ++row)
+					for (int column = 0; column < 3; ++column)
+						matrixError = std::fmax(matrixError, std::fabs(stored[row][column] - old[row][column]));
+
+				Quaternion aim = multiplyQuaternion(axisAngleQuaternion(vec3(0.0f, 1.0f, 0.0f), Radians(-yaw)),
+													axisAngleQuaternion(vec3(1.0f, 0.0f, 0.0f), Radians(pitch)));
+				vec3 direction = rotateVector(aim, vec3(0.0f, 0.0f, -1.0f));
+				vec3 oldDirection = YawPitchDirection(yaw, pitch);
+				for (int axis = 0; axis < 3; ++axis)
+					directionError = std::fmax(directionError, std::fabs(direction[axis] - oldDirection[axis]));
+			}
+		}
+		std::printf("yaw/pitch: model matrix error %g, direction error %g\n", matrixError, directionError);
+		CHECK(matrixError < 1e-5f);
+		CHECK(directionError < 1e-5f);
+	}
+
+	void CheckInterpolation() {
+		std::mt19937 random(27);
+		float endpointError = 0.0f, lengthError = 0.0f, speedError = 0.0f, midpointError = 0.0f, signError = 0.0f;
+		unsigned int nlerpReversals = 0;
+		for (unsigned int i = 0; i < 10000; ++i) {
+			Quaternion a = RandomRotation(random), b = RandomRotation(random);
+			Quaternion negatedB{ .w = -b.w, .x = -b.x, .y = -b.y, .z = -b.z };
+			float arc = Angle(a, b);
+
+			endpointError = std::fmax(endpointError, std::fmax(Angle(slerp(a, b, 0.0f), a), Angle(slerp(a, b, 1.0f), b)));
+			endpointError = std::fmax(endpointError, std::fmax(Angle(nlerp(a, b, 0.0f), a), Angle(nlerp(a, b, 1.0f), b)));
+
+			float previous = 0.0f;
+			for (float t = 0.0f; t <= 1.0f; t += 0.125f) {
+				Quaternion spherical = slerp(a, b, t), linear = nlerp(a, b, t);
+				lengthError = std::fmax(lengthError, std::fmax(std::fabs(normQuaternion(spherical) - 1.0f),
+															   std::fabs(normQuaternion(linear) - 1.0f)));
+				// slerp turns at a constant rate, nlerp only keeps going the same way.
+				speedError = std::fmax(speedError, std::fabs(Angle(a, spherical) - t * arc));
+				float travelled = Angle(a, linear);
+				nlerpReversals += travelled + 1e-4f < previous;
+				previous = travelled;
+				// Both take the shortest arc, so the sign of either end does not matter.
+				signError = std::fmax(signError, std::fmax(Angle(spherical, slerp(a, negatedB, t)), Angle(linear, nlerp(a, negatedB, t))));
+			}
+			midpointError = std::fmax(midpointError, Angle(slerp(a, b, 0.5f), nlerp(a, b, 0.5f)));
+		}
+
+		// Nearly parallel inputs fall back to nlerp instead of dividing by a vanishing sine.
+		Quaternion a = RandomRotation(random);
+		Quaternion close = normalizeQuaternion(Quaternion{ .w = a.w + 1e-4f, .x = a.x, .y = a.y, .z = a.z });
+		Quaternion halfway = slerp(a, close, 0.5f);
+		CHECK(std::isfinite(halfway.w) && std::fabs(normQuaternion(halfway) - 1.0f) < 1e-5f);
+
+		std::printf("interpolation: endpoints %g, length %g, slerp speed %g, midpoints %g, sign %g, %u nlerp reversals\n",
+					endpointError, lengthError, speedError, midpointError, signError, nlerpReversals);
+		CHECK(endpointError < 1e-4f);
+		CHECK(lengthError < 1e-5f);
+		CHECK(speedError < 1e-4f);
+		CHECK(midpointError < 1e-4f);
+		CHECK(signError < 1e-4f);
+		CHECK(nlerpReversals == 0);
+	}
+
+	void CheckPreviousState() {
+		cm::transform transform;
+		transform.tPosition = vec3(1.0f, 2.0f, 3.0f);
+		cm::SetRotation(transform, cm::YawPitchRotation(30.0f, 10.0f));
+		// Before the first step there is nothing to blend from.
+		CHECK(cm::InterpolatedPosition(transform, 0.5f)[0] == 1.0f);
+		CHECK(Angle(cm::InterpolatedRotation(transform, 0.5f), transform.rotation) == 0.0f);
+
+		cm::StorePreviousState(transform);
+		Quaternion previous = transform.rotation;
+		transform.tPosition = vec3(3.0f, 2.0f, 1.0f);
+		cm::SetRotation(transform, cm::YawPitchRotation(90.0f, -10.0f));
+		vec3 halfway = cm::InterpolatedPosition(transform, 0.5f);
+		CHECK(halfway[0] == 2.0f && halfway[1] == 2.0f && halfway[2] == 2.0f);
+		CHECK(Angle(cm::InterpolatedRotation(transform, 0.0f), previous) < 1e-3f);
+		CHECK(Angle(cm::InterpolatedRotation(transform, 1.0f), transform.rotation) < 1e-3f);
+		CHECK(std::fabs(Angle(cm::InterpolatedRotation(transform, 0.5f), previous) - 0.5f * Angle(previous, transform.rotation)) < 1e-3f);
+	}
+
+	/// Per-draw rotation from yaw/pitch against the stored quaternion, and the two interpolations.
+	void Benchmark() {
+		const unsigned int count = 100000;
+		std::mt19937 random(28);
+		std::uniform_real_distribution<float> yawAngle(-180.0f, 180.0f), pitchAngle(-89.0f, 89.0f);
+		std::vector<float> yaws(count), pitches(count);
+		std::vector<Quaternion> rotations(count), targets(count);
+		for (unsigned int i = 0; i < count; ++i) {
+			yaws[i] = yawAngle(random);
+			pitches[i] = pitchAngle(random);
+			rotations[i] = cm::YawPitchRotation(yaws[i], pitches[i]);
+			targets[i] = RandomRotation(random);
+		}
+
+		float sink = 0.0f;
+		auto start = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < count; ++i)
+			sink += YawPitchMatrix(yaws[i], pitches[i])[2][1];
+		double yawPitchMs = test::ElapsedMs(start);
+
+		start = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < count; ++i)
+			sink += unitQuaternionToMatrix(rotations[i])[2][1];
+		double storedMs = test::ElapsedMs(start);
+
+		start = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < count; ++i)
+			sink += slerp(rotations[i], targets[i], 0.3f).w;
+		double slerpMs = test::ElapsedMs(start);
+
+		start = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < count; ++i)
+			sink += nlerp(rotations[i], targets[i], 0.3f).w;
+		double nlerpMs = test::ElapsedMs(start);
+
+		std::printf("%u rotations: yaw/pitch %.3f ms, stored quaternion %.3f ms, slerp %.3f ms, nlerp %.3f ms (%g)\n",
+					count, yawPitchMs, storedMs, slerpMs, nlerpMs, sink);
+	}
+}
+
+int main()
+{
+	CheckYawPitch();
+	CheckInterpolation();
+	CheckPreviousState();
+	Benchmark();
+
+	return test::failures;
+}
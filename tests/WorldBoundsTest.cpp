@@ -0,0 +1,153 @@
+// This file is part of Game Loop Versatile Modules (GLVM)
+// Copyright © 2024 Maksim Manokhin a.k.a. Yuriorkis_Scream. Contacts: <fellfrostqtw@gmail.com>
+// Author: Maksim Manokhin a.k.a. Yuriorkis_Scream
+// License: http://opensource.org/licenses/MIT
+
+#include "ComponentsFullSet.hpp"
+#include "EntityManager.hpp"
+#include "Event.hpp"
+#include "EventsStack.hpp"
+#include "Prefab.hpp"
+#include "Systems/CollisionSystem.hpp"
+#include "Systems/MovementSystem.hpp"
+#include "Systems/PhysicsSystem.hpp"
+#include "Systems/WorldBoundsSystem.hpp"
+#include "Check.hpp"
+#include <algorithm>
+#include <random>
+#include <sys/resource.h>
+
+GLVM::core::CEvent g_eEvent;
+
+namespace
+{
+	using namespace GLVM;
+	namespace cm = GLVM::ecs::components;
+
+	/// Storage the soak may grow: the containers of every component a cube owns and the peak resident set.
+	struct Footprint
+	{
+		int capacities[8];
+		long maxResidentKb;
+
+		static Footprint Take() {
+			ecs::ComponentManager* componentManager = ecs::ComponentManager::GetInstance();
+			rusage usage;
+			getrusage(RUSAGE_SELF, &usage);
+			return Footprint{ { componentManager->GetComponentContainer<cm::transform>()->GetCapacity(),
+								componentManager->GetComponentContainer<cm::collider>()->GetCapacity(),
+								componentManager->GetComponentContainer<cm::rigidBody>()->GetCapacity(),
+								componentManager->GetComponentContainer<cm::move>()->GetCapacity(),
+								componentManager->GetComponentContainer<cm::material>()->GetCapacity(),
+								componentManager->GetEntityContainer<cm::transform>()->GetCapacity(),
+								componentManager->GetEntityContainer<cm::collider>()->GetCapacity(),
+								componentManager->GetSparseContainer<cm::transform>()->GetCapacity() },
+							  usage.ru_maxrss };
+		}
+
+		///< Largest growth of any container since _earlier, in elements.
+		int CapacityGrowth(const Footprint& _earlier) const {
+			int growth = 0;
+			for (unsigned int i = 0; i < sizeof(capacities) / sizeof(capacities[0]); ++i)
+				growth = std::max(growth, capacities[i] - _earlier.capacities[i]);
+			return growth;
+		}
+	};
+}
+
+/*! Headless soak of the game's spawn pattern: a falling cube every 1.5 s,
+ *  every other one over the void. Once the first cubes fell out of the
+ *  world, released ones are reused and the entity count stays bounded. */
+int main()
+{
+	ecs::ComponentManager* componentManager = ecs::ComponentManager::GetInstance();
+	ecs::CPrefabRegistry* registry = ecs::CPrefabRegistry::GetInstance();
+	bool loaded = registry->LoadFromFile("prefabs/prefabs.json");
+	CHECK(loaded);
+	if (!loaded)
+		return test::failures;
+
+	Entity ground = registry->Instantiate(*registry->Get("groundPlane"))[0];
+	componentManager->GetComponent<cm::transform>(ground)->tPosition = vec3(0.0f, -20.0f, 0.0f);
+	ecs::CPrefabPool pool(*registry->Get("fallingCube"));
+
+	core::CStack stack;
+	float gravity = 0.0f;
+	ecs::CMovementSystem movement(stack);
+	ecs::CCollisionSystem collision(stack);
+	ecs::CPhysicsSystem physics(gravity, stack);
+	ecs::CWorldBoundsSystem worldBounds;
+	worldBounds.minHeight = -20.0f;
+	worldBounds.AddPool(&pool);
+
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> offset(-7.0f, 7.0f);
+	const float step = 1.0f / 60.0f;
+	movement.deltaFrameTime = step;
+	collision.fDelta_Time_ = step;
+	physics.fDelta_Time_ = step;
+
+	const unsigned int steps = 60 * 60 * 60;     // One simulated hour.
+	unsigned int spawned = 0, createdAtHalf = 0, collidersAtHalf = 0;
+	Footprint atHalf{};
+	for (unsigned int i = 0; i < steps; ++i) {
+		if (i % 90 == 0) {
+			// Alternate between the ground (x = 14) and the void (x = 0), away from the cubes still in play.
+			float x = 0.0f, z = 0.0f, platformX = (i / 90) % 2 ? 0.0f : 14.0f;
+			core::vector<Entity> active = pool.GetActive();
+			bool crowded = true;
+			for (unsigned int attempt = 0; attempt < 50 && crowded; ++attempt) {
+				x = platformX + offset(random);
+				z = offset(random);
+				crowded = false;
+				for (unsigned int j = 0; j < active.GetSize(); ++j) {
+					cm::transform* transform = componentManager->GetComponent<cm::transform>(active[j]);
+					float dx = x - transform->tPosition[0], dz = z - transform->tPosition[2];
+					crowded = crowded || dx * dx + dz * dz < 9.0f;
+				}
+			}
+			if (!crowded) {
+				componentManager->GetComponent<cm::transform>(pool.Acquire())->tPosition = vec3(x, 10.0f, z);
+				++spawned;
+			}
+		}
+
+		gravity += step;
+		movement.gravity = gravity;
+		collision.gravity = gravity;
+		physics.gravity = gravity;
+		physics.fAcceleration_of_Gravity_ += step / 20.0f;
+		movement.Update();
+		collision.Update();
+		physics.Update();
+		worldBounds.Update();
+
+		if (i == steps / 2) {
+			createdAtHalf = pool.GetCreatedNumber();
+			collidersAtHalf = componentManager->GetEntityContainer<cm::collider>()->GetSize();
+			atHalf = Footprint::Take();
+		}
+		if (i % (10 * 60 * 60) == 0 || i == steps - 1)
+			std::printf("t = %4.0f s: %u spawned, %u despawned, %u active, %u free, %u created, %u colliders\n", i * step, spawned,
+						worldBounds.GetDespawned(), pool.GetActiveNumber(), pool.GetFreeNumber(), pool.GetCreatedNumber(),
+						componentManager->GetEntityContainer<cm::collider>()->GetSize());
+	}
+
+	CHECK(spawned > 600);
+	CHECK(worldBounds.GetDespawned() > spawned / 3);
+	CHECK(spawned == worldBounds.GetDespawned() + pool.GetActiveNumber());
+	CHECK(pool.GetCreatedNumber() == pool.GetActiveNumber() + pool.GetFreeNumber());
+	CHECK(pool.GetCreatedNumber() < 100);
+	// The second half reuses what the first allocated. A new peak of cubes in flight may still add
+	// one or two, and the containers then grow by at most one step, but the memory stays put.
+	unsigned int createdLater = pool.GetCreatedNumber() - createdAtHalf;
+	Footprint atEnd = Footprint::Take();
+	std::printf("second half: %u created, containers grew by %d, peak resident set %ld KB -> %ld KB\n", createdLater,
+				atEnd.CapacityGrowth(atHalf), atHalf.maxResidentKb, atEnd.maxResidentKb);
+	CHECK(createdLater < 5);
+	CHECK(componentManager->GetEntityContainer<cm::collider>()->GetSize() == collidersAtHalf + createdLater);
+	CHECK(atEnd.CapacityGrowth(atHalf) <= 10);
+	CHECK(atEnd.maxResidentKb - atHalf.maxResidentKb < 1024);
+
+	return test::failures;
+}